@@ -0,0 +1,256 @@
+#include "xla/extension/aot.h"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/shape.h"
+#include "xla/tsl/platform/env.h"
+#include "xla/tsl/platform/errors.h"
+#include "xla/tsl/platform/statusor.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/cpu_info.h"
+
+namespace xla {
+namespace extension {
+
+namespace {
+
+// Bump whenever the artifact layout changes
+constexpr char kArtifactMagic[] = "XLA_AOT";
+constexpr int kArtifactFormatVersion = 2;
+
+// Same length-prefixed framing as the executable cache keys
+void AppendField(std::string* out, absl::string_view field) {
+  absl::StrAppend(out, field.size(), ":", field, ";");
+}
+
+absl::StatusOr<absl::string_view> ConsumeField(absl::string_view* data) {
+  size_t colon = data->find(':');
+  size_t size;
+  if (colon == absl::string_view::npos ||
+      !absl::SimpleAtoi(data->substr(0, colon), &size) ||
+      data->size() < colon + 1 + size + 1 || (*data)[colon + 1 + size] != ';') {
+    return absl::DataLossError("truncated or corrupt AOT artifact");
+  }
+  absl::string_view field = data->substr(colon + 1, size);
+  data->remove_prefix(colon + 1 + size + 1);
+  return field;
+}
+
+// Whether the host CPU runs code compiled with --xla_cpu_max_isa=isa.
+// Only x86 instruction sets are checked, the others are assumed present
+bool HostSupportsIsa(absl::string_view isa) {
+  using tsl::port::CPUFeature;
+  using tsl::port::TestCPUFeature;
+  if (isa.empty() || isa == "NEON" || isa == "SVE") return true;
+  if (isa == "SSE4_2") return TestCPUFeature(CPUFeature::SSE4_2);
+  if (isa == "AVX") return TestCPUFeature(CPUFeature::AVX);
+  if (isa == "AVX2") {
+    return TestCPUFeature(CPUFeature::AVX2) && TestCPUFeature(CPUFeature::FMA);
+  }
+  if (isa == "AVX512") return TestCPUFeature(CPUFeature::AVX512F);
+  if (isa == "AVX512_VNNI") return TestCPUFeature(CPUFeature::AVX512_VNNI);
+  if (isa == "AVX512_BF16") return TestCPUFeature(CPUFeature::AVX512_BF16);
+  if (isa == "AMX") return TestCPUFeature(CPUFeature::AMX_TILE);
+  return false;
+}
+
+// x86 features LLVM may use when compiling for the host CPU
+struct NamedFeature {
+  const char* name;
+  tsl::port::CPUFeature feature;
+};
+
+const std::vector<NamedFeature>& X86Features() {
+  using tsl::port::CPUFeature;
+  static const auto* features = new std::vector<NamedFeature>{
+      {"SSE4_1", CPUFeature::SSE4_1},
+      {"SSE4_2", CPUFeature::SSE4_2},
+      {"POPCNT", CPUFeature::POPCNT},
+      {"AVX", CPUFeature::AVX},
+      {"AVX2", CPUFeature::AVX2},
+      {"FMA", CPUFeature::FMA},
+      {"F16C", CPUFeature::F16C},
+      {"AVX512F", CPUFeature::AVX512F},
+      {"AVX512CD", CPUFeature::AVX512CD},
+      {"AVX512VL", CPUFeature::AVX512VL},
+      {"AVX512BW", CPUFeature::AVX512BW},
+      {"AVX512DQ", CPUFeature::AVX512DQ},
+      {"AVX512VBMI", CPUFeature::AVX512VBMI},
+      {"AVX512IFMA", CPUFeature::AVX512IFMA},
+      {"AVX512_VNNI", CPUFeature::AVX512_VNNI},
+      {"AVX512_BF16", CPUFeature::AVX512_BF16},
+      {"AVX512_FP16", CPUFeature::AVX512_FP16},
+      {"AVX_VNNI", CPUFeature::AVX_VNNI},
+      {"AMX_TILE", CPUFeature::AMX_TILE},
+      {"AMX_INT8", CPUFeature::AMX_INT8},
+      {"AMX_BF16", CPUFeature::AMX_BF16},
+  };
+  return *features;
+}
+
+std::vector<std::string> HostCpuFeatures() {
+  std::vector<std::string> names;
+#if defined(__x86_64__)
+  for (const NamedFeature& feature : X86Features()) {
+    if (tsl::port::TestCPUFeature(feature.feature)) {
+      names.push_back(feature.name);
+    }
+  }
+#endif
+  return names;
+}
+
+// Recorded features the host lacks, unknown names count as missing
+std::vector<std::string> MissingCpuFeatures(
+    const std::vector<std::string>& features) {
+  std::vector<std::string> missing;
+  for (const std::string& name : features) {
+    bool present = false;
+    for (const NamedFeature& feature : X86Features()) {
+      if (name == feature.name) {
+        present = tsl::port::TestCPUFeature(feature.feature);
+        break;
+      }
+    }
+    if (!present) missing.push_back(name);
+  }
+  return missing;
+}
+
+}  // namespace
+
+absl::StatusOr<AotArtifact> CompileForExport(PjRtClient* client,
+                                             const XlaComputation& computation,
+                                             CompileOptions options,
+                                             const AotTarget& target) {
+  if (!target.max_isa.empty()) {
+    options.executable_build_options.mutable_debug_options()
+        ->set_xla_cpu_max_isa(target.max_isa);
+  }
+
+  AotArtifact artifact;
+  artifact.platform_name = std::string(client->platform_name());
+  artifact.platform_version = std::string(client->platform_version());
+  artifact.max_isa = target.max_isa;
+  // Code compiled for the build machine may use any of its features
+  if (target.max_isa.empty()) artifact.cpu_features = HostCpuFeatures();
+  TF_ASSIGN_OR_RETURN(artifact.program_shape, computation.GetProgramShape());
+
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<PjRtLoadedExecutable> executable,
+                      client->CompileAndLoad(computation, options));
+  TF_ASSIGN_OR_RETURN(artifact.executable, executable->SerializeExecutable());
+  return artifact;
+}
+
+std::string SerializeAotArtifact(const AotArtifact& artifact) {
+  std::string out;
+  AppendField(&out, kArtifactMagic);
+  AppendField(&out, absl::StrCat(kArtifactFormatVersion));
+  AppendField(&out, artifact.platform_name);
+  AppendField(&out, artifact.platform_version);
+  AppendField(&out, artifact.max_isa);
+  AppendField(&out, absl::StrJoin(artifact.cpu_features, ","));
+  AppendField(&out, artifact.program_shape.ToProto().SerializeAsString());
+  AppendField(&out, artifact.executable);
+  return out;
+}
+
+absl::StatusOr<AotArtifact> ParseAotArtifact(absl::string_view data) {
+  absl::StatusOr<absl::string_view> magic = ConsumeField(&data);
+  if (!magic.ok() || *magic != kArtifactMagic) {
+    return absl::InvalidArgumentError("not an XLA AOT artifact");
+  }
+  TF_ASSIGN_OR_RETURN(absl::string_view version, ConsumeField(&data));
+  if (version != absl::StrCat(kArtifactFormatVersion)) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("AOT artifact format ", version, " is not supported, ",
+                     "expected ", kArtifactFormatVersion));
+  }
+
+  AotArtifact artifact;
+  TF_ASSIGN_OR_RETURN(absl::string_view platform_name, ConsumeField(&data));
+  TF_ASSIGN_OR_RETURN(absl::string_view platform_version, ConsumeField(&data));
+  TF_ASSIGN_OR_RETURN(absl::string_view max_isa, ConsumeField(&data));
+  TF_ASSIGN_OR_RETURN(absl::string_view cpu_features, ConsumeField(&data));
+  TF_ASSIGN_OR_RETURN(absl::string_view program_shape, ConsumeField(&data));
+  TF_ASSIGN_OR_RETURN(absl::string_view executable, ConsumeField(&data));
+  if (!data.empty()) {
+    return absl::DataLossError("trailing data after the AOT artifact");
+  }
+
+  ProgramShapeProto program_shape_proto;
+  if (!program_shape_proto.ParseFromString(program_shape)) {
+    return absl::DataLossError("corrupt program shape in AOT artifact");
+  }
+  TF_ASSIGN_OR_RETURN(artifact.program_shape,
+                      ProgramShape::FromProto(program_shape_proto));
+  artifact.platform_name = std::string(platform_name);
+  artifact.platform_version = std::string(platform_version);
+  artifact.max_isa = std::string(max_isa);
+  artifact.cpu_features =
+      absl::StrSplit(cpu_features, ',', absl::SkipEmpty());
+  artifact.executable = std::string(executable);
+  return artifact;
+}
+
+absl::Status WriteAotArtifact(const std::string& path,
+                              const AotArtifact& artifact) {
+  return tsl::WriteStringToFile(tsl::Env::Default(), path,
+                                SerializeAotArtifact(artifact));
+}
+
+absl::StatusOr<AotArtifact> ReadAotArtifact(const std::string& path) {
+  std::string data;
+  TF_RETURN_IF_ERROR(tsl::ReadFileToString(tsl::Env::Default(), path, &data));
+  return ParseAotArtifact(data);
+}
+
+absl::Status CheckAotCompatible(PjRtClient* client,
+                                const AotArtifact& artifact) {
+  if (client->platform_name() != artifact.platform_name ||
+      client->platform_version() != artifact.platform_version) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "AOT artifact was compiled for ", artifact.platform_name, " ",
+        artifact.platform_version, ", the client is ", client->platform_name(),
+        " ", client->platform_version()));
+  }
+  if (!HostSupportsIsa(artifact.max_isa)) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("AOT artifact was compiled for ", artifact.max_isa,
+                     ", which this CPU does not support"));
+  }
+  std::vector<std::string> missing = MissingCpuFeatures(artifact.cpu_features);
+  if (!missing.empty()) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "AOT artifact was compiled for a CPU with ",
+        absl::StrJoin(missing, ", "), ", which this CPU does not support, ",
+        "compile it with AotTarget::max_isa to run on older CPUs"));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::unique_ptr<PjRtLoadedExecutable>> LoadAotExecutable(
+    PjRtClient* client, const AotArtifact& artifact) {
+  TF_RETURN_IF_ERROR(CheckAotCompatible(client, artifact));
+  // The serialized executable carries its compile options
+  return client->LoadSerializedExecutable(artifact.executable, std::nullopt,
+                                          LoadOptions());
+}
+
+}  // namespace extension
+}  // namespace xla
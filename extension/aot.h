@@ -0,0 +1,77 @@
+#ifndef XLA_EXTENSION_AOT_H_
+#define XLA_EXTENSION_AOT_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/shape.h"
+
+namespace xla {
+namespace extension {
+
+// Machine an executable is compiled for ahead of time.
+struct AotTarget {
+  // Highest instruction set the generated code may use, as accepted by
+  // --xla_cpu_max_isa: "SSE4_2", "AVX", "AVX2", "AVX512", "AVX512_VNNI",
+  // "AVX512_BF16", "AMX", "NEON" or "SVE". Empty targets the build
+  // machine, whose CPU features are then recorded in the artifact and
+  // required of the machine loading it.
+  std::string max_isa;
+};
+
+// An executable compiled ahead of time, together with what the loader
+// needs to check and feed it.
+struct AotArtifact {
+  // Client the executable was compiled with, loading requires the same
+  std::string platform_name;
+  std::string platform_version;
+  std::string max_isa;
+  // x86 features of the build machine when compiled without max_isa,
+  // for example "AVX2" or "AVX512F", all required to load the artifact
+  std::vector<std::string> cpu_features;
+  // Parameter and result shapes, so that callers can allocate inputs
+  // without the computation
+  ProgramShape program_shape;
+  // Output of PjRtLoadedExecutable::SerializeExecutable
+  std::string executable;
+};
+
+// Compiles `computation` for `target` and serializes the executable.
+// Meant for a build step (see the xla_aot tool), production processes
+// then only load the artifact.
+absl::StatusOr<AotArtifact> CompileForExport(PjRtClient* client,
+                                             const XlaComputation& computation,
+                                             CompileOptions options,
+                                             const AotTarget& target);
+
+// Versioned binary encoding of an artifact, written to .xla_aot files.
+std::string SerializeAotArtifact(const AotArtifact& artifact);
+absl::StatusOr<AotArtifact> ParseAotArtifact(absl::string_view data);
+
+absl::Status WriteAotArtifact(const std::string& path,
+                              const AotArtifact& artifact);
+absl::StatusOr<AotArtifact> ReadAotArtifact(const std::string& path);
+
+// Checks that `client` can load the artifact: same platform and version,
+// and a host CPU supporting the target instruction set and every
+// recorded CPU feature.
+absl::Status CheckAotCompatible(PjRtClient* client,
+                                const AotArtifact& artifact);
+
+// Loads the executable of an artifact. This only links the object code
+// stored in the artifact, neither the HLO pipeline nor LLVM code
+// generation run, so it takes milliseconds regardless of the model.
+absl::StatusOr<std::unique_ptr<PjRtLoadedExecutable>> LoadAotExecutable(
+    PjRtClient* client, const AotArtifact& artifact);
+
+}  // namespace extension
+}  // namespace xla
+
+#endif  // XLA_EXTENSION_AOT_H_
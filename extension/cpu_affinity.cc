@@ -0,0 +1,242 @@
+#include "xla/extension/cpu_affinity.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/tsl/platform/env.h"
+#include "xla/tsl/platform/errors.h"
+#include "xla/tsl/platform/statusor.h"
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace xla {
+namespace extension {
+
+namespace {
+
+absl::StatusOr<std::vector<int>> ReadCpuList(const std::string& path) {
+  std::string contents;
+  TF_RETURN_IF_ERROR(
+      tsl::ReadFileToString(tsl::Env::Default(), path, &contents));
+  return ParseCpuList(absl::StripAsciiWhitespace(contents));
+}
+
+bool IsEmpty(const CpuPlacement& placement) {
+  return placement.cpus.empty() && placement.numa_node < 0 &&
+         placement.intra_op_threads == 0 &&
+         placement.max_inflight_computations == 0;
+}
+
+#if defined(__linux__)
+
+// Node masks passed to the memory policy syscalls
+constexpr int kMaxNumaNodes = 1024;
+constexpr int kBitsPerWord = 8 * sizeof(unsigned long);
+
+// Affinity and memory policy of a thread
+struct ThreadPlacement {
+  cpu_set_t cpus;
+  // False when the kernel is built without NUMA support
+  bool has_policy = true;
+  int policy = MPOL_DEFAULT;
+  std::vector<unsigned long> nodes =
+      std::vector<unsigned long>(kMaxNumaNodes / kBitsPerWord);
+};
+
+std::vector<int> AllowedCpus() {
+  std::vector<int> cpus;
+  cpu_set_t set;
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) return cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+absl::StatusOr<ThreadPlacement> CurrentPlacement() {
+  ThreadPlacement placement;
+  if (sched_getaffinity(0, sizeof(placement.cpus), &placement.cpus) != 0) {
+    return absl::ErrnoToStatus(errno, "sched_getaffinity");
+  }
+  if (syscall(SYS_get_mempolicy, &placement.policy, placement.nodes.data(),
+              kMaxNumaNodes, nullptr, 0) != 0) {
+    if (errno != ENOSYS) return absl::ErrnoToStatus(errno, "get_mempolicy");
+    placement.has_policy = false;
+  }
+  return placement;
+}
+
+absl::Status SetPlacement(const ThreadPlacement& placement) {
+  if (sched_setaffinity(0, sizeof(placement.cpus), &placement.cpus) != 0) {
+    return absl::ErrnoToStatus(errno, "sched_setaffinity");
+  }
+  if (!placement.has_policy) return absl::OkStatus();
+  // The default policy takes no nodes
+  bool has_nodes = (placement.policy & ~MPOL_MODE_FLAGS) != MPOL_DEFAULT;
+  if (syscall(SYS_set_mempolicy, placement.policy,
+              has_nodes ? placement.nodes.data() : nullptr,
+              has_nodes ? kMaxNumaNodes : 0) != 0) {
+    return absl::ErrnoToStatus(errno, "set_mempolicy");
+  }
+  return absl::OkStatus();
+}
+
+// Resolves the CPU set and memory policy of a placement, starting from
+// the current ones
+absl::StatusOr<ThreadPlacement> ResolvePlacement(
+    const CpuPlacement& placement) {
+  TF_ASSIGN_OR_RETURN(ThreadPlacement resolved, CurrentPlacement());
+
+  std::vector<int> cpus = placement.cpus;
+  if (cpus.empty() && placement.numa_node >= 0) {
+    TF_ASSIGN_OR_RETURN(cpus, NumaNodeCpus(placement.numa_node));
+  }
+  if (cpus.empty()) cpus = AllowedCpus();
+  if (placement.intra_op_threads > static_cast<int>(cpus.size())) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("intra_op_threads is ", placement.intra_op_threads,
+                     " but the placement has ", cpus.size(), " CPUs"));
+  }
+  if (placement.intra_op_threads > 0) cpus.resize(placement.intra_op_threads);
+
+  CPU_ZERO(&resolved.cpus);
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+      return absl::InvalidArgumentError(absl::StrCat("invalid CPU ", cpu));
+    }
+    CPU_SET(cpu, &resolved.cpus);
+  }
+
+  if (placement.numa_node >= kMaxNumaNodes) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("invalid NUMA node ", placement.numa_node));
+  }
+  if (placement.numa_node >= 0) {
+    resolved.policy = MPOL_PREFERRED;
+    std::fill(resolved.nodes.begin(), resolved.nodes.end(), 0);
+    resolved.nodes[placement.numa_node / kBitsPerWord] |=
+        1UL << (placement.numa_node % kBitsPerWord);
+  }
+  return resolved;
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace
+
+absl::StatusOr<std::vector<int>> ParseCpuList(absl::string_view list) {
+  std::vector<int> cpus;
+  if (list.empty()) return cpus;
+  for (absl::string_view range : absl::StrSplit(list, ',')) {
+    std::pair<absl::string_view, absl::string_view> bounds =
+        absl::StrSplit(range, absl::MaxSplits('-', 1));
+    int first, last;
+    if (!absl::SimpleAtoi(bounds.first, &first)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("invalid CPU list \"", list, "\""));
+    }
+    last = first;
+    if (!bounds.second.empty() && !absl::SimpleAtoi(bounds.second, &last)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("invalid CPU list \"", list, "\""));
+    }
+    if (first < 0 || last < first) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("invalid CPU range \"", range, "\""));
+    }
+    for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+int NumaNodeCount() {
+  absl::StatusOr<std::vector<int>> nodes =
+      ReadCpuList("/sys/devices/system/node/online");
+  if (!nodes.ok() || nodes->empty()) return 1;
+  return nodes->back() + 1;
+}
+
+absl::StatusOr<std::vector<int>> NumaNodeCpus(int node) {
+#if defined(__linux__)
+  absl::StatusOr<std::vector<int>> node_cpus = ReadCpuList(
+      absl::StrCat("/sys/devices/system/node/node", node, "/cpulist"));
+  if (!node_cpus.ok()) {
+    // Without NUMA support in the kernel every CPU is on node 0
+    if (node == 0) return AllowedCpus();
+    return absl::NotFoundError(absl::StrCat("no NUMA node ", node));
+  }
+
+  std::vector<int> allowed = AllowedCpus();
+  std::vector<int> cpus;
+  for (int cpu : *node_cpus) {
+    if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) {
+      cpus.push_back(cpu);
+    }
+  }
+  if (cpus.empty()) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "the process may not run on any CPU of NUMA node ", node));
+  }
+  return cpus;
+#else
+  return absl::UnimplementedError("NUMA nodes are only supported on Linux");
+#endif
+}
+
+absl::StatusOr<std::unique_ptr<PjRtClient>> GetPlacedCpuClient(
+    CpuClientOptions options, const CpuPlacement& placement) {
+  if (IsEmpty(placement)) return GetPjRtCpuClient(std::move(options));
+#if defined(__linux__)
+  if (placement.max_inflight_computations > 0) {
+    options.max_inflight_computations_per_device =
+        placement.max_inflight_computations;
+  }
+  TF_ASSIGN_OR_RETURN(ThreadPlacement resolved, ResolvePlacement(placement));
+  TF_ASSIGN_OR_RETURN(ThreadPlacement caller, CurrentPlacement());
+
+  // Threads started by the client inherit the placement
+  TF_RETURN_IF_ERROR(SetPlacement(resolved));
+  absl::StatusOr<std::unique_ptr<PjRtClient>> client =
+      GetPjRtCpuClient(std::move(options));
+  absl::Status restored = SetPlacement(caller);
+
+  TF_RETURN_IF_ERROR(client.status());
+  TF_RETURN_IF_ERROR(restored);
+  return client;
+#else
+  return absl::UnimplementedError(
+      "CPU placement is only supported on Linux");
+#endif
+}
+
+absl::Status PlaceCurrentThread(const CpuPlacement& placement) {
+#if defined(__linux__)
+  TF_ASSIGN_OR_RETURN(ThreadPlacement resolved, ResolvePlacement(placement));
+  return SetPlacement(resolved);
+#else
+  if (IsEmpty(placement)) return absl::OkStatus();
+  return absl::UnimplementedError(
+      "CPU placement is only supported on Linux");
+#endif
+}
+
+}  // namespace extension
+}  // namespace xla
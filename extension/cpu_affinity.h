@@ -0,0 +1,66 @@
+#ifndef XLA_EXTENSION_CPU_AFFINITY_H_
+#define XLA_EXTENSION_CPU_AFFINITY_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/pjrt/pjrt_client.h"
+
+namespace xla {
+namespace extension {
+
+// Where the threads and memory of a CPU client live.
+struct CpuPlacement {
+  // CPUs the worker threads may run on. When empty, the CPUs of
+  // `numa_node`, or every CPU of the process without a node.
+  std::vector<int> cpus;
+
+  // NUMA node to allocate memory from, -1 leaves the memory policy alone.
+  // The node is preferred rather than enforced, allocations fall back to
+  // other nodes when it is full.
+  int numa_node = -1;
+
+  // Size of the intra-op (Eigen) pool, which runs the partitions of one
+  // op. 0 uses one thread per CPU of the set, otherwise the pools are
+  // created on the first `intra_op_threads` CPUs of the set only.
+  int intra_op_threads = 0;
+
+  // Executions in flight per device, which bounds inter-op concurrency.
+  // 0 keeps the client default.
+  int max_inflight_computations = 0;
+};
+
+// Parses a Linux CPU list such as "0-3,8-11".
+absl::StatusOr<std::vector<int>> ParseCpuList(absl::string_view list);
+
+// Number of NUMA nodes, 1 when the kernel does not expose them.
+int NumaNodeCount();
+
+// CPUs of a NUMA node that the process may run on.
+absl::StatusOr<std::vector<int>> NumaNodeCpus(int node);
+
+// Creates a CPU client whose worker threads (the intra-op pool and the
+// PjRt thread pools running async work) are pinned to the placement and
+// allocate memory from its node. The runtime has no thread options, so
+// the placement is applied to the calling thread while the client is
+// created, the pools inherit it, and the calling thread is restored
+// afterwards. Host buffers the runtime allocates on those threads are
+// node-local by first touch.
+//
+// Linux only, elsewhere a non-empty placement is Unimplemented.
+absl::StatusOr<std::unique_ptr<PjRtClient>> GetPlacedCpuClient(
+    CpuClientOptions options, const CpuPlacement& placement);
+
+// Pins the calling thread to the placement, for the thread feeding a
+// client created with GetPlacedCpuClient, so that its host buffers are
+// node-local as well.
+absl::Status PlaceCurrentThread(const CpuPlacement& placement);
+
+}  // namespace extension
+}  // namespace xla
+
+#endif  // XLA_EXTENSION_CPU_AFFINITY_H_
@@ -0,0 +1,104 @@
+#include "xla/extension/data_parallel.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "xla/extension/host_buffer.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/pjrt/pjrt_future.h"
+#include "xla/service/computation_placer.h"
+#include "xla/shape_util.h"
+#include "xla/tsl/platform/statusor.h"
+
+namespace xla {
+namespace extension {
+
+absl::StatusOr<CompileOptions> DataParallelCompileOptions(
+    PjRtClient* client, int num_replicas, CompileOptions options) {
+  auto devices = client->addressable_devices();
+  if (num_replicas < 1 || num_replicas > static_cast<int>(devices.size())) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("requested ", num_replicas, " replicas, but the client has ",
+                     devices.size(), " addressable devices"));
+  }
+
+  DeviceAssignment device_assignment(num_replicas, /*computation_count=*/1);
+  for (int replica = 0; replica < num_replicas; replica++) {
+    device_assignment(replica, 0) = devices[replica]->id().value();
+  }
+
+  options.executable_build_options.set_num_replicas(num_replicas);
+  options.executable_build_options.set_num_partitions(1);
+  options.executable_build_options.set_device_assignment(device_assignment);
+  return options;
+}
+
+absl::StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>> ScatterToReplicas(
+    PjRtClient* client, PjRtLoadedExecutable* executable, const void* data,
+    PrimitiveType type, absl::Span<const int64_t> replica_dims) {
+  const int64_t slice_bytes =
+      ShapeUtil::ByteSizeOf(ShapeUtil::MakeShape(type, replica_dims));
+  const char* base = static_cast<const char*>(data);
+
+  std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+  for (PjRtDevice* device : executable->addressable_devices()) {
+    TF_ASSIGN_OR_RETURN(PjRtMemorySpace * memory_space,
+                        device->default_memory_space());
+    TF_ASSIGN_OR_RETURN(
+        std::unique_ptr<PjRtBuffer> buffer,
+        BufferFromHostMemory(client, memory_space,
+                             base + buffers.size() * slice_bytes, type,
+                             replica_dims));
+    buffers.push_back(std::move(buffer));
+  }
+  return buffers;
+}
+
+absl::StatusOr<std::vector<PjRtFuture<>>> GatherFromReplicas(
+    absl::Span<const std::vector<std::unique_ptr<PjRtBuffer>>> results,
+    int output_index, void* dst, size_t dst_size) {
+  char* base = static_cast<char*>(dst);
+  size_t offset = 0;
+
+  std::vector<PjRtFuture<>> futures;
+  for (const auto& replica_results : results) {
+    if (output_index >= static_cast<int>(replica_results.size())) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("replica has ", replica_results.size(),
+                       " outputs, requested output ", output_index));
+    }
+    PjRtBuffer* buffer = replica_results[output_index].get();
+    TF_ASSIGN_OR_RETURN(size_t size, buffer->GetOnDeviceSizeInBytes());
+    if (offset + size > dst_size) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "destination has ", dst_size, " bytes, which is not enough for ",
+          results.size(), " replica outputs"));
+    }
+    futures.push_back(CopyToHostMemory(buffer, base + offset, size));
+    offset += size;
+  }
+  return futures;
+}
+
+std::vector<std::vector<PjRtBuffer*>> ReplicaArgumentHandles(
+    absl::Span<const std::vector<std::unique_ptr<PjRtBuffer>>> arguments) {
+  std::vector<std::vector<PjRtBuffer*>> handles;
+  for (const auto& argument : arguments) {
+    handles.resize(std::max(handles.size(), argument.size()));
+    for (size_t replica = 0; replica < argument.size(); replica++) {
+      handles[replica].push_back(argument[replica].get());
+    }
+  }
+  return handles;
+}
+
+}  // namespace extension
+}  // namespace xla
@@ -0,0 +1,55 @@
+#ifndef XLA_EXTENSION_DATA_PARALLEL_H_
+#define XLA_EXTENSION_DATA_PARALLEL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/pjrt/pjrt_future.h"
+#include "xla/xla_data.pb.h"
+
+namespace xla {
+namespace extension {
+
+// Helpers for running a batch of independent computations as replicas,
+// one per addressable device. On the CPU client, create the client with
+// CpuClientOptions::cpu_device_count set to the number of replicas.
+// Cross-replica collectives (CrossReplicaSum, AllReduce, AllGather) use
+// the client's in-process collectives.
+
+// Returns `options` configured for `num_replicas` replicas, with replica
+// i assigned to addressable device i.
+absl::StatusOr<CompileOptions> DataParallelCompileOptions(
+    PjRtClient* client, int num_replicas,
+    CompileOptions options = CompileOptions());
+
+// Splits a dense host batch of shape [num_replicas, replica_dims...]
+// along the leading dimension and transfers one slice to each device of
+// `executable`. The returned buffers are ordered by replica, ready to be
+// used as one argument in Execute. `data` must stay alive until the
+// buffers are destroyed (see BufferFromHostMemory).
+absl::StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>> ScatterToReplicas(
+    PjRtClient* client, PjRtLoadedExecutable* executable, const void* data,
+    PrimitiveType type, absl::Span<const int64_t> replica_dims);
+
+// Reads back output `output_index` of every replica into consecutive
+// slices of `dst`, producing a dense [num_replicas, ...] batch.
+absl::StatusOr<std::vector<PjRtFuture<>>> GatherFromReplicas(
+    absl::Span<const std::vector<std::unique_ptr<PjRtBuffer>>> results,
+    int output_index, void* dst, size_t dst_size);
+
+// Transposes per-replica argument lists, as returned by
+// ScatterToReplicas, into the argument_handles layout expected by
+// PjRtLoadedExecutable::Execute.
+std::vector<std::vector<PjRtBuffer*>> ReplicaArgumentHandles(
+    absl::Span<const std::vector<std::unique_ptr<PjRtBuffer>>> arguments);
+
+}  // namespace extension
+}  // namespace xla
+
+#endif  // XLA_EXTENSION_DATA_PARALLEL_H_
@@ -0,0 +1,132 @@
+#include "xla/extension/executable_cache.h"
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "google/protobuf/message_lite.h"
+#include "llvm/TargetParser/Host.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/tsl/platform/env.h"
+#include "xla/tsl/platform/errors.h"
+#include "xla/tsl/platform/statusor.h"
+#include "tsl/platform/fingerprint.h"
+
+namespace xla {
+namespace extension {
+
+namespace {
+
+// Bump whenever the key derivation or the entry format changes
+constexpr int kCacheFormatVersion = 1;
+
+constexpr char kEntrySuffix[] = ".xla_executable";
+
+std::string SerializeDeterministic(const google::protobuf::MessageLite& message) {
+  std::string out;
+  {
+    google::protobuf::io::StringOutputStream stream(&out);
+    google::protobuf::io::CodedOutputStream coded(&stream);
+    coded.SetSerializationDeterministic(true);
+    message.SerializeToCodedStream(&coded);
+  }
+  return out;
+}
+
+// Appends a length-prefixed field, so that adjacent fields cannot
+// collide by shifting bytes between them
+void AppendField(std::string* out, absl::string_view field) {
+  absl::StrAppend(out, field.size(), ":", field, ";");
+}
+
+}  // namespace
+
+ExecutableCache::ExecutableCache(std::string directory)
+    : directory_(std::move(directory)) {}
+
+absl::StatusOr<std::string> ExecutableCache::Key(
+    PjRtClient* client, const XlaComputation& computation,
+    const CompileOptions& options) const {
+  TF_ASSIGN_OR_RETURN(CompileOptionsProto options_proto, options.ToProto());
+
+  const char* xla_flags = std::getenv("XLA_FLAGS");
+
+  std::string material;
+  AppendField(&material, absl::StrCat(kCacheFormatVersion));
+  AppendField(&material, client->platform_name());
+  AppendField(&material, client->platform_version());
+  AppendField(&material, absl::StrCat(client->addressable_device_count()));
+  AppendField(&material, llvm::sys::getHostCPUName().str());
+  AppendField(&material, xla_flags == nullptr ? "" : xla_flags);
+  AppendField(&material, SerializeDeterministic(options_proto));
+  AppendField(&material, SerializeDeterministic(computation.proto()));
+
+  tsl::Fprint128 fingerprint = tsl::Fingerprint128(material);
+  return absl::StrFormat("%016x%016x", fingerprint.high64, fingerprint.low64);
+}
+
+std::string ExecutableCache::EntryPath(const std::string& key) const {
+  return absl::StrCat(directory_, "/", key, kEntrySuffix);
+}
+
+absl::StatusOr<std::unique_ptr<PjRtLoadedExecutable>>
+ExecutableCache::CompileAndLoad(PjRtClient* client,
+                                const XlaComputation& computation,
+                                const CompileOptions& options) {
+  tsl::Env* env = tsl::Env::Default();
+
+  TF_ASSIGN_OR_RETURN(std::string key, Key(client, computation, options));
+  std::string path = EntryPath(key);
+
+  if (env->FileExists(path).ok()) {
+    std::string serialized;
+    absl::Status status = tsl::ReadFileToString(env, path, &serialized);
+    if (status.ok()) {
+      auto executable =
+          client->LoadSerializedExecutable(serialized, options, LoadOptions());
+      if (executable.ok()) {
+        stats_.hits++;
+        return executable;
+      }
+    }
+    // The entry may have been written by an incompatible build, or got
+    // truncated, in which case we recompile and overwrite it
+    stats_.load_failures++;
+  }
+
+  stats_.misses++;
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<PjRtLoadedExecutable> executable,
+                      client->CompileAndLoad(computation, options));
+
+  // Failing to store the entry is not fatal, the executable is valid
+  // regardless and we will just compile again next time
+  auto serialized = executable->SerializeExecutable();
+  if (!serialized.ok()) return executable;
+
+  if (!env->RecursivelyCreateDir(directory_).ok()) return executable;
+
+  // Write to a unique temporary file and rename, so that concurrent
+  // readers never observe a partially written entry
+  std::string tmp_path = path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) return executable;
+  if (tsl::WriteStringToFile(env, tmp_path, *serialized).ok() &&
+      env->RenameFile(tmp_path, path).ok()) {
+    stats_.stores++;
+  } else {
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+
+  return executable;
+}
+
+}  // namespace extension
+}  // namespace xla
@@ -0,0 +1,65 @@
+#ifndef XLA_EXTENSION_EXECUTABLE_CACHE_H_
+#define XLA_EXTENSION_EXECUTABLE_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+
+namespace xla {
+namespace extension {
+
+struct ExecutableCacheStats {
+  // Executables loaded from disk instead of compiled
+  int64_t hits = 0;
+  // Executables that had to be compiled
+  int64_t misses = 0;
+  // Cache entries that existed but could not be deserialized
+  int64_t load_failures = 0;
+  // Cache entries written to disk
+  int64_t stores = 0;
+};
+
+// Persistent on-disk cache of compiled executables.
+//
+// Entries are keyed by a fingerprint of the HloModuleProto, the
+// CompileOptions, the client platform/version and the host CPU, and
+// hold the output of PjRtLoadedExecutable::SerializeExecutable. On a hit
+// the executable is deserialized and loaded, skipping compilation
+// entirely. Stale or unreadable entries are recompiled and replaced.
+//
+// The cache is not thread-safe, however separate processes may share
+// the same directory, since entries are written atomically.
+class ExecutableCache {
+ public:
+  explicit ExecutableCache(std::string directory);
+
+  // Returns the cache key for compiling `computation` on `client`.
+  absl::StatusOr<std::string> Key(PjRtClient* client,
+                                  const XlaComputation& computation,
+                                  const CompileOptions& options) const;
+
+  // Drop-in replacement for PjRtClient::CompileAndLoad, which loads the
+  // executable from the cache when possible and stores it otherwise.
+  absl::StatusOr<std::unique_ptr<PjRtLoadedExecutable>> CompileAndLoad(
+      PjRtClient* client, const XlaComputation& computation,
+      const CompileOptions& options);
+
+  const std::string& directory() const { return directory_; }
+  const ExecutableCacheStats& stats() const { return stats_; }
+
+ private:
+  std::string EntryPath(const std::string& key) const;
+
+  std::string directory_;
+  ExecutableCacheStats stats_;
+};
+
+}  // namespace extension
+}  // namespace xla
+
+#endif  // XLA_EXTENSION_EXECUTABLE_CACHE_H_
@@ -0,0 +1,117 @@
+#include "xla/extension/execution_pipeline.h"
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/pjrt/pjrt_future.h"
+#include "xla/tsl/platform/errors.h"
+#include "xla/tsl/platform/statusor.h"
+
+namespace xla {
+namespace extension {
+
+ExecutionPipeline::ExecutionPipeline(PjRtLoadedExecutable* executable,
+                                     Options options, ReadbackFn readback,
+                                     DoneFn done)
+    : executable_(executable),
+      options_(std::move(options)),
+      readback_(std::move(readback)),
+      done_(std::move(done)) {
+  options_.depth = std::max(options_.depth, 1);
+}
+
+ExecutionPipeline::~ExecutionPipeline() { Flush().IgnoreError(); }
+
+absl::StatusOr<int64_t> ExecutionPipeline::NextStep() {
+  if (reserved_) {
+    return absl::FailedPreconditionError(
+        "NextStep called twice without Submit");
+  }
+
+  absl::Status status;
+  while (in_flight_.size() >= static_cast<size_t>(options_.depth)) {
+    status.Update(RetireOldest());
+  }
+  TF_RETURN_IF_ERROR(status);
+
+  reserved_ = true;
+  return next_step_;
+}
+
+absl::Status ExecutionPipeline::Submit(
+    std::vector<std::unique_ptr<PjRtBuffer>> arguments) {
+  if (!reserved_) {
+    return absl::FailedPreconditionError("Submit called without NextStep");
+  }
+  reserved_ = false;
+
+  InFlightStep step;
+  step.id = next_step_++;
+  step.arguments = std::move(arguments);
+
+  std::vector<std::vector<PjRtBuffer*>> argument_handles(1);
+  for (const auto& argument : step.arguments) {
+    argument_handles[0].push_back(argument.get());
+  }
+
+  std::optional<std::vector<PjRtFuture<>>> returned_futures;
+  returned_futures.emplace();
+  TF_ASSIGN_OR_RETURN(
+      std::vector<std::vector<std::unique_ptr<PjRtBuffer>>> results,
+      executable_->Execute(argument_handles, options_.execute_options,
+                           returned_futures));
+  step.outputs = std::move(results[0]);
+  if (returned_futures.has_value() && !returned_futures->empty()) {
+    step.execute_future = std::move((*returned_futures)[0]);
+  }
+
+  if (readback_) {
+    step.readbacks = readback_(step.id, step.outputs);
+  } else {
+    for (const auto& output : step.outputs) {
+      step.readbacks.push_back(output->GetReadyFuture());
+    }
+  }
+
+  in_flight_.push_back(std::move(step));
+  return absl::OkStatus();
+}
+
+absl::Status ExecutionPipeline::Flush() {
+  absl::Status status;
+  while (!in_flight_.empty()) {
+    status.Update(RetireOldest());
+  }
+  return status;
+}
+
+absl::Status ExecutionPipeline::RetireOldest() {
+  InFlightStep step = std::move(in_flight_.front());
+  in_flight_.pop_front();
+
+  absl::Status status;
+  if (step.execute_future.IsValid()) {
+    status.Update(step.execute_future.Await());
+  }
+  for (auto& readback : step.readbacks) {
+    status.Update(readback.Await());
+  }
+
+  // Releasing the arguments hands zero-copy host memory back to the caller
+  step.arguments.clear();
+
+  if (done_) {
+    done_(step.id, status, std::move(step.outputs));
+  }
+  return status;
+}
+
+}  // namespace extension
+}  // namespace xla
@@ -0,0 +1,108 @@
+#ifndef XLA_EXTENSION_EXECUTION_PIPELINE_H_
+#define XLA_EXTENSION_EXECUTION_PIPELINE_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/pjrt/pjrt_future.h"
+
+namespace xla {
+namespace extension {
+
+// Keeps up to `depth` steps of a single-device executable in flight, so
+// that host-to-device transfers of the next step and readback of the
+// previous step overlap with execution of the current one. Requires a
+// client created with CpuClientOptions::asynchronous = true.
+//
+// A step goes through:
+//
+//   1. NextStep() - blocks while `depth` steps are in flight (backpressure)
+//      and returns the step id. Once it returns, host memory of slot
+//      `step % depth` is no longer used by the pipeline.
+//   2. The caller fills host memory of that slot and creates the argument
+//      buffers (for example with BufferFromHostMemory).
+//   3. Submit() - enqueues the execution and starts the readback of its
+//      outputs, without waiting for either.
+//
+// Steps complete in order. With depth 2 (double buffering) the transfer
+// of step N+1 overlaps with execution of step N, with depth 3 (triple
+// buffering) the readback of step N-1 overlaps as well.
+//
+// The pipeline is not thread-safe, it is meant to be driven by a single
+// producer thread.
+class ExecutionPipeline {
+ public:
+  struct Options {
+    // Maximum number of steps in flight
+    int depth = 2;
+    ExecuteOptions execute_options;
+  };
+
+  // Starts the readback of the outputs of `step` and returns the futures
+  // to wait on before the step is considered complete.
+  using ReadbackFn = absl::AnyInvocable<std::vector<PjRtFuture<>>(
+      int64_t step, absl::Span<const std::unique_ptr<PjRtBuffer>> outputs)>;
+
+  // Called in step order once a step is complete. The outputs are handed
+  // over to the callback, so they can be fed back into a later step.
+  using DoneFn = absl::AnyInvocable<void(
+      int64_t step, absl::Status status,
+      std::vector<std::unique_ptr<PjRtBuffer>> outputs)>;
+
+  // When `readback` is null, a step is complete once its outputs are
+  // ready on the device.
+  ExecutionPipeline(PjRtLoadedExecutable* executable, Options options,
+                    ReadbackFn readback = nullptr, DoneFn done = nullptr);
+
+  ~ExecutionPipeline();
+
+  ExecutionPipeline(const ExecutionPipeline&) = delete;
+  ExecutionPipeline& operator=(const ExecutionPipeline&) = delete;
+
+  // Applies backpressure and reserves the next step. Returns the first
+  // error of a step retired while waiting.
+  absl::StatusOr<int64_t> NextStep();
+
+  // Enqueues the step reserved by the preceding NextStep call. The
+  // argument buffers are kept alive until the step completes.
+  absl::Status Submit(std::vector<std::unique_ptr<PjRtBuffer>> arguments);
+
+  // Waits for all steps in flight and returns the first error, if any.
+  absl::Status Flush();
+
+  int depth() const { return options_.depth; }
+  int64_t in_flight() const { return in_flight_.size(); }
+  int slot(int64_t step) const { return step % options_.depth; }
+
+ private:
+  struct InFlightStep {
+    int64_t id;
+    std::vector<std::unique_ptr<PjRtBuffer>> arguments;
+    std::vector<std::unique_ptr<PjRtBuffer>> outputs;
+    PjRtFuture<> execute_future;
+    std::vector<PjRtFuture<>> readbacks;
+  };
+
+  absl::Status RetireOldest();
+
+  PjRtLoadedExecutable* executable_;
+  Options options_;
+  ReadbackFn readback_;
+  DoneFn done_;
+  std::deque<InFlightStep> in_flight_;
+  int64_t next_step_ = 0;
+  bool reserved_ = false;
+};
+
+}  // namespace extension
+}  // namespace xla
+
+#endif  // XLA_EXTENSION_EXECUTION_PIPELINE_H_
@@ -0,0 +1,105 @@
+#include "xla/extension/hlo_loader.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "google/protobuf/text_format.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/parser/hlo_parser.h"
+#include "xla/pjrt/mlir_to_hlo.h"
+#include "xla/service/hlo.pb.h"
+#include "xla/tsl/platform/env.h"
+#include "xla/tsl/platform/errors.h"
+#include "xla/tsl/platform/statusor.h"
+
+namespace xla {
+namespace extension {
+
+absl::StatusOr<HloFormat> HloFormatFromPath(absl::string_view path) {
+  if (absl::EndsWith(path, ".hlo") || absl::EndsWith(path, ".txt")) {
+    return HloFormat::kHloText;
+  }
+  if (absl::EndsWith(path, ".pb")) return HloFormat::kHloProto;
+  if (absl::EndsWith(path, ".pbtxt")) return HloFormat::kHloProtoText;
+  if (absl::EndsWith(path, ".mlir") || absl::EndsWith(path, ".mlirbc")) {
+    return HloFormat::kMlir;
+  }
+  return absl::InvalidArgumentError(absl::StrCat(
+      "cannot guess the format of ", path,
+      ", expected .hlo, .txt, .pb, .pbtxt, .mlir or .mlirbc"));
+}
+
+absl::StatusOr<XlaComputation> ParseComputation(absl::string_view contents,
+                                                HloFormat format) {
+  switch (format) {
+    case HloFormat::kHloText: {
+      TF_ASSIGN_OR_RETURN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnUnverifiedModule(contents));
+      return XlaComputation(module->ToProto());
+    }
+    case HloFormat::kHloProto: {
+      HloModuleProto proto;
+      // An HloProto also parses as an HloModuleProto, without computations
+      if (proto.ParseFromString(contents) && proto.computations_size() > 0) {
+        return XlaComputation(std::move(proto));
+      }
+      HloProto hlo_proto;
+      if (hlo_proto.ParseFromString(contents) && hlo_proto.has_hlo_module()) {
+        return XlaComputation(hlo_proto.hlo_module());
+      }
+      return absl::InvalidArgumentError(
+          "not a binary HloModuleProto or HloProto");
+    }
+    case HloFormat::kHloProtoText: {
+      HloModuleProto proto;
+      if (!google::protobuf::TextFormat::ParseFromString(std::string(contents),
+                                                         &proto)) {
+        return absl::InvalidArgumentError("not a text HloModuleProto");
+      }
+      return XlaComputation(std::move(proto));
+    }
+    case HloFormat::kMlir: {
+      mlir::MLIRContext context;
+      TF_ASSIGN_OR_RETURN(mlir::OwningOpRef<mlir::ModuleOp> module,
+                          ParseMlirModuleString(contents, context));
+      XlaComputation computation;
+      TF_RETURN_IF_ERROR(MlirToXlaComputation(*module, computation,
+                                              /*use_tuple_args=*/false,
+                                              /*return_tuple=*/false));
+      return computation;
+    }
+  }
+  return absl::InvalidArgumentError("unknown HLO format");
+}
+
+absl::StatusOr<XlaComputation> LoadComputation(const std::string& path) {
+  TF_ASSIGN_OR_RETURN(HloFormat format, HloFormatFromPath(path));
+  return LoadComputation(path, format);
+}
+
+absl::StatusOr<XlaComputation> LoadComputation(const std::string& path,
+                                               HloFormat format) {
+  std::string contents;
+  TF_RETURN_IF_ERROR(
+      tsl::ReadFileToString(tsl::Env::Default(), path, &contents));
+  absl::StatusOr<XlaComputation> computation =
+      ParseComputation(contents, format);
+  if (!computation.ok()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "failed to load ", path, ": ", computation.status().message()));
+  }
+  return computation;
+}
+
+}  // namespace extension
+}  // namespace xla
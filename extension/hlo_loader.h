@@ -0,0 +1,44 @@
+#ifndef XLA_EXTENSION_HLO_LOADER_H_
+#define XLA_EXTENSION_HLO_LOADER_H_
+
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/builder/xla_computation.h"
+
+namespace xla {
+namespace extension {
+
+enum class HloFormat {
+  // HLO text, as printed by HloModule::ToString and --xla_dump_to
+  kHloText,
+  // Binary HloModuleProto, or HloProto as dumped with
+  // --xla_dump_hlo_as_proto
+  kHloProto,
+  // HloModuleProto in protobuf text format
+  kHloProtoText,
+  // StableHLO or MHLO module, as text or bytecode
+  kMlir,
+};
+
+// Guesses the format from the file extension: .hlo and .txt are HLO text,
+// .pb is a binary proto, .pbtxt a text proto and .mlir/.mlirbc MLIR.
+absl::StatusOr<HloFormat> HloFormatFromPath(absl::string_view path);
+
+// Parses a computation in the given format. The result can be passed to
+// PjRtClient::CompileAndLoad.
+absl::StatusOr<XlaComputation> ParseComputation(absl::string_view contents,
+                                                HloFormat format);
+
+// Reads and parses a computation, with the format from the extension.
+// Modules calling the custom calls of spatial_kernels.h only compile
+// once RegisterSpatialKernels() has run.
+absl::StatusOr<XlaComputation> LoadComputation(const std::string& path);
+absl::StatusOr<XlaComputation> LoadComputation(const std::string& path,
+                                               HloFormat format);
+
+}  // namespace extension
+}  // namespace xla
+
+#endif  // XLA_EXTENSION_HLO_LOADER_H_
@@ -0,0 +1,303 @@
+#include "xla/extension/host_allocator.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xla/extension/host_buffer.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/shape_util.h"
+#include "xla/tsl/framework/allocator.h"
+#include "tsl/platform/mem.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace xla {
+namespace extension {
+
+namespace {
+
+constexpr size_t kMinBlockSize = kHostBufferAlignment;
+constexpr size_t kHugePageSize = size_t{2} << 20;
+// Blocks below this size are carved out of huge-page slabs
+constexpr size_t kMaxSlabBlockSize = size_t{1} << 20;
+
+constexpr bool kHugePagesSupported =
+#if defined(__linux__)
+    true;
+#else
+    false;
+#endif
+
+size_t RoundUp(size_t size, size_t multiple) {
+  return (size + multiple - 1) / multiple * multiple;
+}
+
+int Log2(size_t power_of_two) { return __builtin_ctzll(power_of_two); }
+
+// Classes alternate between powers of two and their midpoints, starting
+// at kMinBlockSize: 64 -> 0, 96 -> 1, 128 -> 2, 192 -> 3, ...
+int SizeClass(size_t block_size) {
+  const int min_log2 = Log2(kMinBlockSize);
+  if ((block_size & (block_size - 1)) == 0) {
+    return 2 * (Log2(block_size) - min_log2);
+  }
+  return 2 * (Log2(block_size / 3 * 2) - min_log2) + 1;
+}
+
+}  // namespace
+
+PoolAllocator::PoolAllocator(PoolAllocatorOptions options)
+    : options_(std::move(options)) {
+  free_lists_.resize(SizeClass(BlockSize(options_.max_block_size)) + 1);
+}
+
+PoolAllocator::~PoolAllocator() {
+  absl::MutexLock lock(&mu_);
+  if (!live_.empty()) {
+    LOG(ERROR) << "PoolAllocator destroyed with " << live_.size()
+               << " live allocations, which are leaked";
+  }
+  for (auto& free_list : free_lists_) {
+    for (const FreeBlock& block : free_list) {
+      if (!block.from_slab) FreeToSystem(block.ptr);
+    }
+  }
+  for (char* slab : slabs_) FreeToSystem(slab);
+}
+
+size_t PoolAllocator::BlockSize(size_t num_bytes) {
+  size_t size = kMinBlockSize;
+  while (size < num_bytes) {
+    if (size + size / 2 >= num_bytes) return size + size / 2;
+    size *= 2;
+  }
+  return size;
+}
+
+void* PoolAllocator::AllocateFromSystem(size_t size, size_t alignment,
+                                        bool pooled, bool* from_slab) {
+  *from_slab = false;
+  if (!options_.huge_pages || !kHugePagesSupported ||
+      alignment > kHugePageSize) {
+    return tsl::port::AlignedMalloc(size, alignment);
+  }
+
+  if (pooled && size < kMaxSlabBlockSize) {
+    if (slabs_.empty() || slab_offset_ + size > kHugePageSize) {
+      char* slab = static_cast<char*>(AllocateFromSystem(
+          kHugePageSize, kHugePageSize, /*pooled=*/false, from_slab));
+      if (slab == nullptr) return nullptr;
+      slabs_.push_back(slab);
+      slab_offset_ = 0;
+    }
+    void* ptr = slabs_.back() + slab_offset_;
+    slab_offset_ = RoundUp(slab_offset_ + size, kHostBufferAlignment);
+    *from_slab = true;
+    return ptr;
+  }
+
+  // Whole huge pages, so that the kernel can back them with huge pages
+  void* ptr = nullptr;
+  if (posix_memalign(&ptr, kHugePageSize, RoundUp(size, kHugePageSize)) != 0) {
+    return nullptr;
+  }
+#if defined(__linux__)
+  // Only a hint, transparent huge pages may be disabled
+  madvise(ptr, RoundUp(size, kHugePageSize), MADV_HUGEPAGE);
+#endif
+  return ptr;
+}
+
+void PoolAllocator::FreeToSystem(void* ptr) {
+  // Both posix_memalign and AlignedMalloc memory is released with free
+  tsl::port::AlignedFree(ptr);
+}
+
+void* PoolAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  const size_t block_size = BlockSize(num_bytes);
+  const bool pooled = alignment <= kHostBufferAlignment &&
+                      block_size <= options_.max_block_size;
+
+  absl::MutexLock lock(&mu_);
+  Block block{num_bytes, block_size, pooled ? SizeClass(block_size) : -1,
+              /*from_slab=*/false};
+  void* ptr = nullptr;
+
+  if (!pooled) {
+    block.size = RoundUp(std::max<size_t>(num_bytes, 1), kHostBufferAlignment);
+    ptr = AllocateFromSystem(block.size,
+                             std::max(alignment, kHostBufferAlignment),
+                             /*pooled=*/false, &block.from_slab);
+    stats_.misses++;
+  } else if (auto& free_list = free_lists_[block.size_class];
+             !free_list.empty()) {
+    ptr = free_list.back().ptr;
+    block.from_slab = free_list.back().from_slab;
+    free_list.pop_back();
+    stats_.cached_bytes -= block.size;
+    stats_.hits++;
+  } else {
+    ptr = AllocateFromSystem(block.size, kHostBufferAlignment,
+                             /*pooled=*/true, &block.from_slab);
+    stats_.misses++;
+  }
+  if (ptr == nullptr) return nullptr;
+
+  live_[ptr] = block;
+  stats_.allocations++;
+  stats_.bytes_in_use += num_bytes;
+  stats_.block_bytes_in_use += block.size;
+  stats_.peak_bytes_in_use =
+      std::max(stats_.peak_bytes_in_use, stats_.block_bytes_in_use);
+  largest_alloc_size_ =
+      std::max(largest_alloc_size_, static_cast<int64_t>(num_bytes));
+  return ptr;
+}
+
+void PoolAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+
+  absl::MutexLock lock(&mu_);
+  auto it = live_.find(ptr);
+  CHECK(it != live_.end()) << "PoolAllocator: freeing unknown pointer " << ptr;
+  Block block = it->second;
+  live_.erase(it);
+
+  stats_.bytes_in_use -= block.requested;
+  stats_.block_bytes_in_use -= block.size;
+
+  // Slab blocks cannot be released on their own, so they are always kept
+  bool cache = block.size_class >= 0 &&
+               (block.from_slab || stats_.cached_bytes + block.size <=
+                                       options_.max_cached_bytes);
+  if (!cache) {
+    FreeToSystem(ptr);
+    return;
+  }
+  free_lists_[block.size_class].push_back({ptr, block.from_slab});
+  stats_.cached_bytes += block.size;
+}
+
+size_t PoolAllocator::RequestedSize(const void* ptr) const {
+  absl::MutexLock lock(&mu_);
+  auto it = live_.find(ptr);
+  CHECK(it != live_.end()) << "PoolAllocator: unknown pointer " << ptr;
+  return it->second.requested;
+}
+
+size_t PoolAllocator::AllocatedSize(const void* ptr) const {
+  absl::MutexLock lock(&mu_);
+  auto it = live_.find(ptr);
+  CHECK(it != live_.end()) << "PoolAllocator: unknown pointer " << ptr;
+  return it->second.size;
+}
+
+std::optional<tsl::AllocatorStats> PoolAllocator::GetStats() {
+  absl::MutexLock lock(&mu_);
+  tsl::AllocatorStats stats;
+  stats.num_allocs = stats_.allocations;
+  stats.bytes_in_use = stats_.block_bytes_in_use;
+  stats.peak_bytes_in_use = stats_.peak_bytes_in_use;
+  stats.largest_alloc_size = largest_alloc_size_;
+  stats.bytes_reserved = stats_.cached_bytes;
+  return stats;
+}
+
+bool PoolAllocator::ClearStats() {
+  absl::MutexLock lock(&mu_);
+  stats_.allocations = 0;
+  stats_.hits = 0;
+  stats_.misses = 0;
+  stats_.peak_bytes_in_use = stats_.block_bytes_in_use;
+  largest_alloc_size_ = 0;
+  return true;
+}
+
+PoolAllocatorStats PoolAllocator::Stats() const {
+  absl::MutexLock lock(&mu_);
+  return stats_;
+}
+
+void PoolAllocator::Trim() {
+  absl::MutexLock lock(&mu_);
+  for (size_t size_class = 0; size_class < free_lists_.size(); size_class++) {
+    auto& free_list = free_lists_[size_class];
+    auto slab_blocks = std::partition(
+        free_list.begin(), free_list.end(),
+        [](const FreeBlock& block) { return block.from_slab; });
+    for (auto it = slab_blocks; it != free_list.end(); ++it) {
+      FreeToSystem(it->ptr);
+    }
+    // Classes alternate between powers of two and midpoints
+    size_t power = kMinBlockSize << (size_class / 2);
+    size_t block_size = size_class % 2 == 0 ? power : power + power / 2;
+    stats_.cached_bytes -= block_size * (free_list.end() - slab_blocks);
+    free_list.erase(slab_blocks, free_list.end());
+  }
+}
+
+PooledHostBuffer::PooledHostBuffer(std::shared_ptr<PoolAllocator> allocator,
+                                   size_t size)
+    : allocator_(std::move(allocator)),
+      data_(allocator_->AllocateRaw(kHostBufferAlignment, size)),
+      size_(size) {
+  CHECK(data_ != nullptr) << "PooledHostBuffer: out of memory allocating "
+                          << size << " bytes";
+}
+
+PooledHostBuffer::~PooledHostBuffer() {
+  if (data_ != nullptr) allocator_->DeallocateRaw(data_);
+}
+
+PooledHostBuffer::PooledHostBuffer(PooledHostBuffer&& other)
+    : allocator_(std::move(other.allocator_)),
+      data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+PooledHostBuffer& PooledHostBuffer::operator=(PooledHostBuffer&& other) {
+  if (this != &other) {
+    if (data_ != nullptr) allocator_->DeallocateRaw(data_);
+    allocator_ = std::move(other.allocator_);
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+absl::StatusOr<std::unique_ptr<PjRtBuffer>> BufferFromPooledHostBuffer(
+    PjRtClient* client, PjRtMemorySpace* memory_space, PooledHostBuffer buffer,
+    PrimitiveType type, absl::Span<const int64_t> dims) {
+  int64_t size = ShapeUtil::ByteSizeOfElements(ShapeUtil::MakeShape(type, dims));
+  if (static_cast<size_t>(size) > buffer.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("pooled buffer has ", buffer.size(), " bytes, but ",
+                     PrimitiveType_Name(type), "[", absl::StrJoin(dims, ","),
+                     "] requires ", size, " bytes"));
+  }
+
+  const void* data = buffer.data();
+  return BufferFromHostMemory(
+      client, memory_space, data, type, dims,
+      [buffer = std::move(buffer)]() mutable {
+        // Back to the pool now rather than when the callback is destroyed
+        PooledHostBuffer released = std::move(buffer);
+      });
+}
+
+}  // namespace extension
+}  // namespace xla
@@ -0,0 +1,173 @@
+#ifndef XLA_EXTENSION_HOST_ALLOCATOR_H_
+#define XLA_EXTENSION_HOST_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/tsl/framework/allocator.h"
+#include "xla/xla_data.pb.h"
+
+namespace xla {
+namespace extension {
+
+struct PoolAllocatorOptions {
+  // Back the pool with transparent huge pages (Linux only, elsewhere the
+  // option is ignored). Blocks below 1MB are then carved out of 2MB
+  // slabs, which are only returned to the system when the pool is
+  // destroyed.
+  bool huge_pages = false;
+
+  // Larger requests bypass the pool and go straight to the system.
+  size_t max_block_size = size_t{64} << 20;
+
+  // Free blocks kept for reuse, blocks released past this limit are
+  // returned to the system.
+  size_t max_cached_bytes = size_t{256} << 20;
+};
+
+struct PoolAllocatorStats {
+  // AllocateRaw calls, split into requests served from a free list
+  // (hits) and requests that took memory from the system (misses)
+  int64_t allocations = 0;
+  int64_t hits = 0;
+  int64_t misses = 0;
+
+  // Bytes requested by live allocations, and the size of the blocks
+  // backing them after rounding up to the size class
+  int64_t bytes_in_use = 0;
+  int64_t block_bytes_in_use = 0;
+  int64_t peak_bytes_in_use = 0;
+
+  // Free blocks held by the pool
+  int64_t cached_bytes = 0;
+
+  double hit_rate() const {
+    return allocations > 0 ? static_cast<double>(hits) / allocations : 0;
+  }
+
+  // Share of the memory held by the pool that does not back requested
+  // bytes, from size-class rounding and from cached blocks.
+  double fragmentation() const {
+    int64_t held = block_bytes_in_use + cached_bytes;
+    return held > 0 ? 1.0 - static_cast<double>(bytes_in_use) / held : 0;
+  }
+};
+
+// Thread-safe size-class pool for host memory. Sizes are rounded up to
+// classes spaced by powers of two and their midpoints (64, 96, 128, 192,
+// ... bytes), and freed blocks are kept per class, so that step loops
+// allocating the same tensor sizes over and over stop hitting malloc
+// after the first step. All blocks are aligned to kHostBufferAlignment,
+// which lets the CPU client alias them (see host_buffer.h).
+//
+// The CPU client allocates its own buffers with aligned malloc and has
+// no allocator option, so the pool is plugged in where host memory
+// enters the client: PooledHostBuffer below is staging memory that the
+// device buffer aliases and hands back to the pool when it is destroyed.
+// The pool is also a tsl::Allocator, for any other API taking one.
+class PoolAllocator : public tsl::Allocator {
+ public:
+  explicit PoolAllocator(PoolAllocatorOptions options = {});
+  ~PoolAllocator() override;
+
+  std::string Name() override { return "xla_extension_pool"; }
+
+  // Requests aligned above kHostBufferAlignment bypass the pool.
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  bool TracksAllocationSizes() const override { return true; }
+  size_t RequestedSize(const void* ptr) const override;
+  size_t AllocatedSize(const void* ptr) const override;
+
+  std::optional<tsl::AllocatorStats> GetStats() override;
+  bool ClearStats() override;
+
+  PoolAllocatorStats Stats() const;
+
+  // Returns the cached blocks to the system, except for blocks carved
+  // out of huge-page slabs.
+  void Trim();
+
+  // Size of the block serving a request of `num_bytes`.
+  static size_t BlockSize(size_t num_bytes);
+
+ private:
+  struct Block {
+    size_t requested;
+    size_t size;
+    // Index of the size class, or -1 for blocks bypassing the pool
+    int size_class;
+    bool from_slab;
+  };
+
+  struct FreeBlock {
+    void* ptr;
+    bool from_slab;
+  };
+
+  // Only pooled blocks may be carved out of a slab, as they are never
+  // freed on their own.
+  void* AllocateFromSystem(size_t size, size_t alignment, bool pooled,
+                           bool* from_slab) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void FreeToSystem(void* ptr);
+
+  const PoolAllocatorOptions options_;
+
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<const void*, Block> live_ ABSL_GUARDED_BY(mu_);
+  std::vector<std::vector<FreeBlock>> free_lists_ ABSL_GUARDED_BY(mu_);
+  std::vector<char*> slabs_ ABSL_GUARDED_BY(mu_);
+  size_t slab_offset_ ABSL_GUARDED_BY(mu_) = 0;
+  PoolAllocatorStats stats_ ABSL_GUARDED_BY(mu_);
+  int64_t largest_alloc_size_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+// Owning host allocation from a PoolAllocator, the pooled counterpart of
+// AlignedHostBuffer. The block goes back to the pool on destruction.
+class PooledHostBuffer {
+ public:
+  PooledHostBuffer() = default;
+  PooledHostBuffer(std::shared_ptr<PoolAllocator> allocator, size_t size);
+  ~PooledHostBuffer();
+
+  PooledHostBuffer(PooledHostBuffer&& other);
+  PooledHostBuffer& operator=(PooledHostBuffer&& other);
+
+  void* data() { return data_; }
+  const void* data() const { return data_; }
+  size_t size() const { return size_; }
+
+  template <typename T>
+  absl::Span<T> as_span() {
+    return absl::MakeSpan(static_cast<T*>(data()), size_ / sizeof(T));
+  }
+
+ private:
+  std::shared_ptr<PoolAllocator> allocator_;
+  void* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+// Creates a device buffer from pooled host memory, taking ownership of
+// `buffer`. The CPU client aliases the memory, which returns to the pool
+// once the device buffer is destroyed; on other clients it returns as
+// soon as the transfer completes.
+absl::StatusOr<std::unique_ptr<PjRtBuffer>> BufferFromPooledHostBuffer(
+    PjRtClient* client, PjRtMemorySpace* memory_space, PooledHostBuffer buffer,
+    PrimitiveType type, absl::Span<const int64_t> dims);
+
+}  // namespace extension
+}  // namespace xla
+
+#endif  // XLA_EXTENSION_HOST_ALLOCATOR_H_
@@ -0,0 +1,89 @@
+#include "xla/extension/host_buffer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "xla/literal.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_future.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "tsl/platform/mem.h"
+
+namespace xla {
+namespace extension {
+
+AlignedHostBuffer::AlignedHostBuffer(size_t size)
+    : data_(tsl::port::AlignedMalloc(std::max<size_t>(size, 1),
+                                     kHostBufferAlignment)),
+      size_(size) {}
+
+void AlignedHostBuffer::Deleter::operator()(void* ptr) const {
+  tsl::port::AlignedFree(ptr);
+}
+
+bool IsZeroCopyAligned(const void* data) {
+  return (reinterpret_cast<uintptr_t>(data) & (kHostBufferAlignment - 1)) == 0;
+}
+
+absl::StatusOr<std::unique_ptr<PjRtBuffer>> BufferFromHostMemory(
+    PjRtClient* client, PjRtMemorySpace* memory_space, const void* data,
+    PrimitiveType type, absl::Span<const int64_t> dims,
+    absl::AnyInvocable<void() &&> on_done_with_host_buffer) {
+  // With kImmutableZeroCopy the CPU client aliases the memory when the
+  // alignment and layout allow it, and falls back to a copy otherwise.
+  // For unaligned memory we ask for the copy upfront, so that the caller
+  // gets their memory back as soon as the transfer is done.
+  auto semantics =
+      IsZeroCopyAligned(data)
+          ? PjRtClient::HostBufferSemantics::kImmutableZeroCopy
+          : PjRtClient::HostBufferSemantics::kImmutableUntilTransferCompletes;
+
+  return client->BufferFromHostBuffer(
+      data, type, dims, /*byte_strides=*/std::nullopt, semantics,
+      std::move(on_done_with_host_buffer), memory_space,
+      /*device_layout=*/nullptr);
+}
+
+PjRtFuture<> CopyToHostMemory(PjRtBuffer* buffer, void* dst, size_t dst_size) {
+  const Shape& device_shape = buffer->on_device_shape();
+  if (!device_shape.IsArray()) {
+    return PjRtFuture<>(absl::InvalidArgumentError(
+        "CopyToHostMemory only supports array buffers"));
+  }
+
+  Shape host_shape = ShapeUtil::MakeShapeWithDescendingLayout(
+      device_shape.element_type(), device_shape.dimensions());
+  int64_t size = ShapeUtil::ByteSizeOf(host_shape);
+  if (static_cast<size_t>(size) > dst_size) {
+    return PjRtFuture<>(absl::InvalidArgumentError(
+        absl::StrCat("destination has ", dst_size, " bytes, but ",
+                     host_shape.ToString(), " requires ", size, " bytes")));
+  }
+
+  // The borrowing literal is just a view over `dst`, we keep it alive
+  // until the transfer is done
+  auto literal = std::make_shared<MutableBorrowingLiteral>(
+      static_cast<char*>(dst), host_shape);
+  PjRtFuture<> future = buffer->ToLiteral(literal.get());
+  future.OnReady([literal](absl::Status) {});
+  return future;
+}
+
+bool AliasesHostMemory(PjRtClient* client, PjRtBuffer* buffer,
+                       const void* data) {
+  auto pointer = client->UnsafeBufferPointer(buffer);
+  return pointer.ok() && *pointer == reinterpret_cast<uintptr_t>(data);
+}
+
+}  // namespace extension
+}  // namespace xla
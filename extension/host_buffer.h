@@ -0,0 +1,82 @@
+#ifndef XLA_EXTENSION_HOST_BUFFER_H_
+#define XLA_EXTENSION_HOST_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_future.h"
+#include "xla/shape.h"
+#include "xla/xla_data.pb.h"
+
+namespace xla {
+namespace extension {
+
+// Alignment required for the CPU client to alias host memory instead of
+// copying it. Memory allocated by AlignedHostBuffer always satisfies it.
+inline constexpr size_t kHostBufferAlignment = 64;
+
+// Owning, suitably aligned host allocation, meant to be reused across
+// steps as the source of device buffers or the destination of readbacks.
+class AlignedHostBuffer {
+ public:
+  AlignedHostBuffer() = default;
+  explicit AlignedHostBuffer(size_t size);
+
+  AlignedHostBuffer(AlignedHostBuffer&&) = default;
+  AlignedHostBuffer& operator=(AlignedHostBuffer&&) = default;
+
+  void* data() { return data_.get(); }
+  const void* data() const { return data_.get(); }
+  size_t size() const { return size_; }
+
+  template <typename T>
+  absl::Span<T> as_span() {
+    return absl::MakeSpan(static_cast<T*>(data()), size_ / sizeof(T));
+  }
+
+ private:
+  struct Deleter {
+    void operator()(void* ptr) const;
+  };
+
+  std::unique_ptr<void, Deleter> data_;
+  size_t size_ = 0;
+};
+
+// Returns true if `data` is aligned such that the CPU client can use it
+// directly as device memory.
+bool IsZeroCopyAligned(const void* data);
+
+// Creates a device buffer directly from caller-owned host memory, without
+// going through a Literal.
+//
+// When `data` is aligned to kHostBufferAlignment (and the client supports
+// it) the buffer aliases the host memory, which must then stay alive and
+// unmodified until `on_done_with_host_buffer` is called, that is, until
+// the device buffer is destroyed. Otherwise the memory is copied once and
+// `on_done_with_host_buffer` is called as soon as the transfer completes.
+// The memory is assumed to be dense, in major-to-minor order.
+absl::StatusOr<std::unique_ptr<PjRtBuffer>> BufferFromHostMemory(
+    PjRtClient* client, PjRtMemorySpace* memory_space, const void* data,
+    PrimitiveType type, absl::Span<const int64_t> dims,
+    absl::AnyInvocable<void() &&> on_done_with_host_buffer = nullptr);
+
+// Asynchronously copies the contents of `buffer` into caller-owned host
+// memory of at least `dst_size` bytes, without allocating an intermediate
+// Literal. `dst` must stay alive until the returned future is ready.
+PjRtFuture<> CopyToHostMemory(PjRtBuffer* buffer, void* dst, size_t dst_size);
+
+// Returns true if `buffer` shares memory with `data`, i.e. it was created
+// without a copy. Only meaningful for the CPU client.
+bool AliasesHostMemory(PjRtClient* client, PjRtBuffer* buffer,
+                       const void* data);
+
+}  // namespace extension
+}  // namespace xla
+
+#endif  // XLA_EXTENSION_HOST_BUFFER_H_
@@ -0,0 +1,144 @@
+#include "xla/extension/low_precision.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/literal.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/primitive_util.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/tsl/platform/statusor.h"
+#include "xla/xla_data.pb.h"
+
+namespace xla {
+namespace extension {
+
+namespace {
+
+absl::Status CheckInt4Type(PrimitiveType type) {
+  if (type != S4 && type != U4) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("expected S4 or U4, got ",
+                     primitive_util::LowercasePrimitiveTypeName(type)));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+bool IsLowPrecisionType(PrimitiveType type) {
+  switch (type) {
+    case BF16:
+    case F8E4M3FN:
+    case F8E5M2:
+    case S8:
+    case U8:
+    case S4:
+    case U4:
+      return true;
+    default:
+      return false;
+  }
+}
+
+int64_t PackedByteSize(PrimitiveType type, int64_t num_elements) {
+  return (primitive_util::BitWidth(type) * num_elements + 7) / 8;
+}
+
+void PackInt4(absl::Span<const int8_t> values, absl::Span<uint8_t> packed) {
+  for (size_t i = 0; i < packed.size(); i++) {
+    uint8_t byte = 0;
+    if (2 * i < values.size()) byte |= values[2 * i] & 0x0f;
+    if (2 * i + 1 < values.size()) byte |= (values[2 * i + 1] & 0x0f) << 4;
+    packed[i] = byte;
+  }
+}
+
+void UnpackInt4(absl::Span<const uint8_t> packed, bool is_signed,
+                absl::Span<int8_t> values) {
+  for (size_t i = 0; i < values.size(); i++) {
+    int8_t nibble = (packed[i / 2] >> (4 * (i % 2))) & 0x0f;
+    // Sign-extends from bit 3
+    if (is_signed && (nibble & 0x08)) nibble -= 16;
+    values[i] = nibble;
+  }
+}
+
+absl::StatusOr<std::unique_ptr<PjRtBuffer>> BufferFromPackedInt4(
+    PjRtClient* client, PjRtMemorySpace* memory_space,
+    absl::Span<const uint8_t> packed, PrimitiveType type,
+    absl::Span<const int64_t> dims) {
+  TF_RETURN_IF_ERROR(CheckInt4Type(type));
+  const int64_t num_elements = ShapeUtil::ElementsIn(
+      ShapeUtil::MakeShape(type, dims));
+  if (static_cast<int64_t>(packed.size()) !=
+      PackedByteSize(type, num_elements)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("expected ", PackedByteSize(type, num_elements),
+                     " packed bytes for ", num_elements, " elements, got ",
+                     packed.size()));
+  }
+
+  // The client takes one byte per element and packs them itself
+  std::vector<int8_t> values(num_elements);
+  UnpackInt4(packed, type == S4, absl::MakeSpan(values));
+  return client->BufferFromHostBuffer(
+      values.data(), type, dims, /*byte_strides=*/std::nullopt,
+      PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall,
+      /*on_done_with_host_buffer=*/nullptr, memory_space,
+      /*device_layout=*/nullptr);
+}
+
+absl::StatusOr<std::vector<uint8_t>> PackedInt4FromBuffer(PjRtBuffer* buffer) {
+  TF_RETURN_IF_ERROR(CheckInt4Type(buffer->element_type()));
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<Literal> literal,
+                      buffer->ToLiteralSync());
+  const int64_t num_elements = ShapeUtil::ElementsIn(literal->shape());
+  std::vector<uint8_t> packed(
+      PackedByteSize(buffer->element_type(), num_elements));
+  PackInt4(absl::MakeConstSpan(
+               static_cast<const int8_t*>(literal->untyped_data()),
+               num_elements),
+           absl::MakeSpan(packed));
+  return packed;
+}
+
+XlaOp MixedPrecisionDot(XlaOp lhs, XlaOp rhs,
+                        PrimitiveType accumulation_type) {
+  XlaBuilder* builder = lhs.builder();
+  return builder->ReportErrorOrReturn([&]() -> absl::StatusOr<XlaOp> {
+    TF_ASSIGN_OR_RETURN(Shape lhs_shape, builder->GetShape(lhs));
+    TF_ASSIGN_OR_RETURN(Shape rhs_shape, builder->GetShape(rhs));
+    const PrimitiveType lhs_type = lhs_shape.element_type();
+    const PrimitiveType rhs_type = rhs_shape.element_type();
+    if (lhs_type != rhs_type ||
+        (primitive_util::IsFloatingPointType(accumulation_type) &&
+         !primitive_util::IsFloatingPointType(lhs_type))) {
+      lhs = ConvertElementType(lhs, accumulation_type);
+      rhs = ConvertElementType(rhs, accumulation_type);
+    }
+    return Dot(lhs, rhs, /*precision_config=*/nullptr, accumulation_type);
+  });
+}
+
+XlaOp DequantizedDot(XlaOp x, XlaOp weights, XlaOp scales) {
+  XlaBuilder* builder = x.builder();
+  return builder->ReportErrorOrReturn([&]() -> absl::StatusOr<XlaOp> {
+    TF_ASSIGN_OR_RETURN(Shape x_shape, builder->GetShape(x));
+    // Scales broadcast along the last dimension of the product
+    const int64_t column_dim = x_shape.dimensions_size() - 1;
+    return Mul(MixedPrecisionDot(x, weights, F32),
+               ConvertElementType(scales, F32), {column_dim});
+  });
+}
+
+}  // namespace extension
+}  // namespace xla
@@ -0,0 +1,70 @@
+#ifndef XLA_EXTENSION_LOW_PRECISION_H_
+#define XLA_EXTENSION_LOW_PRECISION_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/xla_data.pb.h"
+
+namespace xla {
+namespace extension {
+
+// Helpers for storing tensors in low-precision types on the CPU client:
+// BF16, F8E4M3FN and F8E5M2 floats, and S8, U8, S4 and U4 integers.
+// Computations over these types build, compile and execute like any
+// other, the CPU compiler upcasting the arithmetic where the hardware
+// has no native support. What they save is memory and bandwidth, which
+// pays off in memory-bound models.
+//
+// Sub-byte types take one byte per element in Literals and host buffers
+// passed to the client, and are packed on the device. The packed host
+// format below stores two int4 elements per byte, the element with the
+// even index in the low nibble.
+
+// Whether `type` is one of the types above.
+bool IsLowPrecisionType(PrimitiveType type);
+
+// Bytes taken by `num_elements` elements of `type` when packed, sub-byte
+// types rounding up to whole bytes.
+int64_t PackedByteSize(PrimitiveType type, int64_t num_elements);
+
+// Packs int4 values, one per byte in their low nibble, into `packed` of
+// (values.size() + 1) / 2 bytes.
+void PackInt4(absl::Span<const int8_t> values, absl::Span<uint8_t> packed);
+
+// Unpacks `values.size()` int4 values from `packed`, sign-extended when
+// `is_signed`.
+void UnpackInt4(absl::Span<const uint8_t> packed, bool is_signed,
+                absl::Span<int8_t> values);
+
+// Transfers packed S4 or U4 data of shape `dims` to `memory_space`. The
+// host data is not referenced after the call returns.
+absl::StatusOr<std::unique_ptr<PjRtBuffer>> BufferFromPackedInt4(
+    PjRtClient* client, PjRtMemorySpace* memory_space,
+    absl::Span<const uint8_t> packed, PrimitiveType type,
+    absl::Span<const int64_t> dims);
+
+// Reads an S4 or U4 buffer back in the packed host format.
+absl::StatusOr<std::vector<uint8_t>> PackedInt4FromBuffer(PjRtBuffer* buffer);
+
+// Dot(lhs, rhs) with the products accumulated and returned in
+// `accumulation_type`, typically F32 for float operands and S32 for
+// integer ones. Operands of different types, or integers accumulated in
+// a float type, are converted to `accumulation_type` first.
+XlaOp MixedPrecisionDot(XlaOp lhs, XlaOp rhs,
+                        PrimitiveType accumulation_type = F32);
+
+// Weight-only quantized matmul: Dot(x, weights) in F32 scaled by
+// `scales`, one per column of `weights` [k, n] stored in any of the
+// types above.
+XlaOp DequantizedDot(XlaOp x, XlaOp weights, XlaOp scales);
+
+}  // namespace extension
+}  // namespace xla
+
+#endif  // XLA_EXTENSION_LOW_PRECISION_H_
@@ -0,0 +1,191 @@
+#include "xla/extension/memory_report.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/service/hlo.pb.h"
+#include "xla/tsl/platform/statusor.h"
+
+namespace xla {
+namespace extension {
+
+namespace {
+
+LiveBuffer ToLiveBuffer(const LogicalBufferProto& buffer) {
+  LiveBuffer live;
+  live.instruction = buffer.defined_at().instruction_name();
+  live.shape_index =
+      absl::StrCat("{", absl::StrJoin(buffer.defined_at().shape_index(), ","),
+                   "}");
+  live.bytes = buffer.size();
+  return live;
+}
+
+// Replays a heap simulation and returns the ids of the buffers live at
+// its peak, with the peak size
+std::vector<int64_t> LiveAtPeak(
+    const HeapSimulatorTrace& trace,
+    const absl::flat_hash_map<int64_t, const LogicalBufferProto*>& buffers,
+    int64_t* peak) {
+  // Shared buffers live in the memory of another buffer
+  auto size = [&](const HeapSimulatorTrace::Event& event) -> int64_t {
+    if (event.kind() == HeapSimulatorTrace::Event::SHARE_WITH) return 0;
+    auto it = buffers.find(event.buffer_id());
+    return it == buffers.end() ? 0 : it->second->size();
+  };
+
+  // The first pass finds the peak, the second the buffers live there
+  absl::flat_hash_map<int64_t, int64_t> live;
+  int64_t current = 0;
+  int peak_event = -1;
+  *peak = 0;
+  for (int i = 0; i < trace.events_size(); i++) {
+    const auto& event = trace.events(i);
+    if (event.kind() == HeapSimulatorTrace::Event::FREE) {
+      auto it = live.find(event.buffer_id());
+      if (it != live.end()) {
+        current -= it->second;
+        live.erase(it);
+      }
+    } else {
+      live[event.buffer_id()] = size(event);
+      current += size(event);
+      if (current > *peak) {
+        *peak = current;
+        peak_event = i;
+      }
+    }
+  }
+
+  live.clear();
+  for (int i = 0; i <= peak_event; i++) {
+    const auto& event = trace.events(i);
+    if (event.kind() == HeapSimulatorTrace::Event::FREE) {
+      live.erase(event.buffer_id());
+    } else {
+      live[event.buffer_id()] = size(event);
+    }
+  }
+  std::vector<int64_t> ids;
+  for (const auto& [id, bytes] : live) {
+    if (bytes > 0) ids.push_back(id);
+  }
+  return ids;
+}
+
+}  // namespace
+
+absl::StatusOr<MemoryFootprint> MemoryFootprintFromStats(
+    const CompiledMemoryStats& stats, int max_buffers) {
+  MemoryFootprint footprint;
+  footprint.argument_bytes = stats.argument_size_in_bytes;
+  footprint.output_bytes = stats.output_size_in_bytes;
+  footprint.alias_bytes = stats.alias_size_in_bytes;
+  footprint.temp_bytes = stats.temp_size_in_bytes;
+  footprint.generated_code_bytes = stats.generated_code_size_in_bytes;
+  footprint.peak_bytes = stats.peak_memory_in_bytes;
+  if (stats.serialized_buffer_assignment.empty()) return footprint;
+
+  BufferAssignmentProto assignment;
+  if (!assignment.ParseFromString(stats.serialized_buffer_assignment)) {
+    return absl::InvalidArgumentError("cannot parse the buffer assignment");
+  }
+  absl::flat_hash_map<int64_t, const LogicalBufferProto*> buffers;
+  for (const LogicalBufferProto& buffer : assignment.logical_buffers()) {
+    buffers[buffer.id()] = &buffer;
+  }
+
+  std::vector<int64_t> ids;
+  int64_t largest_peak = -1;
+  for (const HeapSimulatorTrace& trace : assignment.heap_simulator_traces()) {
+    int64_t peak = 0;
+    std::vector<int64_t> live = LiveAtPeak(trace, buffers, &peak);
+    if (peak > largest_peak) {
+      largest_peak = peak;
+      ids = std::move(live);
+    }
+  }
+  if (assignment.heap_simulator_traces().empty()) {
+    for (const auto& [id, buffer] : buffers) ids.push_back(id);
+  }
+
+  for (int64_t id : ids) {
+    auto it = buffers.find(id);
+    if (it != buffers.end()) {
+      footprint.peak_buffers.push_back(ToLiveBuffer(*it->second));
+    }
+  }
+  std::sort(footprint.peak_buffers.begin(), footprint.peak_buffers.end(),
+            [](const LiveBuffer& a, const LiveBuffer& b) {
+              return a.bytes != b.bytes ? a.bytes > b.bytes
+                                        : a.instruction < b.instruction;
+            });
+  if (static_cast<int>(footprint.peak_buffers.size()) > max_buffers) {
+    footprint.peak_buffers.resize(std::max(max_buffers, 0));
+  }
+  return footprint;
+}
+
+absl::StatusOr<MemoryFootprint> GetMemoryFootprint(
+    const PjRtLoadedExecutable& executable, int max_buffers) {
+  TF_ASSIGN_OR_RETURN(CompiledMemoryStats stats,
+                      executable.GetCompiledMemoryStats());
+  return MemoryFootprintFromStats(stats, max_buffers);
+}
+
+std::string FormatMemoryFootprint(const MemoryFootprint& footprint) {
+  std::string report;
+  auto line = [&](const char* name, int64_t bytes) {
+    absl::StrAppendFormat(&report, "%-16s %14d bytes  %10.2f MiB\n", name,
+                          bytes, bytes / (1024.0 * 1024.0));
+  };
+  line("arguments", footprint.argument_bytes);
+  line("outputs", footprint.output_bytes);
+  line("aliased", footprint.alias_bytes);
+  line("temp", footprint.temp_bytes);
+  line("total", footprint.total_bytes());
+  line("peak", footprint.peak_bytes);
+  line("generated code", footprint.generated_code_bytes);
+  if (!footprint.peak_buffers.empty()) {
+    absl::StrAppend(&report, "largest live buffers at peak:\n");
+    for (const LiveBuffer& buffer : footprint.peak_buffers) {
+      const std::string index =
+          buffer.shape_index == "{}" ? "" : buffer.shape_index;
+      absl::StrAppendFormat(&report, "  %14d bytes  %s%s\n", buffer.bytes,
+                            buffer.instruction, index);
+    }
+  }
+  return report;
+}
+
+absl::Status CheckMemoryBudget(const MemoryFootprint& footprint,
+                               const MemoryBudget& budget) {
+  std::string exceeded;
+  if (budget.total_bytes >= 0 &&
+      footprint.total_bytes() > budget.total_bytes) {
+    exceeded = absl::StrCat("total ", footprint.total_bytes(), " > ",
+                            budget.total_bytes, " bytes");
+  } else if (budget.temp_bytes >= 0 &&
+             footprint.temp_bytes > budget.temp_bytes) {
+    exceeded = absl::StrCat("temp ", footprint.temp_bytes, " > ",
+                            budget.temp_bytes, " bytes");
+  } else {
+    return absl::OkStatus();
+  }
+  return absl::ResourceExhaustedError(
+      absl::StrCat("memory budget exceeded (", exceeded, ")\n",
+                   FormatMemoryFootprint(footprint)));
+}
+
+}  // namespace extension
+}  // namespace xla
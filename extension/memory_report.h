@@ -0,0 +1,75 @@
+#ifndef XLA_EXTENSION_MEMORY_REPORT_H_
+#define XLA_EXTENSION_MEMORY_REPORT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xla/pjrt/pjrt_executable.h"
+
+namespace xla {
+namespace extension {
+
+// A logical buffer of the buffer assignment, attributed to the HLO
+// instruction defining it.
+struct LiveBuffer {
+  std::string instruction;
+  // Position within a tuple-shaped instruction, "{}" for arrays
+  std::string shape_index;
+  int64_t bytes = 0;
+};
+
+// Device memory one execution of a compiled executable needs.
+struct MemoryFootprint {
+  int64_t argument_bytes = 0;
+  int64_t output_bytes = 0;
+  // Outputs living in donated argument buffers, counted in both above
+  int64_t alias_bytes = 0;
+  // Scratch space for intermediate values
+  int64_t temp_bytes = 0;
+  int64_t generated_code_bytes = 0;
+
+  // Peak of live buffers as reported by the compiler, 0 when unknown
+  int64_t peak_bytes = 0;
+
+  // Buffers live at the peak of the largest heap simulation of the
+  // buffer assignment, largest first. Without heap simulation traces,
+  // the largest buffers of the assignment.
+  std::vector<LiveBuffer> peak_buffers;
+
+  // Arguments, outputs and scratch space reserved by one execution.
+  int64_t total_bytes() const {
+    return argument_bytes + output_bytes - alias_bytes + temp_bytes;
+  }
+};
+
+// Breaks down the memory of `executable` from its buffer assignment,
+// keeping the `max_buffers` largest buffers live at the peak.
+absl::StatusOr<MemoryFootprint> GetMemoryFootprint(
+    const PjRtLoadedExecutable& executable, int max_buffers = 10);
+
+// Same from memory stats, whose serialized buffer assignment may be
+// empty.
+absl::StatusOr<MemoryFootprint> MemoryFootprintFromStats(
+    const CompiledMemoryStats& stats, int max_buffers = 10);
+
+// Multi-line human-readable report.
+std::string FormatMemoryFootprint(const MemoryFootprint& footprint);
+
+// Limits on the footprint, -1 leaves a limit unchecked.
+struct MemoryBudget {
+  int64_t total_bytes = -1;
+  int64_t temp_bytes = -1;
+};
+
+// ResourceExhausted with the report when the footprint exceeds the
+// budget, to fail tests at compile time rather than OOM at run time.
+absl::Status CheckMemoryBudget(const MemoryFootprint& footprint,
+                               const MemoryBudget& budget);
+
+}  // namespace extension
+}  // namespace xla
+
+#endif  // XLA_EXTENSION_MEMORY_REPORT_H_
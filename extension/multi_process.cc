@@ -0,0 +1,133 @@
+#include "xla/extension/multi_process.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/pjrt/distributed/client.h"
+#include "xla/pjrt/distributed/distributed.h"
+#include "xla/pjrt/distributed/key_value_store_interface.h"
+#include "xla/pjrt/distributed/service.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/service/computation_placer.h"
+#include "xla/tsl/platform/errors.h"
+#include "xla/tsl/platform/statusor.h"
+
+#if defined(__linux__)
+#include "gloo/transport/tcp/attr.h"
+#include "gloo/transport/tcp/device.h"
+#include "xla/backends/cpu/collectives/gloo_collectives.h"
+#include "xla/backends/cpu/collectives/gloo_kv_store.h"
+#endif
+
+namespace xla {
+namespace extension {
+
+namespace {
+
+// Keys of the client topology and the Gloo rendezvous share the store
+constexpr char kKeyPrefix[] = "cpu:";
+
+absl::StatusOr<std::shared_ptr<cpu::CpuCollectives>> MakeCollectives(
+    std::shared_ptr<KeyValueStoreInterface> kv_store,
+    const MultiProcessOptions& options) {
+#if defined(__linux__)
+  gloo::transport::tcp::attr attr;
+  if (!options.hostname.empty()) attr.hostname = options.hostname;
+  if (!options.interface.empty()) attr.iface = options.interface;
+  return std::make_shared<cpu::GlooCollectives>(
+      std::make_unique<cpu::GlooKeyValueStore>(std::move(kv_store)),
+      gloo::transport::tcp::CreateDevice(attr));
+#else
+  return absl::UnimplementedError(
+      "multi-process collectives are only supported on Linux");
+#endif
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<MultiProcessCpuClient>>
+MultiProcessCpuClient::Create(const MultiProcessOptions& options) {
+  if (options.num_processes < 1 || options.process_id < 0 ||
+      options.process_id >= options.num_processes) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("invalid process ", options.process_id, " of ",
+                     options.num_processes));
+  }
+  const auto port_separator = options.coordinator_address.rfind(':');
+  if (port_separator == std::string::npos) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "coordinator address must be host:port, got '",
+        options.coordinator_address, "'"));
+  }
+
+  auto result = absl::WrapUnique(new MultiProcessCpuClient());
+  result->options_ = options;
+
+  if (options.process_id == 0) {
+    CoordinationServiceImpl::Options service_options;
+    service_options.num_nodes = options.num_processes;
+    TF_ASSIGN_OR_RETURN(
+        result->service_,
+        GetDistributedRuntimeService(
+            absl::StrCat("[::]",
+                         options.coordinator_address.substr(port_separator)),
+            service_options));
+  }
+
+  DistributedRuntimeClient::Options client_options;
+  client_options.node_id = options.process_id;
+  client_options.init_timeout = options.init_timeout;
+  result->distributed_client_ =
+      GetDistributedRuntimeClient(options.coordinator_address, client_options);
+  TF_RETURN_IF_ERROR(result->distributed_client_->Connect());
+
+  std::shared_ptr<KeyValueStoreInterface> kv_store =
+      GetDistributedKeyValueStore(result->distributed_client_, kKeyPrefix);
+  CpuClientOptions cpu_options;
+  cpu_options.cpu_device_count = options.local_device_count;
+  cpu_options.process_id = options.process_id;
+  cpu_options.num_nodes = options.num_processes;
+  cpu_options.kv_store = kv_store;
+  if (options.num_processes > 1) {
+    TF_ASSIGN_OR_RETURN(cpu_options.collectives,
+                        MakeCollectives(kv_store, options));
+  }
+  TF_ASSIGN_OR_RETURN(result->client_,
+                      GetPjRtCpuClient(std::move(cpu_options)));
+  return result;
+}
+
+MultiProcessCpuClient::~MultiProcessCpuClient() {
+  client_.reset();
+  if (distributed_client_ != nullptr) {
+    // The shutdown barrier keeps the service alive until every process
+    // is done with it
+    distributed_client_->Shutdown().IgnoreError();
+  }
+  service_.reset();
+}
+
+absl::StatusOr<CompileOptions> MultiProcessCompileOptions(
+    PjRtClient* client, CompileOptions options) {
+  auto devices = client->devices();
+  const int num_replicas = devices.size();
+  DeviceAssignment device_assignment(num_replicas, /*computation_count=*/1);
+  for (int replica = 0; replica < num_replicas; replica++) {
+    device_assignment(replica, 0) = devices[replica]->id().value();
+  }
+
+  options.executable_build_options.set_num_replicas(num_replicas);
+  options.executable_build_options.set_num_partitions(1);
+  options.executable_build_options.set_device_assignment(device_assignment);
+  return options;
+}
+
+}  // namespace extension
+}  // namespace xla
@@ -0,0 +1,83 @@
+#ifndef XLA_EXTENSION_MULTI_PROCESS_H_
+#define XLA_EXTENSION_MULTI_PROCESS_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "xla/pjrt/distributed/client.h"
+#include "xla/pjrt/distributed/service.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+
+namespace xla {
+namespace extension {
+
+// One process of a group running a CPU client each, coordinated by the
+// distributed runtime service.
+struct MultiProcessOptions {
+  // host:port of the coordination service, which process 0 starts
+  std::string coordinator_address;
+  int num_processes = 1;
+  int process_id = 0;
+
+  // CPU devices of this process
+  int local_device_count = 1;
+
+  // How long processes wait for each other when connecting
+  absl::Duration init_timeout = absl::Minutes(1);
+
+  // Host name or network interface the collectives listen on, empty
+  // picks the interface of the host name
+  std::string hostname;
+  std::string interface;
+};
+
+// A CPU client whose devices form one topology with the devices of the
+// other processes of the group. Cross-process collectives (AllReduce,
+// AllGather, CollectivePermute) run over TCP with Gloo, the coordination
+// service only exchanges topologies and connection details.
+//
+// client()->devices() lists the devices of every process, ordered by
+// process, and addressable_devices() those of this one. Executables are
+// compiled by every process with the same options, see
+// MultiProcessCompileOptions, and each process executes them with the
+// arguments of its addressable devices.
+//
+// Linux only, elsewhere groups of more than one process are
+// Unimplemented.
+class MultiProcessCpuClient {
+ public:
+  // Connects to the group, blocking until every process has connected
+  // or `init_timeout` expires. Process 0 starts the coordination service
+  // first.
+  static absl::StatusOr<std::unique_ptr<MultiProcessCpuClient>> Create(
+      const MultiProcessOptions& options);
+
+  // Destroys the client and disconnects, which waits for the other
+  // processes to disconnect as well.
+  ~MultiProcessCpuClient();
+
+  PjRtClient* client() const { return client_.get(); }
+  int process_id() const { return options_.process_id; }
+  int num_processes() const { return options_.num_processes; }
+
+ private:
+  MultiProcessCpuClient() = default;
+
+  MultiProcessOptions options_;
+  std::unique_ptr<DistributedRuntimeService> service_;
+  std::shared_ptr<DistributedRuntimeClient> distributed_client_;
+  std::unique_ptr<PjRtClient> client_;
+};
+
+// Returns `options` configured with one replica per device of the whole
+// group, replica i on the i-th device of client->devices().
+absl::StatusOr<CompileOptions> MultiProcessCompileOptions(
+    PjRtClient* client, CompileOptions options = CompileOptions());
+
+}  // namespace extension
+}  // namespace xla
+
+#endif  // XLA_EXTENSION_MULTI_PROCESS_H_
@@ -0,0 +1,277 @@
+#include "xla/extension/multi_step.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "xla/extension/state_loop.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/tsl/platform/errors.h"
+#include "xla/tsl/platform/statusor.h"
+
+namespace xla {
+namespace extension {
+
+namespace {
+
+// Writes the step outputs into slot `slot` of the rings:
+// (rings..., outputs..., slot) -> (rings...)
+absl::StatusOr<XlaComputation> BuildRecord(const Shape& operand_shape,
+                                           absl::Span<const Shape> outputs) {
+  XlaBuilder builder("multi_step_record");
+  const int64_t num_outputs = outputs.size();
+  XlaOp operand = Parameter(&builder, 0, operand_shape, "operand");
+  XlaOp slot = GetTupleElement(operand, 2 * num_outputs);
+  XlaOp zero = ConstantR0<int64_t>(&builder, 0);
+
+  std::vector<XlaOp> rings;
+  for (int64_t k = 0; k < num_outputs; k++) {
+    std::vector<int64_t> dims = {1};
+    dims.insert(dims.end(), outputs[k].dimensions().begin(),
+                outputs[k].dimensions().end());
+    std::vector<XlaOp> starts(dims.size(), zero);
+    starts[0] = slot;
+    rings.push_back(DynamicUpdateSlice(
+        GetTupleElement(operand, k),
+        Reshape(GetTupleElement(operand, num_outputs + k), dims), starts));
+  }
+  Tuple(&builder, rings);
+  return builder.Build();
+}
+
+// Leaves the rings untouched: (rings..., outputs..., slot) -> (rings...)
+absl::StatusOr<XlaComputation> BuildSkip(const Shape& operand_shape,
+                                         int64_t num_outputs) {
+  XlaBuilder builder("multi_step_skip");
+  XlaOp operand = Parameter(&builder, 0, operand_shape, "operand");
+  std::vector<XlaOp> rings;
+  for (int64_t k = 0; k < num_outputs; k++) {
+    rings.push_back(GetTupleElement(operand, k));
+  }
+  Tuple(&builder, rings);
+  return builder.Build();
+}
+
+}  // namespace
+
+absl::StatusOr<MultiStepComputation> BuildMultiStep(
+    const XlaComputation& step, int64_t num_state,
+    const MultiStepOptions& options) {
+  const int64_t record_every =
+      options.record_every == 0 ? options.steps : options.record_every;
+  if (options.steps < 1 || record_every < 1 || options.ring_size < 1) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "invalid multi-step options: steps=", options.steps,
+        " record_every=", options.record_every,
+        " ring_size=", options.ring_size));
+  }
+
+  TF_ASSIGN_OR_RETURN(ProgramShape step_shape, step.GetProgramShape());
+  const Shape& result = step_shape.result();
+  if (num_state > step_shape.parameters_size() || !result.IsTuple() ||
+      ShapeUtil::TupleElementCount(result) < num_state) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "the step must take ", num_state, " state parameters and return a ",
+        "tuple (new state..., outputs...), got ",
+        ShapeUtil::HumanString(step_shape)));
+  }
+  std::vector<Shape> state_shapes, input_shapes, outputs;
+  for (int64_t i = 0; i < step_shape.parameters_size(); i++) {
+    (i < num_state ? state_shapes : input_shapes)
+        .push_back(step_shape.parameters(i));
+  }
+  for (int64_t i = 0; i < ShapeUtil::TupleElementCount(result); i++) {
+    const Shape& shape = result.tuple_shapes(i);
+    if (i < num_state && !ShapeUtil::Compatible(shape, state_shapes[i])) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "state ", i, " is ", ShapeUtil::HumanString(state_shapes[i]),
+          " but the step returns ", ShapeUtil::HumanString(shape)));
+    }
+    if (i >= num_state) {
+      if (!shape.IsArray()) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("output ", i - num_state, " is not an array"));
+      }
+      outputs.push_back(shape);
+    }
+  }
+  const int64_t num_outputs = outputs.size();
+
+  MultiStepComputation multi_step;
+  multi_step.num_state = num_state;
+  for (const Shape& output : outputs) {
+    std::vector<int64_t> dims = {options.ring_size};
+    dims.insert(dims.end(), output.dimensions().begin(),
+                output.dimensions().end());
+    multi_step.ring_shapes.push_back(
+        ShapeUtil::MakeShape(output.element_type(), dims));
+  }
+
+  // Loop carry: (i, step counter, state..., rings..., inputs...)
+  const Shape counter_shape = ShapeUtil::MakeShape(S64, {});
+  std::vector<Shape> carry_shapes = {counter_shape, counter_shape};
+  carry_shapes.insert(carry_shapes.end(), state_shapes.begin(),
+                      state_shapes.end());
+  carry_shapes.insert(carry_shapes.end(), multi_step.ring_shapes.begin(),
+                      multi_step.ring_shapes.end());
+  carry_shapes.insert(carry_shapes.end(), input_shapes.begin(),
+                      input_shapes.end());
+  const Shape carry_shape = ShapeUtil::MakeTupleShape(carry_shapes);
+  const int64_t rings_begin = 2 + num_state;
+  const int64_t inputs_begin = rings_begin + num_outputs;
+
+  std::vector<Shape> record_shapes = multi_step.ring_shapes;
+  record_shapes.insert(record_shapes.end(), outputs.begin(), outputs.end());
+  record_shapes.push_back(counter_shape);
+  const Shape record_shape = ShapeUtil::MakeTupleShape(record_shapes);
+  TF_ASSIGN_OR_RETURN(XlaComputation record, BuildRecord(record_shape, outputs));
+  TF_ASSIGN_OR_RETURN(XlaComputation skip, BuildSkip(record_shape, num_outputs));
+
+  XlaComputation body;
+  {
+    XlaBuilder builder("multi_step_body");
+    XlaOp carry = Parameter(&builder, 0, carry_shape, "carry");
+    XlaOp one = ConstantR0<int64_t>(&builder, 1);
+
+    std::vector<XlaOp> arguments;
+    for (int64_t i = 0; i < num_state; i++) {
+      arguments.push_back(GetTupleElement(carry, 2 + i));
+    }
+    for (int64_t i = 0; i < static_cast<int64_t>(input_shapes.size()); i++) {
+      arguments.push_back(GetTupleElement(carry, inputs_begin + i));
+    }
+    XlaOp stepped = Call(&builder, step, arguments);
+
+    XlaOp done = Add(GetTupleElement(carry, 1), one);
+    std::vector<XlaOp> next = {Add(GetTupleElement(carry, 0), one), done};
+    for (int64_t i = 0; i < num_state; i++) {
+      next.push_back(GetTupleElement(stepped, i));
+    }
+    if (num_outputs > 0) {
+      XlaOp every = ConstantR0<int64_t>(&builder, record_every);
+      XlaOp recording = Eq(Rem(done, every), ConstantR0<int64_t>(&builder, 0));
+      XlaOp slot = Rem(Sub(Div(done, every), one),
+                       ConstantR0<int64_t>(&builder, options.ring_size));
+      std::vector<XlaOp> operand;
+      for (int64_t k = 0; k < num_outputs; k++) {
+        operand.push_back(GetTupleElement(carry, rings_begin + k));
+      }
+      for (int64_t k = 0; k < num_outputs; k++) {
+        operand.push_back(GetTupleElement(stepped, num_state + k));
+      }
+      operand.push_back(slot);
+      XlaOp record_operand = Tuple(&builder, operand);
+      XlaOp rings = Conditional(recording, record_operand, record,
+                                record_operand, skip);
+      for (int64_t k = 0; k < num_outputs; k++) {
+        next.push_back(GetTupleElement(rings, k));
+      }
+    }
+    for (int64_t i = 0; i < static_cast<int64_t>(input_shapes.size()); i++) {
+      next.push_back(GetTupleElement(carry, inputs_begin + i));
+    }
+    Tuple(&builder, next);
+    TF_ASSIGN_OR_RETURN(body, builder.Build());
+  }
+
+  XlaComputation condition;
+  {
+    XlaBuilder builder("multi_step_condition");
+    XlaOp carry = Parameter(&builder, 0, carry_shape, "carry");
+    Lt(GetTupleElement(carry, 0), ConstantR0<int64_t>(&builder, options.steps));
+    TF_ASSIGN_OR_RETURN(condition, builder.Build());
+  }
+
+  XlaBuilder builder("multi_step");
+  int64_t parameter = 0;
+  std::vector<XlaOp> init = {ConstantR0<int64_t>(&builder, 0)};
+  std::vector<XlaOp> state, rings, inputs;
+  for (int64_t i = 0; i < num_state; i++) {
+    state.push_back(Parameter(&builder, parameter++, state_shapes[i],
+                              absl::StrCat("state_", i)));
+  }
+  for (int64_t k = 0; k < num_outputs; k++) {
+    rings.push_back(Parameter(&builder, parameter++,
+                              multi_step.ring_shapes[k],
+                              absl::StrCat("ring_", k)));
+  }
+  init.push_back(Parameter(&builder, parameter++, counter_shape, "counter"));
+  for (int64_t i = 0; i < static_cast<int64_t>(input_shapes.size()); i++) {
+    inputs.push_back(Parameter(&builder, parameter++, input_shapes[i],
+                               absl::StrCat("input_", i)));
+  }
+  init.insert(init.end(), state.begin(), state.end());
+  init.insert(init.end(), rings.begin(), rings.end());
+  init.insert(init.end(), inputs.begin(), inputs.end());
+  XlaOp loop = While(condition, body, Tuple(&builder, init));
+
+  std::vector<XlaOp> results;
+  for (int64_t i = 2; i < inputs_begin; i++) {
+    results.push_back(GetTupleElement(loop, i));
+  }
+  results.push_back(GetTupleElement(loop, 1));
+  Tuple(&builder, results);
+  AliasStateToOutputs(&builder, num_state + num_outputs + 1);
+  TF_ASSIGN_OR_RETURN(multi_step.computation, builder.Build());
+  return multi_step;
+}
+
+absl::StatusOr<std::unique_ptr<MultiStepRunner>> MultiStepRunner::Create(
+    PjRtClient* client, const XlaComputation& step,
+    std::vector<std::unique_ptr<PjRtBuffer>> initial_state,
+    const MultiStepOptions& options, const CompileOptions& compile_options) {
+  TF_ASSIGN_OR_RETURN(
+      MultiStepComputation multi_step,
+      BuildMultiStep(step, initial_state.size(), options));
+
+  auto runner = absl::WrapUnique(new MultiStepRunner());
+  runner->options_ = options;
+  runner->record_every_ =
+      options.record_every == 0 ? options.steps : options.record_every;
+  runner->num_state_ = multi_step.num_state;
+  runner->num_rings_ = multi_step.ring_shapes.size();
+  TF_ASSIGN_OR_RETURN(
+      runner->executable_,
+      client->CompileAndLoad(multi_step.computation, compile_options));
+
+  TF_ASSIGN_OR_RETURN(PjRtMemorySpace * memory_space,
+                      client->addressable_devices()[0]->default_memory_space());
+  std::vector<std::unique_ptr<PjRtBuffer>> state = std::move(initial_state);
+  std::vector<Literal> literals;
+  for (const Shape& shape : multi_step.ring_shapes) {
+    literals.push_back(Literal::CreateFromShape(shape));
+  }
+  literals.push_back(LiteralUtil::CreateR0<int64_t>(0));
+  for (const Literal& literal : literals) {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<PjRtBuffer> buffer,
+                        client->BufferFromHostLiteral(literal, memory_space));
+    // The literals must outlive asynchronous transfers
+    TF_RETURN_IF_ERROR(buffer->GetReadyFuture().Await());
+    state.push_back(std::move(buffer));
+  }
+
+  TF_ASSIGN_OR_RETURN(runner->loop_,
+                      StateLoop::Create(runner->executable_.get(),
+                                        std::move(state)));
+  return runner;
+}
+
+absl::Status MultiStepRunner::Run(absl::Span<PjRtBuffer* const> inputs) {
+  return loop_->Step(inputs).status();
+}
+
+}  // namespace extension
+}  // namespace xla
@@ -0,0 +1,102 @@
+#ifndef XLA_EXTENSION_MULTI_STEP_H_
+#define XLA_EXTENSION_MULTI_STEP_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xla/extension/state_loop.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/shape.h"
+
+namespace xla {
+namespace extension {
+
+struct MultiStepOptions {
+  // Steps fused into one execution
+  int64_t steps = 1;
+
+  // The non-state outputs of every `record_every`-th step are written to
+  // a ring of `ring_size` slots per output. 0 records the last step of
+  // every execution only.
+  int64_t record_every = 0;
+  int64_t ring_size = 1;
+};
+
+// A fused multi-step computation and the shapes of its ring buffers.
+struct MultiStepComputation {
+  // (state..., rings..., step counter, inputs...) ->
+  // (state..., rings..., step counter), all aliased in place
+  XlaComputation computation;
+  int64_t num_state = 0;
+  // [ring_size, ...output dims] per non-state output of the step
+  std::vector<Shape> ring_shapes;
+};
+
+// Fuses `options.steps` applications of `step` into a While loop.
+//
+// `step` maps (state..., inputs...) to a tuple (new state...,
+// outputs...), where the first `num_state` parameters are the state
+// carried from step to step and the inputs stay the same for every
+// step of an execution. Outputs must be arrays. The step counter (S64)
+// counts steps across executions, record r (counting from 1) goes to
+// ring slot (r - 1) % ring_size.
+absl::StatusOr<MultiStepComputation> BuildMultiStep(
+    const XlaComputation& step, int64_t num_state,
+    const MultiStepOptions& options);
+
+// Runs a step function K steps per Execute, which amortizes the fixed
+// cost of a dispatch (argument handling, futures, result buffers) over
+// K steps. State, rings and step counter stay on the device and are
+// donated to every execution, see StateLoop.
+class MultiStepRunner {
+ public:
+  // Compiles the fused computation and takes ownership of the initial
+  // state. The rings start zeroed.
+  static absl::StatusOr<std::unique_ptr<MultiStepRunner>> Create(
+      PjRtClient* client, const XlaComputation& step,
+      std::vector<std::unique_ptr<PjRtBuffer>> initial_state,
+      const MultiStepOptions& options,
+      const CompileOptions& compile_options = CompileOptions());
+
+  // Enqueues `options.steps` steps as a single execution.
+  absl::Status Run(absl::Span<PjRtBuffer* const> inputs = {});
+
+  // State after the last Run, valid until the next one.
+  absl::Span<const std::unique_ptr<PjRtBuffer>> state() const {
+    return loop_->state().subspan(0, num_state_);
+  }
+
+  // Ring buffer of each non-state output, valid until the next Run.
+  absl::Span<const std::unique_ptr<PjRtBuffer>> rings() const {
+    return loop_->state().subspan(num_state_, num_rings_);
+  }
+
+  // Steps taken so far, which locates the newest record.
+  int64_t steps() const { return loop_->steps() * options_.steps; }
+
+  // Records written so far, the newest is in slot (records - 1) % ring_size.
+  int64_t records() const { return steps() / record_every_; }
+
+  PjRtLoadedExecutable* executable() const { return executable_.get(); }
+
+ private:
+  MultiStepRunner() = default;
+
+  MultiStepOptions options_;
+  int64_t record_every_ = 1;
+  int64_t num_state_ = 0;
+  int64_t num_rings_ = 0;
+  std::unique_ptr<PjRtLoadedExecutable> executable_;
+  std::unique_ptr<StateLoop> loop_;
+};
+
+}  // namespace extension
+}  // namespace xla
+
+#endif  // XLA_EXTENSION_MULTI_STEP_H_
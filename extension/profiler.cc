@@ -0,0 +1,105 @@
+#include "xla/extension/profiler.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/base/call_once.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xla/backends/profiler/cpu/host_tracer.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/tsl/platform/env.h"
+#include "xla/tsl/platform/errors.h"
+#include "xla/tsl/platform/statusor.h"
+#include "xla/tsl/profiler/convert/trace_container.h"
+#include "xla/tsl/profiler/convert/trace_events_to_json.h"
+#include "xla/tsl/profiler/convert/xplane_to_trace_events.h"
+#include "tsl/profiler/lib/profiler_factory.h"
+#include "tsl/profiler/lib/profiler_interface.h"
+#include "tsl/profiler/lib/profiler_session.h"
+#include "tsl/profiler/protobuf/profiler_options.pb.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+
+namespace xla {
+namespace extension {
+
+namespace {
+
+std::unique_ptr<tsl::profiler::ProfilerInterface> CreateHostTracer(
+    const tensorflow::ProfileOptions& profile_options) {
+  if (profile_options.host_tracer_level() == 0) return nullptr;
+  profiler::HostTracerOptions options;
+  options.trace_level = profile_options.host_tracer_level();
+  return profiler::CreateHostTracer(options);
+}
+
+// XLA registers the host tracer from a static initializer, which a
+// consumer of the merged archive does not link since nothing references
+// it, so the factory is registered here instead
+void RegisterHostTracer() {
+  static absl::once_flag once;
+  absl::call_once(once, [] {
+    tsl::profiler::RegisterProfilerFactory(&CreateHostTracer);
+  });
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<ProfilerSession>> ProfilerSession::Start(
+    ProfilerOptions options) {
+  RegisterHostTracer();
+  tensorflow::ProfileOptions profile_options =
+      tsl::ProfilerSession::DefaultOptions();
+  profile_options.set_host_tracer_level(options.host_tracer_level);
+  // Only the host tracer is linked, there is no device or Python tracer
+  profile_options.set_device_tracer_level(0);
+  profile_options.set_python_tracer_level(0);
+
+  std::unique_ptr<tsl::ProfilerSession> session =
+      tsl::ProfilerSession::Create(profile_options);
+  // Fails if another session is active
+  TF_RETURN_IF_ERROR(session->Status());
+  return std::unique_ptr<ProfilerSession>(
+      new ProfilerSession(std::move(session)));
+}
+
+ProfilerSession::ProfilerSession(std::unique_ptr<tsl::ProfilerSession> session)
+    : session_(std::move(session)) {}
+
+absl::StatusOr<tensorflow::profiler::XSpace> ProfilerSession::Stop() {
+  if (session_ == nullptr) {
+    return absl::FailedPreconditionError("profiler session already stopped");
+  }
+  tensorflow::profiler::XSpace space;
+  absl::Status status = session_->CollectData(&space);
+  // Releases the profiler lock, so that a new session can start
+  session_.reset();
+  TF_RETURN_IF_ERROR(status);
+  return space;
+}
+
+absl::Status ProfilerSession::StopAndWriteChromeTrace(const std::string& path) {
+  TF_ASSIGN_OR_RETURN(tensorflow::profiler::XSpace space, Stop());
+  return WriteChromeTrace(space, path);
+}
+
+std::string XSpaceToChromeTraceJson(const tensorflow::profiler::XSpace& space) {
+  tsl::profiler::TraceContainer container =
+      tsl::profiler::ConvertXSpaceToTraceContainer(space);
+  return tsl::profiler::TraceContainerToJson(container);
+}
+
+absl::Status WriteChromeTrace(const tensorflow::profiler::XSpace& space,
+                              const std::string& path) {
+  return tsl::WriteStringToFile(tsl::Env::Default(), path,
+                                XSpaceToChromeTraceJson(space));
+}
+
+void EnableHloOpTracing(CompileOptions& options) {
+  options.executable_build_options.mutable_debug_options()
+      ->set_xla_cpu_enable_xprof_traceme(true);
+}
+
+}  // namespace extension
+}  // namespace xla
@@ -0,0 +1,66 @@
+#ifndef XLA_EXTENSION_PROFILER_H_
+#define XLA_EXTENSION_PROFILER_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "tsl/profiler/lib/profiler_session.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+
+namespace xla {
+namespace extension {
+
+struct ProfilerOptions {
+  // TraceMe verbosity captured on the host: 1 keeps user annotations and
+  // the PjRt client events, 2 adds the thunks executed for every HLO op
+  // on the CPU backend, 3 is everything.
+  int host_tracer_level = 2;
+};
+
+// In-process profiling session capturing host TraceMe events of all
+// threads, including the CPU client's thunk executor. Only one session
+// can be active in a process at a time.
+//
+//   auto session = ProfilerSession::Start();
+//   ... Execute ...
+//   TF_RETURN_IF_ERROR((*session)->StopAndWriteChromeTrace("step.json"));
+//
+// The trace opens in https://ui.perfetto.dev or chrome://tracing.
+class ProfilerSession {
+ public:
+  static absl::StatusOr<std::unique_ptr<ProfilerSession>> Start(
+      ProfilerOptions options = {});
+
+  ProfilerSession(const ProfilerSession&) = delete;
+  ProfilerSession& operator=(const ProfilerSession&) = delete;
+
+  // Stops the session and returns the captured events. The session can
+  // only be stopped once.
+  absl::StatusOr<tensorflow::profiler::XSpace> Stop();
+
+  // Stops the session and writes the events as Chrome trace JSON.
+  absl::Status StopAndWriteChromeTrace(const std::string& path);
+
+ private:
+  explicit ProfilerSession(std::unique_ptr<tsl::ProfilerSession> session);
+
+  std::unique_ptr<tsl::ProfilerSession> session_;
+};
+
+// Converts captured events to Chrome trace JSON.
+std::string XSpaceToChromeTraceJson(const tensorflow::profiler::XSpace& space);
+
+absl::Status WriteChromeTrace(const tensorflow::profiler::XSpace& space,
+                              const std::string& path);
+
+// Names thunk events of executables compiled with these options after
+// the HLO op they run, rather than only the thunk kind.
+void EnableHloOpTracing(CompileOptions& options);
+
+}  // namespace extension
+}  // namespace xla
+
+#endif  // XLA_EXTENSION_PROFILER_H_
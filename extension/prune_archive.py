@@ -0,0 +1,226 @@
+"""Merges static libraries into one archive, keeping only reachable objects.
+
+An object is kept when it defines a symbol matching one of the root
+patterns, when it runs code at load time (registrations of platforms,
+custom calls, allocators and the like have no other references), or when
+it defines a symbol referenced by another kept object. Everything else is
+left out of the output archive. Load-time code is found from the
+initializer sections rather than from symbol names, which also covers
+__attribute__((constructor)) functions.
+
+Root patterns are regular expressions matched against demangled symbol
+names, one per line in the roots file. Only ELF toolchains are supported.
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+# Symbol types (nm -P) of undefined references
+UNDEFINED_TYPES = frozenset("Uwv")
+# Symbol types of weak definitions, which yield to strong ones
+WEAK_TYPES = frozenset("WV")
+# Lowercase symbol types of global definitions: GNU unique objects and
+# indirect functions
+GLOBAL_LOWERCASE_TYPES = frozenset("ui")
+# Sections of function pointers run at load time, possibly suffixed with
+# a priority (.init_array.00101)
+INITIALIZER_SECTIONS = (".init_array", ".ctors", ".preinit_array")
+# Objects are passed to nm in batches to stay below the argument limit
+NM_BATCH_SIZE = 512
+
+
+def extract_members(ar, lib, index, work_dir):
+  """Extracts every member of `lib`, including duplicate names."""
+  names = subprocess.run([ar, "t", lib], check=True, capture_output=True,
+                         text=True).stdout.split()
+  lib_dir = os.path.join(work_dir, str(index))
+  os.makedirs(lib_dir)
+
+  # Extracting everything at once is much faster, but only yields the
+  # last of several members with the same name, so those are extracted
+  # one by one
+  subprocess.run([ar, "x", os.path.abspath(lib)], check=True, cwd=lib_dir)
+  totals = {}
+  for name in names:
+    totals[name] = totals.get(name, 0) + 1
+
+  seen = {}
+  objects = []
+  for name in names:
+    count = seen[name] = seen.get(name, 0) + 1
+    if totals[name] > 1:
+      subprocess.run([ar, "xN", str(count), os.path.abspath(lib), name],
+                     check=True, cwd=lib_dir)
+    unique = os.path.join(lib_dir, "{}_{}".format(count, name))
+    os.rename(os.path.join(lib_dir, name), unique)
+    objects.append(unique)
+  return objects
+
+
+def is_initializer_section(name):
+  return any(name == section or name.startswith(section + ".")
+             for section in INITIALIZER_SECTIONS)
+
+
+def read_initializers(readelf, objects):
+  """Returns the objects with a non-empty initializer section."""
+  initializers = set()
+  for start in range(0, len(objects), NM_BATCH_SIZE):
+    batch = objects[start:start + NM_BATCH_SIZE]
+    output = subprocess.run([readelf, "-S", "-W", *batch], check=True,
+                            capture_output=True, text=True).stdout
+    # Only prints the file names when given several files
+    path = batch[0]
+    for line in output.splitlines():
+      if line.startswith("File: "):
+        path = line[len("File: "):].strip()
+        continue
+      # "  [ 5] .init_array INIT_ARRAY 0000000000000000 000050 000008 ..."
+      _, bracket, rest = line.partition("]")
+      fields = rest.split()
+      if not bracket or len(fields) < 5:
+        continue
+      if is_initializer_section(fields[0]) and int(fields[4], 16) > 0:
+        initializers.add(path)
+  return initializers
+
+
+def read_symbols(nm, objects):
+  """Returns {object: (defined, undefined)} and the weak definitions."""
+  symbols = {obj: (set(), set()) for obj in objects}
+  weak = {obj: set() for obj in objects}
+  for start in range(0, len(objects), NM_BATCH_SIZE):
+    batch = objects[start:start + NM_BATCH_SIZE]
+    output = subprocess.run([nm, "-A", "-P", *batch], check=True,
+                            capture_output=True, text=True).stdout
+    for line in output.splitlines():
+      path, _, rest = line.partition(": ")
+      fields = rest.split()
+      if path not in symbols or len(fields) < 2:
+        continue
+      name, kind = fields[0], fields[1]
+      defined, undefined = symbols[path]
+      if kind in UNDEFINED_TYPES:
+        undefined.add(name)
+      elif kind.isupper() or kind in GLOBAL_LOWERCASE_TYPES:
+        defined.add(name)
+        if kind in WEAK_TYPES:
+          weak[path].add(name)
+  return symbols, weak
+
+
+def demangle(cxxfilt, names):
+  output = subprocess.run([cxxfilt], input="\n".join(names), check=True,
+                          capture_output=True, text=True).stdout
+  return output.splitlines()
+
+
+def sibling_tool(nm, tool, llvm_tool):
+  """Path of `tool` from the same toolchain as `nm`.
+
+  llvm-nm -> llvm-cxxfilt, x86_64-linux-gnu-nm -> x86_64-linux-gnu-c++filt
+  """
+  directory, name = os.path.split(nm)
+  if name.startswith("llvm-"):
+    return os.path.join(directory, llvm_tool)
+  prefix = name[:-len("nm")] if name.endswith("nm") else ""
+  return os.path.join(directory, prefix + tool)
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__)
+  parser.add_argument("--ar", default="ar")
+  parser.add_argument("--nm", default="nm")
+  parser.add_argument("--cxxfilt",
+                      help="defaults to c++filt next to --nm")
+  parser.add_argument("--readelf",
+                      help="defaults to readelf next to --nm")
+  parser.add_argument("--roots", required=True,
+                      help="file with one root symbol pattern per line")
+  parser.add_argument("--output", required=True)
+  parser.add_argument("--stats", required=True,
+                      help="JSON file with member counts and sizes")
+  parser.add_argument("libs", nargs="+")
+  args = parser.parse_args()
+  cxxfilt = args.cxxfilt or sibling_tool(args.nm, "c++filt", "llvm-cxxfilt")
+  readelf = args.readelf or sibling_tool(args.nm, "readelf", "llvm-readelf")
+
+  with open(args.roots) as f:
+    patterns = [re.compile(line.strip()) for line in f if line.strip()]
+
+  work_dir = tempfile.mkdtemp()
+  try:
+    objects = []
+    for index, lib in enumerate(args.libs):
+      objects.extend(extract_members(args.ar, lib, index, work_dir))
+
+    symbols, weak = read_symbols(args.nm, objects)
+    initializers = read_initializers(readelf, objects)
+
+    # The first strong definition wins, like it does for the linker
+    # scanning the merged archive
+    definitions = {}
+    for obj in objects:
+      for name in symbols[obj][0] - weak[obj]:
+        definitions.setdefault(name, obj)
+    for obj in objects:
+      for name in weak[obj]:
+        definitions.setdefault(name, obj)
+
+    names = sorted(definitions)
+    roots = set()
+    for name, demangled in zip(names, demangle(cxxfilt, names)):
+      if any(pattern.search(demangled) for pattern in patterns):
+        roots.add(definitions[name])
+    root_count = len(roots)
+    roots.update(initializers)
+
+    reachable = set()
+    pending = list(roots)
+    while pending:
+      obj = pending.pop()
+      if obj in reachable:
+        continue
+      reachable.add(obj)
+      for name in symbols[obj][1]:
+        provider = definitions.get(name)
+        if provider is not None and provider not in reachable:
+          pending.append(provider)
+
+    kept = [obj for obj in objects if obj in reachable]
+    if os.path.exists(args.output):
+      os.remove(args.output)
+    # Members are renamed on extraction, so appending never replaces an
+    # object with the same name from another library
+    for start in range(0, len(kept), NM_BATCH_SIZE):
+      subprocess.run([args.ar, "qc", args.output,
+                      *kept[start:start + NM_BATCH_SIZE]], check=True)
+    subprocess.run([args.ar, "s", args.output], check=True)
+
+    stats = {
+        "members_before": len(objects),
+        "members_after": len(kept),
+        "object_bytes_before": sum(os.path.getsize(o) for o in objects),
+        "object_bytes_after": sum(os.path.getsize(o) for o in kept),
+        "archive_bytes_after": os.path.getsize(args.output),
+        "root_members": root_count,
+        "static_initializer_members": len(initializers),
+        "root_patterns": [pattern.pattern for pattern in patterns],
+    }
+    with open(args.stats, "w") as f:
+      json.dump(stats, f, indent=2)
+      f.write("\n")
+  finally:
+    shutil.rmtree(work_dir)
+
+  return 0
+
+
+if __name__ == "__main__":
+  sys.exit(main())
@@ -0,0 +1,47 @@
+#!/usr/bin/env bash
+#
+# Prints the headers reachable through #include from the given root
+# headers of the SRC include tree, one path relative to SRC per line.
+# Includes are resolved against the include root first and then against
+# the directory of the including header. Includes that do not resolve in
+# SRC, such as system headers, are skipped.
+#
+# Usage: prune_headers.sh SRC ROOT...
+
+set -euo pipefail
+
+src="$1"
+shift 1
+
+# Marker files of the visited headers, since bash 3 (macOS) has no
+# associative arrays
+visited="$(mktemp -d)"
+trap 'rm -rf "$visited"' EXIT
+
+queue=("$@")
+
+while [ ${#queue[@]} -gt 0 ]; do
+  header="${queue[${#queue[@]}-1]}"
+  unset "queue[${#queue[@]}-1]"
+
+  if [ -f "$visited/$header" ]; then
+    continue
+  fi
+  mkdir -p "$visited/$(dirname "$header")"
+  : > "$visited/$header"
+  echo "$header"
+
+  header_dir="$(dirname "$header")"
+  includes=$(grep -E -o '^[[:space:]]*#[[:space:]]*(include|include_next|import)[[:space:]]*[<"][^>"]+[>"]' "$src/$header" \
+    | sed -E 's/.*[<"]([^>"]+)[>"]$/\1/' || true)
+
+  for include in $includes; do
+    if [ -f "$src/$include" ]; then
+      queue+=("$include")
+    elif [ -f "$src/$header_dir/$include" ]; then
+      # Normalize ../ components of relative includes
+      resolved="$(cd "$src/$(dirname "$header_dir/$include")" && pwd -P)/$(basename "$include")"
+      queue+=("${resolved#"$(cd "$src" && pwd -P)/"}")
+    fi
+  done
+done
@@ -0,0 +1,452 @@
+#include "xla/extension/spatial_kernel_handlers.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "absl/base/call_once.h"
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "xla/ffi/api/ffi.h"
+#include "xla/ffi/ffi_api.h"
+
+// Every kernel entry point is compiled once per instruction set and
+// resolved at load time (through an ifunc, hence Linux only). The
+// kernel bodies are force-inlined into the entry points, so they are
+// compiled for each instruction set as well
+#if defined(__x86_64__) && defined(__linux__)
+#define XLA_EXTENSION_KERNEL_CLONES \
+  __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define XLA_EXTENSION_KERNEL_CLONES
+#endif
+
+#define XLA_EXTENSION_KERNEL_INLINE inline __attribute__((always_inline))
+
+namespace xla {
+namespace extension {
+
+namespace {
+
+namespace ffi = ::xla::ffi;
+
+// Items processed together. Within a block every element is stored
+// lane-wise ([element][item]), so the arithmetic runs on 16 items at a
+// time, one AVX-512 register of floats
+constexpr int64_t kLanes = 16;
+
+// Gathers `items` consecutive items of K elements into lanes, zeroing
+// the lanes past the end of the batch
+template <typename T, int K>
+XLA_EXTENSION_KERNEL_INLINE void LoadLanes(const T* src, int64_t items,
+                                           T (&dst)[K][kLanes]) {
+  if (items == kLanes) {
+    for (int e = 0; e < K; e++) {
+      for (int64_t l = 0; l < kLanes; l++) dst[e][l] = src[l * K + e];
+    }
+    return;
+  }
+  for (int e = 0; e < K; e++) {
+    for (int64_t l = 0; l < kLanes; l++) {
+      dst[e][l] = l < items ? src[l * K + e] : T(0);
+    }
+  }
+}
+
+template <typename T, int K>
+XLA_EXTENSION_KERNEL_INLINE void StoreLanes(const T (&src)[K][kLanes],
+                                            int64_t items, T* dst) {
+  for (int e = 0; e < K; e++) {
+    for (int64_t l = 0; l < items; l++) dst[l * K + e] = src[e][l];
+  }
+}
+
+template <typename T, int N>
+XLA_EXTENSION_KERNEL_INLINE void MatMulBlocks(const T* a, const T* b, T* c,
+                                              int64_t count) {
+  constexpr int K = N * N;
+  for (int64_t start = 0; start < count; start += kLanes) {
+    const int64_t items = std::min(kLanes, count - start);
+    alignas(64) T at[K][kLanes], bt[K][kLanes], ct[K][kLanes];
+    LoadLanes<T, K>(a + start * K, items, at);
+    LoadLanes<T, K>(b + start * K, items, bt);
+    for (int i = 0; i < N; i++) {
+      for (int j = 0; j < N; j++) {
+        T* out = ct[i * N + j];
+        for (int64_t l = 0; l < kLanes; l++) out[l] = at[i * N][l] * bt[j][l];
+        for (int k = 1; k < N; k++) {
+          for (int64_t l = 0; l < kLanes; l++) {
+            out[l] += at[i * N + k][l] * bt[k * N + j][l];
+          }
+        }
+      }
+    }
+    StoreLanes<T, K>(ct, items, c + start * K);
+  }
+}
+
+template <typename T, int N>
+XLA_EXTENSION_KERNEL_INLINE void MatVecBlocks(const T* a, const T* x, T* y,
+                                              int64_t count) {
+  constexpr int K = N * N;
+  for (int64_t start = 0; start < count; start += kLanes) {
+    const int64_t items = std::min(kLanes, count - start);
+    alignas(64) T at[K][kLanes], xt[N][kLanes], yt[N][kLanes];
+    LoadLanes<T, K>(a + start * K, items, at);
+    LoadLanes<T, N>(x + start * N, items, xt);
+    for (int i = 0; i < N; i++) {
+      for (int64_t l = 0; l < kLanes; l++) yt[i][l] = at[i * N][l] * xt[0][l];
+      for (int k = 1; k < N; k++) {
+        for (int64_t l = 0; l < kLanes; l++) yt[i][l] += at[i * N + k][l] * xt[k][l];
+      }
+    }
+    StoreLanes<T, N>(yt, items, y + start * N);
+  }
+}
+
+// Sizes without an unrolled kernel, one item at a time
+template <typename T>
+XLA_EXTENSION_KERNEL_INLINE void MatMulGeneric(const T* a, const T* b, T* c,
+                                               int64_t n, int64_t count) {
+  for (int64_t item = 0; item < count; item++) {
+    const T* ai = a + item * n * n;
+    const T* bi = b + item * n * n;
+    T* ci = c + item * n * n;
+    for (int64_t i = 0; i < n; i++) {
+      for (int64_t j = 0; j < n; j++) {
+        T sum = 0;
+        for (int64_t k = 0; k < n; k++) sum += ai[i * n + k] * bi[k * n + j];
+        ci[i * n + j] = sum;
+      }
+    }
+  }
+}
+
+template <typename T>
+XLA_EXTENSION_KERNEL_INLINE void MatVecGeneric(const T* a, const T* x, T* y,
+                                               int64_t n, int64_t count) {
+  for (int64_t item = 0; item < count; item++) {
+    for (int64_t i = 0; i < n; i++) {
+      T sum = 0;
+      for (int64_t k = 0; k < n; k++) {
+        sum += a[(item * n + i) * n + k] * x[item * n + k];
+      }
+      y[item * n + i] = sum;
+    }
+  }
+}
+
+template <typename T>
+XLA_EXTENSION_KERNEL_INLINE void MatMul(const T* a, const T* b, T* c,
+                                        int64_t n, int64_t count) {
+  switch (n) {
+    case 3: return MatMulBlocks<T, 3>(a, b, c, count);
+    case 4: return MatMulBlocks<T, 4>(a, b, c, count);
+    case 6: return MatMulBlocks<T, 6>(a, b, c, count);
+    default: return MatMulGeneric<T>(a, b, c, n, count);
+  }
+}
+
+template <typename T>
+XLA_EXTENSION_KERNEL_INLINE void MatVec(const T* a, const T* x, T* y,
+                                        int64_t n, int64_t count) {
+  switch (n) {
+    case 3: return MatVecBlocks<T, 3>(a, x, y, count);
+    case 4: return MatVecBlocks<T, 4>(a, x, y, count);
+    case 6: return MatVecBlocks<T, 6>(a, x, y, count);
+    default: return MatVecGeneric<T>(a, x, y, n, count);
+  }
+}
+
+template <typename T>
+XLA_EXTENSION_KERNEL_INLINE void QuatMul(const T* p, const T* q, T* out,
+                                         int64_t count) {
+  for (int64_t start = 0; start < count; start += kLanes) {
+    const int64_t items = std::min(kLanes, count - start);
+    alignas(64) T pt[4][kLanes], qt[4][kLanes], rt[4][kLanes];
+    LoadLanes<T, 4>(p + start * 4, items, pt);
+    LoadLanes<T, 4>(q + start * 4, items, qt);
+    for (int64_t l = 0; l < kLanes; l++) {
+      const T pw = pt[0][l], px = pt[1][l], py = pt[2][l], pz = pt[3][l];
+      const T qw = qt[0][l], qx = qt[1][l], qy = qt[2][l], qz = qt[3][l];
+      rt[0][l] = pw * qw - px * qx - py * qy - pz * qz;
+      rt[1][l] = pw * qx + px * qw + py * qz - pz * qy;
+      rt[2][l] = pw * qy - px * qz + py * qw + pz * qx;
+      rt[3][l] = pw * qz + px * qy - py * qx + pz * qw;
+    }
+    StoreLanes<T, 4>(rt, items, out + start * 4);
+  }
+}
+
+template <typename T>
+XLA_EXTENSION_KERNEL_INLINE void QuatRotate(const T* q, const T* v, T* out,
+                                            int64_t count) {
+  for (int64_t start = 0; start < count; start += kLanes) {
+    const int64_t items = std::min(kLanes, count - start);
+    alignas(64) T qt[4][kLanes], vt[3][kLanes], rt[3][kLanes];
+    LoadLanes<T, 4>(q + start * 4, items, qt);
+    LoadLanes<T, 3>(v + start * 3, items, vt);
+    for (int64_t l = 0; l < kLanes; l++) {
+      const T w = qt[0][l], ux = qt[1][l], uy = qt[2][l], uz = qt[3][l];
+      const T vx = vt[0][l], vy = vt[1][l], vz = vt[2][l];
+      // v' = v + w t + u x t with t = 2 u x v
+      const T tx = 2 * (uy * vz - uz * vy);
+      const T ty = 2 * (uz * vx - ux * vz);
+      const T tz = 2 * (ux * vy - uy * vx);
+      rt[0][l] = vx + w * tx + (uy * tz - uz * ty);
+      rt[1][l] = vy + w * ty + (uz * tx - ux * tz);
+      rt[2][l] = vz + w * tz + (ux * ty - uy * tx);
+    }
+    StoreLanes<T, 3>(rt, items, out + start * 3);
+  }
+}
+
+template <typename T>
+XLA_EXTENSION_KERNEL_INLINE void SpatialTransform(const T* e, const T* r,
+                                                  const T* m, T* out,
+                                                  int64_t count) {
+  for (int64_t start = 0; start < count; start += kLanes) {
+    const int64_t items = std::min(kLanes, count - start);
+    alignas(64) T et[9][kLanes], rt[3][kLanes], mt[6][kLanes], ot[6][kLanes];
+    LoadLanes<T, 9>(e + start * 9, items, et);
+    LoadLanes<T, 3>(r + start * 3, items, rt);
+    LoadLanes<T, 6>(m + start * 6, items, mt);
+    for (int64_t l = 0; l < kLanes; l++) {
+      const T wx = mt[0][l], wy = mt[1][l], wz = mt[2][l];
+      const T rx = rt[0][l], ry = rt[1][l], rz = rt[2][l];
+      // d = linear - r x angular
+      const T dx = mt[3][l] - (ry * wz - rz * wy);
+      const T dy = mt[4][l] - (rz * wx - rx * wz);
+      const T dz = mt[5][l] - (rx * wy - ry * wx);
+      for (int i = 0; i < 3; i++) {
+        const T e0 = et[i * 3][l], e1 = et[i * 3 + 1][l], e2 = et[i * 3 + 2][l];
+        ot[i][l] = e0 * wx + e1 * wy + e2 * wz;
+        ot[3 + i][l] = e0 * dx + e1 * dy + e2 * dz;
+      }
+    }
+    StoreLanes<T, 6>(ot, items, out + start * 6);
+  }
+}
+
+// Entry points, one clone per instruction set
+
+XLA_EXTENSION_KERNEL_CLONES void MatMulKernel(const float* a, const float* b,
+                                              float* c, int64_t n,
+                                              int64_t count) {
+  MatMul(a, b, c, n, count);
+}
+
+XLA_EXTENSION_KERNEL_CLONES void MatMulKernel(const double* a, const double* b,
+                                              double* c, int64_t n,
+                                              int64_t count) {
+  MatMul(a, b, c, n, count);
+}
+
+XLA_EXTENSION_KERNEL_CLONES void MatVecKernel(const float* a, const float* x,
+                                              float* y, int64_t n,
+                                              int64_t count) {
+  MatVec(a, x, y, n, count);
+}
+
+XLA_EXTENSION_KERNEL_CLONES void MatVecKernel(const double* a, const double* x,
+                                              double* y, int64_t n,
+                                              int64_t count) {
+  MatVec(a, x, y, n, count);
+}
+
+XLA_EXTENSION_KERNEL_CLONES void QuatMulKernel(const float* p, const float* q,
+                                               float* out, int64_t count) {
+  QuatMul(p, q, out, count);
+}
+
+XLA_EXTENSION_KERNEL_CLONES void QuatMulKernel(const double* p, const double* q,
+                                               double* out, int64_t count) {
+  QuatMul(p, q, out, count);
+}
+
+XLA_EXTENSION_KERNEL_CLONES void QuatRotateKernel(const float* q, const float* v,
+                                                  float* out, int64_t count) {
+  QuatRotate(q, v, out, count);
+}
+
+XLA_EXTENSION_KERNEL_CLONES void QuatRotateKernel(const double* q,
+                                                  const double* v, double* out,
+                                                  int64_t count) {
+  QuatRotate(q, v, out, count);
+}
+
+XLA_EXTENSION_KERNEL_CLONES void SpatialTransformKernel(const float* e,
+                                                        const float* r,
+                                                        const float* m,
+                                                        float* out,
+                                                        int64_t count) {
+  SpatialTransform(e, r, m, out, count);
+}
+
+XLA_EXTENSION_KERNEL_CLONES void SpatialTransformKernel(const double* e,
+                                                        const double* r,
+                                                        const double* m,
+                                                        double* out,
+                                                        int64_t count) {
+  SpatialTransform(e, r, m, out, count);
+}
+
+// FFI handlers. The builder functions of spatial_kernels.h check shapes
+// when building the computation, the handlers only guard against out of bounds access
+// from hand-written custom calls
+
+// Number of items of `buffer` with `item_size` elements each, or
+// std::nullopt if `buffer` does not hold whole items
+template <ffi::DataType dtype>
+std::optional<int64_t> ItemCount(const ffi::Buffer<dtype>& buffer,
+                                 int64_t item_size) {
+  const int64_t elements = static_cast<int64_t>(buffer.element_count());
+  if (item_size <= 0 || elements % item_size != 0) return std::nullopt;
+  return elements / item_size;
+}
+
+// Matrix dimension of a [..., n, n] buffer, or 0 if it is not one
+template <ffi::DataType dtype>
+int64_t MatrixSize(const ffi::Buffer<dtype>& buffer) {
+  auto dims = buffer.dimensions();
+  const size_t rank = dims.size();
+  if (rank < 2 || dims[rank - 1] != dims[rank - 2]) return 0;
+  const int64_t n = dims[rank - 1];
+  return n >= 1 && n <= kMaxSmallMatrixSize ? n : 0;
+}
+
+ffi::Error MismatchError(const char* op) {
+  return ffi::Error::InvalidArgument(
+      absl::StrCat(op, ": operands have mismatched batch or item shapes"));
+}
+
+template <ffi::DataType dtype>
+ffi::Error BatchedMatMulImpl(ffi::Buffer<dtype> a, ffi::Buffer<dtype> b,
+                             ffi::ResultBuffer<dtype> c) {
+  const int64_t n = MatrixSize(a);
+  if (n == 0 || MatrixSize(b) != n) return MismatchError("batched_matmul");
+  auto count = ItemCount(a, n * n);
+  if (!count || ItemCount(b, n * n) != count || ItemCount(*c, n * n) != count) {
+    return MismatchError("batched_matmul");
+  }
+  MatMulKernel(a.typed_data(), b.typed_data(), c->typed_data(), n, *count);
+  return ffi::Error::Success();
+}
+
+template <ffi::DataType dtype>
+ffi::Error BatchedMatVecImpl(ffi::Buffer<dtype> a, ffi::Buffer<dtype> x,
+                             ffi::ResultBuffer<dtype> y) {
+  const int64_t n = MatrixSize(a);
+  if (n == 0) return MismatchError("batched_matvec");
+  auto count = ItemCount(a, n * n);
+  if (!count || ItemCount(x, n) != count || ItemCount(*y, n) != count) {
+    return MismatchError("batched_matvec");
+  }
+  MatVecKernel(a.typed_data(), x.typed_data(), y->typed_data(), n, *count);
+  return ffi::Error::Success();
+}
+
+template <ffi::DataType dtype>
+ffi::Error QuaternionMultiplyImpl(ffi::Buffer<dtype> p, ffi::Buffer<dtype> q,
+                                  ffi::ResultBuffer<dtype> out) {
+  auto count = ItemCount(p, 4);
+  if (!count || ItemCount(q, 4) != count || ItemCount(*out, 4) != count) {
+    return MismatchError("quaternion_multiply");
+  }
+  QuatMulKernel(p.typed_data(), q.typed_data(), out->typed_data(), *count);
+  return ffi::Error::Success();
+}
+
+template <ffi::DataType dtype>
+ffi::Error QuaternionRotateImpl(ffi::Buffer<dtype> q, ffi::Buffer<dtype> v,
+                                ffi::ResultBuffer<dtype> out) {
+  auto count = ItemCount(q, 4);
+  if (!count || ItemCount(v, 3) != count || ItemCount(*out, 3) != count) {
+    return MismatchError("quaternion_rotate");
+  }
+  QuatRotateKernel(q.typed_data(), v.typed_data(), out->typed_data(), *count);
+  return ffi::Error::Success();
+}
+
+template <ffi::DataType dtype>
+ffi::Error SpatialTransformImpl(ffi::Buffer<dtype> e, ffi::Buffer<dtype> r,
+                                ffi::Buffer<dtype> m,
+                                ffi::ResultBuffer<dtype> out) {
+  auto count = ItemCount(e, 9);
+  if (!count || ItemCount(r, 3) != count || ItemCount(m, 6) != count ||
+      ItemCount(*out, 6) != count) {
+    return MismatchError("spatial_transform");
+  }
+  SpatialTransformKernel(e.typed_data(), r.typed_data(), m.typed_data(),
+                         out->typed_data(), *count);
+  return ffi::Error::Success();
+}
+
+template <ffi::DataType dtype>
+auto BinaryBinding() {
+  return ffi::Ffi::Bind()
+      .Arg<ffi::Buffer<dtype>>()
+      .Arg<ffi::Buffer<dtype>>()
+      .Ret<ffi::Buffer<dtype>>();
+}
+
+template <ffi::DataType dtype>
+auto TernaryBinding() {
+  return ffi::Ffi::Bind()
+      .Arg<ffi::Buffer<dtype>>()
+      .Arg<ffi::Buffer<dtype>>()
+      .Arg<ffi::Buffer<dtype>>()
+      .Ret<ffi::Buffer<dtype>>();
+}
+
+XLA_FFI_DEFINE_HANDLER(kBatchedMatMulF32, BatchedMatMulImpl<ffi::F32>, BinaryBinding<ffi::F32>());
+XLA_FFI_DEFINE_HANDLER(kBatchedMatMulF64, BatchedMatMulImpl<ffi::F64>, BinaryBinding<ffi::F64>());
+XLA_FFI_DEFINE_HANDLER(kBatchedMatVecF32, BatchedMatVecImpl<ffi::F32>, BinaryBinding<ffi::F32>());
+XLA_FFI_DEFINE_HANDLER(kBatchedMatVecF64, BatchedMatVecImpl<ffi::F64>, BinaryBinding<ffi::F64>());
+XLA_FFI_DEFINE_HANDLER(kQuaternionMultiplyF32, QuaternionMultiplyImpl<ffi::F32>, BinaryBinding<ffi::F32>());
+XLA_FFI_DEFINE_HANDLER(kQuaternionMultiplyF64, QuaternionMultiplyImpl<ffi::F64>, BinaryBinding<ffi::F64>());
+XLA_FFI_DEFINE_HANDLER(kQuaternionRotateF32, QuaternionRotateImpl<ffi::F32>, BinaryBinding<ffi::F32>());
+XLA_FFI_DEFINE_HANDLER(kQuaternionRotateF64, QuaternionRotateImpl<ffi::F64>, BinaryBinding<ffi::F64>());
+XLA_FFI_DEFINE_HANDLER(kSpatialTransformF32, SpatialTransformImpl<ffi::F32>, TernaryBinding<ffi::F32>());
+XLA_FFI_DEFINE_HANDLER(kSpatialTransformF64, SpatialTransformImpl<ffi::F64>, TernaryBinding<ffi::F64>());
+
+void Register(const char* target, const char* suffix, XLA_FFI_Handler* handler) {
+  XLA_FFI_Error* error = ffi::Ffi::RegisterStaticHandler(
+      ffi::GetXlaFfiApi(), absl::StrCat(target, suffix), "Host", handler);
+  CHECK(error == nullptr) << "Failed to register custom call " << target << suffix;
+}
+
+}  // namespace
+
+void RegisterSpatialKernels() {
+  static absl::once_flag once;
+  absl::call_once(once, [] {
+    Register(kBatchedMatMulTarget, "_f32", kBatchedMatMulF32);
+    Register(kBatchedMatMulTarget, "_f64", kBatchedMatMulF64);
+    Register(kBatchedMatVecTarget, "_f32", kBatchedMatVecF32);
+    Register(kBatchedMatVecTarget, "_f64", kBatchedMatVecF64);
+    Register(kQuaternionMultiplyTarget, "_f32", kQuaternionMultiplyF32);
+    Register(kQuaternionMultiplyTarget, "_f64", kQuaternionMultiplyF64);
+    Register(kQuaternionRotateTarget, "_f32", kQuaternionRotateF32);
+    Register(kQuaternionRotateTarget, "_f64", kQuaternionRotateF64);
+    Register(kSpatialTransformTarget, "_f32", kSpatialTransformF32);
+    Register(kSpatialTransformTarget, "_f64", kSpatialTransformF64);
+  });
+}
+
+std::string SpatialKernelIsa() {
+#if defined(__x86_64__) && defined(__linux__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) return "avx512f";
+  if (__builtin_cpu_supports("avx2")) return "avx2";
+  return "generic";
+#elif defined(__aarch64__)
+  return "neon";
+#else
+  return "generic";
+#endif
+}
+
+}  // namespace extension
+}  // namespace xla
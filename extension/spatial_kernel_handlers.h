@@ -0,0 +1,40 @@
+#ifndef XLA_EXTENSION_SPATIAL_KERNEL_HANDLERS_H_
+#define XLA_EXTENSION_SPATIAL_KERNEL_HANDLERS_H_
+
+#include <cstdint>
+#include <string>
+
+namespace xla {
+namespace extension {
+
+// Host FFI handlers behind the custom calls of spatial_kernels.h, kept
+// apart from the builder functions so that processes loading compiled
+// or ahead-of-time executables can register them without linking the
+// builder (the runtime archive has no XlaBuilder).
+
+// Custom call targets, suffixed with _f32 or _f64
+inline constexpr char kBatchedMatMulTarget[] = "xla_extension_batched_matmul";
+inline constexpr char kBatchedMatVecTarget[] = "xla_extension_batched_matvec";
+inline constexpr char kQuaternionMultiplyTarget[] = "xla_extension_quaternion_multiply";
+inline constexpr char kQuaternionRotateTarget[] = "xla_extension_quaternion_rotate";
+inline constexpr char kSpatialTransformTarget[] = "xla_extension_spatial_transform";
+
+// Largest matrix dimension of the matrix ops. Sizes 3, 4 and 6 have
+// unrolled kernels, the other sizes use a generic loop.
+inline constexpr int64_t kMaxSmallMatrixSize = 8;
+
+// Registers the handlers of all targets above for the Host platform.
+// The builder functions call it, programs that load modules containing
+// these custom calls from HLO text, protos or AOT artifacts must call
+// it before compiling or loading them. Safe to call any number of times
+// from any thread.
+void RegisterSpatialKernels();
+
+// Instruction set the kernels run with on this machine, one of "avx512f",
+// "avx2", "neon" or "generic".
+std::string SpatialKernelIsa();
+
+}  // namespace extension
+}  // namespace xla
+
+#endif  // XLA_EXTENSION_SPATIAL_KERNEL_HANDLERS_H_
@@ -0,0 +1,147 @@
+#include "xla/extension/spatial_kernels.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xla/extension/spatial_kernel_handlers.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/tsl/platform/statusor.h"
+#include "xla/xla_data.pb.h"
+
+namespace xla {
+namespace extension {
+
+namespace {
+
+absl::StatusOr<std::string> TargetName(const char* target, PrimitiveType type) {
+  switch (type) {
+    case F32:
+      return absl::StrCat(target, "_f32");
+    case F64:
+      return absl::StrCat(target, "_f64");
+    default:
+      return absl::InvalidArgumentError(absl::StrCat(
+          target, " supports F32 and F64 operands, got ",
+          PrimitiveType_Name(type)));
+  }
+}
+
+absl::StatusOr<int64_t> SquareMatrixSize(XlaBuilder* builder, XlaOp op) {
+  TF_ASSIGN_OR_RETURN(Shape shape, builder->GetShape(op));
+  const int64_t rank = shape.dimensions_size();
+  if (rank < 2 || shape.dimensions(rank - 1) != shape.dimensions(rank - 2) ||
+      shape.dimensions(rank - 1) < 1 ||
+      shape.dimensions(rank - 1) > kMaxSmallMatrixSize) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "expected a batch of square matrices of size up to ",
+        kMaxSmallMatrixSize, ", got ", ShapeUtil::HumanString(shape)));
+  }
+  return shape.dimensions(rank - 1);
+}
+
+// Adds a custom call to `target` on operands of shape [batch..., item...]
+// with the trailing item dimensions given by `item_dims`, returning
+// [batch..., result_item_dims...]. All operands must share the element
+// type and the batch dimensions
+absl::StatusOr<XlaOp> KernelCall(XlaBuilder* builder, const char* target,
+                                 absl::Span<const XlaOp> operands,
+                                 absl::Span<const std::vector<int64_t>> item_dims,
+                                 const std::vector<int64_t>& result_item_dims) {
+  std::optional<PrimitiveType> type;
+  std::optional<std::vector<int64_t>> batch_dims;
+  std::vector<Shape> operand_shapes;
+
+  for (size_t i = 0; i < operands.size(); i++) {
+    TF_ASSIGN_OR_RETURN(Shape shape, builder->GetShape(operands[i]));
+    const auto& dims = shape.dimensions();
+    const auto& item = item_dims[i];
+
+    bool valid = shape.IsArray() && dims.size() >= item.size() &&
+                 std::equal(item.begin(), item.end(), dims.end() - item.size());
+    std::vector<int64_t> batch(dims.begin(), valid ? dims.end() - item.size() : dims.begin());
+    valid = valid && (!type || *type == shape.element_type()) &&
+            (!batch_dims || *batch_dims == batch);
+    if (!valid) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          target, ": operand ", i, " has shape ", ShapeUtil::HumanString(shape),
+          ", expected trailing dimensions [", absl::StrJoin(item, ","),
+          "] and the element type and batch dimensions of the other operands"));
+    }
+
+    type = shape.element_type();
+    batch_dims = batch;
+    // The kernels expect dense row-major operands
+    operand_shapes.push_back(
+        ShapeUtil::MakeShapeWithDescendingLayout(*type, shape.dimensions()));
+  }
+
+  TF_ASSIGN_OR_RETURN(std::string name, TargetName(target, *type));
+  std::vector<int64_t> result_dims = *batch_dims;
+  result_dims.insert(result_dims.end(), result_item_dims.begin(), result_item_dims.end());
+
+  return CustomCallWithLayout(
+      builder, name, operands,
+      ShapeUtil::MakeShapeWithDescendingLayout(*type, result_dims),
+      operand_shapes, /*opaque=*/"", /*has_side_effect=*/false,
+      /*output_operand_aliasing=*/{}, /*literal=*/nullptr,
+      CustomCallSchedule::SCHEDULE_NONE,
+      CustomCallApiVersion::API_VERSION_TYPED_FFI);
+}
+
+}  // namespace
+
+XlaOp BatchedSmallMatMul(XlaOp a, XlaOp b) {
+  RegisterSpatialKernels();
+  XlaBuilder* builder = a.builder();
+  return builder->ReportErrorOrReturn([&]() -> absl::StatusOr<XlaOp> {
+    TF_ASSIGN_OR_RETURN(int64_t n, SquareMatrixSize(builder, a));
+    return KernelCall(builder, kBatchedMatMulTarget, {a, b}, {{n, n}, {n, n}}, {n, n});
+  });
+}
+
+XlaOp BatchedSmallMatVec(XlaOp a, XlaOp x) {
+  RegisterSpatialKernels();
+  XlaBuilder* builder = a.builder();
+  return builder->ReportErrorOrReturn([&]() -> absl::StatusOr<XlaOp> {
+    TF_ASSIGN_OR_RETURN(int64_t n, SquareMatrixSize(builder, a));
+    return KernelCall(builder, kBatchedMatVecTarget, {a, x}, {{n, n}, {n}}, {n});
+  });
+}
+
+XlaOp QuaternionMultiply(XlaOp p, XlaOp q) {
+  RegisterSpatialKernels();
+  XlaBuilder* builder = p.builder();
+  return builder->ReportErrorOrReturn([&]() -> absl::StatusOr<XlaOp> {
+    return KernelCall(builder, kQuaternionMultiplyTarget, {p, q}, {{4}, {4}}, {4});
+  });
+}
+
+XlaOp QuaternionRotate(XlaOp q, XlaOp v) {
+  RegisterSpatialKernels();
+  XlaBuilder* builder = q.builder();
+  return builder->ReportErrorOrReturn([&]() -> absl::StatusOr<XlaOp> {
+    return KernelCall(builder, kQuaternionRotateTarget, {q, v}, {{4}, {3}}, {3});
+  });
+}
+
+XlaOp SpatialMotionTransform(XlaOp rotation, XlaOp translation, XlaOp motion) {
+  RegisterSpatialKernels();
+  XlaBuilder* builder = rotation.builder();
+  return builder->ReportErrorOrReturn([&]() -> absl::StatusOr<XlaOp> {
+    return KernelCall(builder, kSpatialTransformTarget,
+                      {rotation, translation, motion}, {{3, 3}, {3}, {6}}, {6});
+  });
+}
+
+}  // namespace extension
+}  // namespace xla
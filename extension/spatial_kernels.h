@@ -0,0 +1,51 @@
+#ifndef XLA_EXTENSION_SPATIAL_KERNELS_H_
+#define XLA_EXTENSION_SPATIAL_KERNELS_H_
+
+#include "xla/extension/spatial_kernel_handlers.h"
+#include "xla/hlo/builder/xla_builder.h"
+
+namespace xla {
+namespace extension {
+
+// Batched small-matrix, quaternion and spatial-algebra ops implemented as
+// typed FFI custom calls on the Host platform. XLA lowers graphs of tiny
+// dots and elementwise ops poorly on CPU, these kernels process a batch in
+// blocks of 16 items laid out lane-wise, so that the arithmetic vectorizes
+// across items. On x86-64 Linux the kernels are compiled for AVX-512, AVX2
+// and baseline x86-64 and the best version is picked at load time, on
+// AArch64 they use NEON.
+//
+// All ops accept F32 or F64 operands with any number of leading batch
+// dimensions, which must match between operands. Quaternions are stored
+// as (w, x, y, z) and spatial motion vectors as (angular; linear).
+//
+// The builder functions register the kernels with the CPU client on
+// first use. Tools that load modules with these custom calls without
+// building them (HLO text or protos, AOT artifacts) call
+// RegisterSpatialKernels() from spatial_kernel_handlers.h first.
+
+// C = A x B for `a` and `b` of shape [..., n, n].
+XlaOp BatchedSmallMatMul(XlaOp a, XlaOp b);
+
+// y = A x for `a` of shape [..., n, n] and `x` of shape [..., n].
+XlaOp BatchedSmallMatVec(XlaOp a, XlaOp x);
+
+// Hamilton product p * q for `p` and `q` of shape [..., 4].
+XlaOp QuaternionMultiply(XlaOp p, XlaOp q);
+
+// Rotates `v` of shape [..., 3] by the unit quaternion `q` of shape
+// [..., 4], that is q * v * conj(q).
+XlaOp QuaternionRotate(XlaOp q, XlaOp v);
+
+// Applies the Plücker transform X(E, r) of a rigid-body coordinate change
+// with rotation `rotation` [..., 3, 3] and translation `translation`
+// [..., 3] to the motion vector `motion` [..., 6]:
+//
+//   angular' = E angular
+//   linear'  = E (linear - r x angular)
+XlaOp SpatialMotionTransform(XlaOp rotation, XlaOp translation, XlaOp motion);
+
+}  // namespace extension
+}  // namespace xla
+
+#endif  // XLA_EXTENSION_SPATIAL_KERNELS_H_
@@ -0,0 +1,134 @@
+#include "xla/extension/spmd.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "xla/extension/host_buffer.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/pjrt/pjrt_future.h"
+#include "xla/service/computation_placer.h"
+#include "xla/shape_util.h"
+#include "xla/tsl/platform/statusor.h"
+
+namespace xla {
+namespace extension {
+
+absl::StatusOr<CompileOptions> SpmdCompileOptions(PjRtClient* client,
+                                                  int num_partitions,
+                                                  CompileOptions options) {
+  auto devices = client->addressable_devices();
+  if (num_partitions < 1 ||
+      num_partitions > static_cast<int>(devices.size())) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "requested ", num_partitions, " partitions, but the client has ",
+        devices.size(), " addressable devices"));
+  }
+
+  DeviceAssignment device_assignment(/*replica_count=*/1, num_partitions);
+  for (int partition = 0; partition < num_partitions; partition++) {
+    device_assignment(0, partition) = devices[partition]->id().value();
+  }
+
+  options.executable_build_options.set_num_replicas(1);
+  options.executable_build_options.set_num_partitions(num_partitions);
+  options.executable_build_options.set_use_spmd_partitioning(num_partitions > 1);
+  options.executable_build_options.set_device_assignment(device_assignment);
+  return options;
+}
+
+OpSharding TiledSharding(int64_t rank, int64_t dim, int num_partitions) {
+  OpSharding sharding;
+  sharding.set_type(OpSharding::OTHER);
+  for (int64_t i = 0; i < rank; i++) {
+    sharding.add_tile_assignment_dimensions(i == dim ? num_partitions : 1);
+  }
+  for (int i = 0; i < num_partitions; i++) {
+    sharding.add_tile_assignment_devices(i);
+  }
+  return sharding;
+}
+
+OpSharding ReplicatedSharding() {
+  OpSharding sharding;
+  sharding.set_type(OpSharding::REPLICATED);
+  return sharding;
+}
+
+XlaOp ShardedParameter(XlaBuilder* builder, int64_t parameter_number,
+                       const Shape& shape, const std::string& name,
+                       const OpSharding& sharding) {
+  XlaScopedShardingAssignment assign_sharding(builder, sharding);
+  return Parameter(builder, parameter_number, shape, name);
+}
+
+absl::StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>> ShardToPartitions(
+    PjRtClient* client, PjRtLoadedExecutable* executable, const void* data,
+    PrimitiveType type, absl::Span<const int64_t> global_dims,
+    bool split_leading_dim) {
+  const int num_partitions = executable->num_partitions();
+  std::vector<int64_t> shard_dims(global_dims.begin(), global_dims.end());
+  if (split_leading_dim) {
+    if (shard_dims.empty() || shard_dims[0] % num_partitions != 0) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "leading dimension must be divisible by ", num_partitions));
+    }
+    shard_dims[0] /= num_partitions;
+  }
+  const int64_t shard_bytes =
+      ShapeUtil::ByteSizeOf(ShapeUtil::MakeShape(type, shard_dims));
+  const char* base = static_cast<const char*>(data);
+
+  const auto& logical_ids = executable->addressable_device_logical_ids();
+  const auto& devices = executable->addressable_devices();
+
+  std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+  for (size_t i = 0; i < devices.size(); i++) {
+    int64_t offset = split_leading_dim ? logical_ids[i].partition * shard_bytes : 0;
+    TF_ASSIGN_OR_RETURN(PjRtMemorySpace * memory_space,
+                        devices[i]->default_memory_space());
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<PjRtBuffer> buffer,
+                        BufferFromHostMemory(client, memory_space,
+                                             base + offset, type, shard_dims));
+    buffers.push_back(std::move(buffer));
+  }
+  return buffers;
+}
+
+absl::StatusOr<std::vector<PjRtFuture<>>> GatherFromPartitions(
+    PjRtLoadedExecutable* executable,
+    absl::Span<const std::vector<std::unique_ptr<PjRtBuffer>>> results,
+    int output_index, void* dst, size_t dst_size) {
+  const auto& logical_ids = executable->addressable_device_logical_ids();
+  char* base = static_cast<char*>(dst);
+
+  std::vector<PjRtFuture<>> futures;
+  for (size_t i = 0; i < results.size(); i++) {
+    if (output_index >= static_cast<int>(results[i].size())) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("partition has ", results[i].size(),
+                       " outputs, requested output ", output_index));
+    }
+    PjRtBuffer* buffer = results[i][output_index].get();
+    TF_ASSIGN_OR_RETURN(size_t size, buffer->GetOnDeviceSizeInBytes());
+    size_t offset = logical_ids[i].partition * size;
+    if (offset + size > dst_size) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "destination has ", dst_size, " bytes, which is not enough for ",
+          results.size(), " partition outputs"));
+    }
+    futures.push_back(CopyToHostMemory(buffer, base + offset, size));
+  }
+  return futures;
+}
+
+}  // namespace extension
+}  // namespace xla
@@ -0,0 +1,66 @@
+#ifndef XLA_EXTENSION_SPMD_H_
+#define XLA_EXTENSION_SPMD_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/pjrt/pjrt_future.h"
+#include "xla/shape.h"
+#include "xla/xla_data.pb.h"
+
+namespace xla {
+namespace extension {
+
+// Helpers for partitioning a single computation across CPU devices with
+// the SPMD partitioner. Shardings are attached to builder ops, the
+// partitioner propagates them through the rest of the graph and every
+// device runs its own partition. On the CPU client, create the client
+// with CpuClientOptions::cpu_device_count >= num_partitions.
+
+// Returns `options` configured for `num_partitions` SPMD partitions of a
+// single replica, with partition i assigned to addressable device i.
+absl::StatusOr<CompileOptions> SpmdCompileOptions(
+    PjRtClient* client, int num_partitions,
+    CompileOptions options = CompileOptions());
+
+// Sharding that splits dimension `dim` of a rank `rank` array evenly
+// across `num_partitions` devices.
+OpSharding TiledSharding(int64_t rank, int64_t dim, int num_partitions);
+
+// Sharding that keeps a full copy of the array on every device.
+OpSharding ReplicatedSharding();
+
+// Adds a parameter annotated with `sharding`.
+XlaOp ShardedParameter(XlaBuilder* builder, int64_t parameter_number,
+                       const Shape& shape, const std::string& name,
+                       const OpSharding& sharding);
+
+// Transfers a dense host array of shape `global_dims` to the devices of
+// `executable`. When `split_leading_dim` is true every partition gets its
+// contiguous block of the leading dimension (matching
+// TiledSharding(rank, 0, n)), otherwise every partition gets the whole
+// array (matching ReplicatedSharding()). The returned buffers are ordered
+// like executable->addressable_devices().
+absl::StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>> ShardToPartitions(
+    PjRtClient* client, PjRtLoadedExecutable* executable, const void* data,
+    PrimitiveType type, absl::Span<const int64_t> global_dims,
+    bool split_leading_dim);
+
+// Reads back output `output_index` of every partition into `dst`,
+// assembling a dense array sharded along its leading dimension.
+absl::StatusOr<std::vector<PjRtFuture<>>> GatherFromPartitions(
+    PjRtLoadedExecutable* executable,
+    absl::Span<const std::vector<std::unique_ptr<PjRtBuffer>>> results,
+    int output_index, void* dst, size_t dst_size);
+
+}  // namespace extension
+}  // namespace xla
+
+#endif  // XLA_EXTENSION_SPMD_H_
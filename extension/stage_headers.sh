@@ -0,0 +1,40 @@
+#!/usr/bin/env bash
+#
+# Lays out the headers of a manifest written by the xla_extension_headers
+# genrule as symlinks under DST, so that the packaging tar writes each
+# header once, dereferencing the links, instead of copying the tree first.
+# Each manifest line is an include directory and the path of a header in
+# it, separated by a tab. Relative header paths are resolved against the
+# current directory.
+#
+# Usage: stage_headers.sh MANIFEST DST
+
+set -euo pipefail
+
+manifest="$1"
+dst="$2"
+root="$(pwd)"
+
+# Headers of the same directory come in runs, so they are linked with a
+# single ln per run instead of one per file
+batch_dir=""
+batch_files=()
+link_batch() {
+  if [ ${#batch_files[@]} -gt 0 ]; then
+    mkdir -p "$dst/$batch_dir"
+    ln -sf "${batch_files[@]}" "$dst/$batch_dir/"
+  fi
+  batch_files=()
+}
+
+while IFS=$'\t' read -r dir header; do
+  if [[ "$dir" != "$batch_dir" ]]; then
+    link_batch
+    batch_dir="$dir"
+  fi
+  case "$header" in
+    /*) batch_files+=("$header") ;;
+    *) batch_files+=("$root/$header") ;;
+  esac
+done < "$manifest"
+link_batch
@@ -0,0 +1,118 @@
+#include "xla/extension/state_loop.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/ir/hlo_input_output_alias_config.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/shape_util.h"
+#include "xla/tsl/platform/errors.h"
+#include "xla/tsl/platform/statusor.h"
+
+namespace xla {
+namespace extension {
+
+void AliasStateToOutputs(XlaBuilder* builder, int64_t num_state,
+                         bool tuple_root) {
+  for (int64_t i = 0; i < num_state; i++) {
+    builder->SetUpAlias(tuple_root ? ShapeIndex({i}) : ShapeIndex({}),
+                        /*param_number=*/i, /*param_index=*/{});
+  }
+}
+
+absl::StatusOr<std::unique_ptr<StateLoop>> StateLoop::Create(
+    PjRtLoadedExecutable* executable,
+    std::vector<std::unique_ptr<PjRtBuffer>> state,
+    ExecuteOptions execute_options) {
+  TF_ASSIGN_OR_RETURN(std::vector<std::shared_ptr<HloModule>> modules,
+                      executable->GetHloModules());
+  if (modules.size() != 1) {
+    return absl::InvalidArgumentError(
+        "StateLoop requires an executable with a single module");
+  }
+  const HloInputOutputAliasConfig& aliases =
+      modules[0]->input_output_alias_config();
+
+  std::vector<int64_t> state_outputs;
+  for (int64_t i = 0; i < static_cast<int64_t>(state.size()); i++) {
+    std::optional<ShapeIndex> output = aliases.GetAliasedOutput(i, {});
+    if (!output.has_value() || output->size() > 1) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "parameter ", i, " is not aliased to a top-level output, ",
+          "build the step function with AliasStateToOutputs"));
+    }
+    state_outputs.push_back(output->empty() ? 0 : (*output)[0]);
+  }
+
+  // Only the state is donated, whatever else the executable aliases
+  for (int64_t i = 0; i < static_cast<int64_t>(state.size()); i++) {
+    execute_options.non_donatable_input_indices.erase(i);
+  }
+  for (int64_t i = state.size();
+       i < modules[0]->entry_computation()->num_parameters(); i++) {
+    execute_options.non_donatable_input_indices.insert(i);
+  }
+
+  return absl::WrapUnique(new StateLoop(executable, std::move(state),
+                                        std::move(state_outputs),
+                                        std::move(execute_options)));
+}
+
+StateLoop::StateLoop(PjRtLoadedExecutable* executable,
+                     std::vector<std::unique_ptr<PjRtBuffer>> state,
+                     std::vector<int64_t> state_outputs,
+                     ExecuteOptions options)
+    : executable_(executable),
+      state_(std::move(state)),
+      state_outputs_(std::move(state_outputs)),
+      execute_options_(std::move(options)) {}
+
+absl::StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>> StateLoop::Step(
+    absl::Span<PjRtBuffer* const> inputs) {
+  if (state_.size() != state_outputs_.size()) {
+    return absl::FailedPreconditionError("the state was released");
+  }
+
+  std::vector<std::vector<PjRtBuffer*>> argument_handles(1);
+  for (const auto& buffer : state_) argument_handles[0].push_back(buffer.get());
+  argument_handles[0].insert(argument_handles[0].end(), inputs.begin(),
+                             inputs.end());
+
+  TF_ASSIGN_OR_RETURN(
+      std::vector<std::vector<std::unique_ptr<PjRtBuffer>>> results,
+      executable_->Execute(argument_handles, execute_options_));
+  std::vector<std::unique_ptr<PjRtBuffer>>& outputs = results[0];
+
+  for (int64_t output : state_outputs_) {
+    if (output >= static_cast<int64_t>(outputs.size())) {
+      return absl::InternalError(absl::StrCat("state output ", output,
+                                              " out of ", outputs.size()));
+    }
+  }
+  // The donated buffers are deleted by now, the aliased outputs live in
+  // their memory
+  for (size_t i = 0; i < state_.size(); i++) {
+    state_[i] = std::move(outputs[state_outputs_[i]]);
+  }
+  steps_++;
+
+  std::vector<std::unique_ptr<PjRtBuffer>> rest;
+  for (auto& output : outputs) {
+    if (output != nullptr) rest.push_back(std::move(output));
+  }
+  return rest;
+}
+
+}  // namespace extension
+}  // namespace xla
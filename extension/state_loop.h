@@ -0,0 +1,85 @@
+#ifndef XLA_EXTENSION_STATE_LOOP_H_
+#define XLA_EXTENSION_STATE_LOOP_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+
+namespace xla {
+namespace extension {
+
+// Aliases parameters 0..num_state-1 of the computation being built to
+// outputs 0..num_state-1, so that the executable writes the new state
+// into the buffers of the old one. Output i is element i of the root
+// tuple, or the root itself when `tuple_root` is false, which requires
+// num_state == 1.
+//
+// Must be called before XlaBuilder::Build.
+void AliasStateToOutputs(XlaBuilder* builder, int64_t num_state,
+                         bool tuple_root = true);
+
+// Runs a step function that maps (state..., inputs...) to
+// (new state..., outputs...) with the state kept on the device and
+// updated in place.
+//
+// The state buffers are donated to each step, which makes PjRt reuse
+// them for the aliased outputs (see AliasStateToOutputs) instead of
+// allocating a second copy of the state. A step therefore neither
+// copies the state nor doubles its memory, and the donated buffers are
+// invalidated. Steps are enqueued without waiting, consecutive steps
+// are ordered by their dependency on the state.
+//
+// Not thread-safe.
+class StateLoop {
+ public:
+  // Fails unless the first `state.size()` parameters of the executable
+  // are aliased to outputs. Takes ownership of the initial state.
+  static absl::StatusOr<std::unique_ptr<StateLoop>> Create(
+      PjRtLoadedExecutable* executable,
+      std::vector<std::unique_ptr<PjRtBuffer>> state,
+      ExecuteOptions execute_options = ExecuteOptions());
+
+  StateLoop(const StateLoop&) = delete;
+  StateLoop& operator=(const StateLoop&) = delete;
+
+  // Enqueues one step with the current state followed by `inputs`, and
+  // returns the outputs that are not state. The inputs are not donated.
+  absl::StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>> Step(
+      absl::Span<PjRtBuffer* const> inputs = {});
+
+  // Current state, valid until the next Step.
+  absl::Span<const std::unique_ptr<PjRtBuffer>> state() const {
+    return state_;
+  }
+
+  // Hands the state back, after which the loop may not step anymore.
+  std::vector<std::unique_ptr<PjRtBuffer>> ReleaseState() {
+    return std::move(state_);
+  }
+
+  int64_t steps() const { return steps_; }
+
+ private:
+  StateLoop(PjRtLoadedExecutable* executable,
+            std::vector<std::unique_ptr<PjRtBuffer>> state,
+            std::vector<int64_t> state_outputs, ExecuteOptions options);
+
+  PjRtLoadedExecutable* executable_;
+  std::vector<std::unique_ptr<PjRtBuffer>> state_;
+  // Position among the flattened outputs of the new value of each state
+  std::vector<int64_t> state_outputs_;
+  ExecuteOptions execute_options_;
+  int64_t steps_ = 0;
+};
+
+}  // namespace extension
+}  // namespace xla
+
+#endif  // XLA_EXTENSION_STATE_LOOP_H_
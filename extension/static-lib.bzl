@@ -1,4 +1,25 @@
-"""Provides a rule that outputs a monolithic static library."""
+"""Provides a rule that outputs a monolithic static library.
+
+The library can also be built as one layer of a set of archives, in which
+case `layer_deps` lists the layers it builds on. Objects already merged
+into those layers are left out, so that consumers can link only the
+layers they need, for example a CPU-only application links just the core
+layer instead of the whole monolithic archive.
+
+Besides `<name>.a`, the rule outputs:
+
+  * `<name>.link` - deduplicated linker flags needed by the library and
+    all the layers it builds on
+
+  * `<name>.deps` - the libraries to pass to the linker, in link order,
+    one per line (`-l` names, without the `lib` prefix)
+
+When building with --define=xla_extension_prune=true on Linux, libraries
+with `prune_roots` keep only the objects reachable from the root symbols
+and the objects running code at load time (see prune_archive.py), and
+additionally output `<name>.prune.json` with the archive size before and
+after pruning.
+"""
 
 # Reference: https://gist.github.com/oquenchil/3f88a39876af2061f8aad6cdc9d7c045
 
@@ -6,9 +27,25 @@ load("@bazel_tools//tools/cpp:toolchain_utils.bzl", "find_cpp_toolchain")
 
 TOOLS_CPP_REPO = "@bazel_tools"
 
+StaticLibraryLayerInfo = provider(
+    doc = "A static library that other layers can build on.",
+    fields = {
+        "libs": "depset of static libraries merged into this layer and the layers it builds on",
+        "link_flags": "list of linker flags needed by this layer and the layers it builds on",
+        "link_order": "list of library names, in link order, starting with this layer",
+    },
+)
+
+def _unique(items):
+    return {item: None for item in items}.keys()
+
+def _link_name(name):
+    return name[len("lib"):] if name.startswith("lib") else name
+
 def _cc_static_library_impl(ctx):
     output_lib = ctx.actions.declare_file("{}.a".format(ctx.attr.name))
     output_flags = ctx.actions.declare_file("{}.link".format(ctx.attr.name))
+    output_manifest = ctx.actions.declare_file("{}.deps".format(ctx.attr.name))
 
     cc_toolchain = find_cpp_toolchain(ctx)
 
@@ -18,14 +55,21 @@ def _cc_static_library_impl(ctx):
         lib_sets.append(dep[CcInfo].linking_context.linker_inputs)
     input_depset = depset(transitive = lib_sets)
 
+    layers = [layer[StaticLibraryLayerInfo] for layer in ctx.attr.layer_deps]
+
     # Collect user link flags and make sure they are unique
-    unique_flags = {}
+    flags = []
+    for layer in layers:
+        flags.extend(layer.link_flags)
     for inp in input_depset.to_list():
-        unique_flags.update({
-            flag: None
-            for flag in inp.user_link_flags
-        })
-    link_flags = unique_flags.keys()
+        flags.extend(inp.user_link_flags)
+    link_flags = _unique(flags)
+
+    # Objects already merged into the layers we build on are skipped
+    excluded = {}
+    for layer in layers:
+        for lib in layer.libs.to_list():
+            excluded[lib.path] = None
 
     # Collect static libraries
     libs = []
@@ -35,42 +79,106 @@ def _cc_static_library_impl(ctx):
                 libs.append(lib.pic_static_library)
             elif lib.static_library:
                 libs.append(lib.static_library)
+    all_libs = libs
+    libs = [lib for lib in libs if lib.path not in excluded]
 
     lib_paths = [lib.path for lib in libs]
 
     # Determine if we're on macOS by checking the toolchain
     is_darwin = cc_toolchain.ar_executable.find("libtool") != -1 or cc_toolchain.target_gnu_system_name.find("darwin") != -1
 
-    if is_darwin:
+    prune = ctx.attr.prune_roots and ctx.var.get("xla_extension_prune") == "true" and not is_darwin
+    outputs = [output_flags, output_manifest, output_lib]
+
+    if not libs:
+        # A layer may end up empty, for example the GPU layer of a CPU
+        # build, in which case we still emit a valid (empty) archive
+        command = "printf '!<arch>\\n' > {0}".format(output_lib.path)
+    elif prune:
+        output_stats = ctx.actions.declare_file("{}.prune.json".format(ctx.attr.name))
+        outputs.append(output_stats)
+        roots = ctx.actions.declare_file("{}.prune_roots".format(ctx.attr.name))
+        ctx.actions.write(output = roots, content = "\n".join(ctx.attr.prune_roots) + "\n")
+
+        args = ctx.actions.args()
+        args.add("--ar", ctx.var.get("xla_extension_ar", "ar"))
+        args.add("--nm", ctx.var.get("xla_extension_nm", "nm"))
+        if "xla_extension_cxxfilt" in ctx.var:
+            args.add("--cxxfilt", ctx.var["xla_extension_cxxfilt"])
+        if "xla_extension_readelf" in ctx.var:
+            args.add("--readelf", ctx.var["xla_extension_readelf"])
+        args.add("--roots", roots)
+        args.add("--output", output_lib)
+        args.add("--stats", output_stats)
+        args.add_all(libs)
+
+        ctx.actions.run(
+            executable = ctx.executable._prune_archive,
+            arguments = [args],
+            inputs = libs + [roots],
+            outputs = [output_lib, output_stats],
+            mnemonic = "ArPrune",
+            progress_message = "Merging and pruning static library {}".format(output_lib.path),
+        )
+    elif is_darwin:
         # Use libtool on macOS
         command = "libtool -static -o {0} {1}".format(output_lib.path, " ".join(lib_paths))
     else:
-        # Use ar on Linux
-        ar_path = "ar"
+        # Use ar on Linux, LTO builds pass --define=xla_extension_ar=llvm-ar
+        # so that the archive index covers bitcode objects
+        ar_path = ctx.var.get("xla_extension_ar", "ar")
         # FIXME ar_executable returned llvm-lib.exe on my system, but we want llvm-ar.exe
         ar_path = ar_path.replace("llvm-lib.exe", "llvm-ar.exe")
         command = "\"{0}\" rcT {1} {2} && echo -e 'create {1}\naddlib {1}\nsave\nend' | \"{0}\" -M".format(ar_path, output_lib.path, " ".join(lib_paths))
 
-    ctx.actions.run_shell(
-        command = command,
-        inputs = libs + cc_toolchain.all_files.to_list(),
-        outputs = [output_lib],
-        mnemonic = "ArMerge",
-        progress_message = "Merging static library {}".format(output_lib.path),
-    )
+    if not prune or not libs:
+        ctx.actions.run_shell(
+            command = command,
+            inputs = libs + cc_toolchain.all_files.to_list(),
+            outputs = [output_lib],
+            mnemonic = "ArMerge",
+            progress_message = "Merging static library {}".format(output_lib.path),
+        )
 
     ctx.actions.write(
         output = output_flags,
         content = "\n".join(link_flags) + "\n",
     )
+
+    # Each layer must come before the layers it builds on, so when the
+    # same layer is reachable twice we keep its last occurrence
+    order = [_link_name(ctx.attr.name)]
+    for layer in layers:
+        order.extend(layer.link_order)
+    link_order = reversed(_unique(reversed(order)))
+
+    ctx.actions.write(
+        output = output_manifest,
+        content = "\n".join(link_order) + "\n",
+    )
+
     return [
-        DefaultInfo(files = depset([output_flags, output_lib])),
+        DefaultInfo(files = depset(outputs)),
+        StaticLibraryLayerInfo(
+            libs = depset(all_libs, transitive = [layer.libs for layer in layers]),
+            link_flags = link_flags,
+            link_order = link_order,
+        ),
     ]
 
 cc_static_library = rule(
     implementation = _cc_static_library_impl,
     attrs = {
         "deps": attr.label_list(),
+        "layer_deps": attr.label_list(providers = [StaticLibraryLayerInfo]),
+        "prune_roots": attr.string_list(
+            doc = "Regular expressions matching demangled root symbols, used with --define=xla_extension_prune=true",
+        ),
+        "_prune_archive": attr.label(
+            default = Label("//xla/extension:prune_archive"),
+            executable = True,
+            cfg = "exec",
+        ),
         "_cc_toolchain": attr.label(
             default = TOOLS_CPP_REPO + "//tools/cpp:current_cc_toolchain",
         ),
@@ -0,0 +1,34 @@
+#ifndef XLA_EXTENSION_XLA_EXTENSION_H_
+#define XLA_EXTENSION_XLA_EXTENSION_H_
+
+// Umbrella header for the supported API of the archive: the PjRt client
+// and the CPU client, the HLO builder and its libraries, literals and
+// shapes, and the MLIR <-> HLO entry points. It is the root of the
+// minimal include tree and the source of the precompiled header, see
+// STATIC_BUILD.md.
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xla/hlo/builder/lib/lu_decomposition.h"
+#include "xla/hlo/builder/lib/math.h"
+#include "xla/hlo/builder/lib/matrix.h"
+#include "xla/hlo/builder/lib/qr.h"
+#include "xla/hlo/builder/lib/self_adjoint_eig.h"
+#include "xla/hlo/builder/lib/sorting.h"
+#include "xla/hlo/builder/lib/svd.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/hlo/translate/hlo_to_mhlo/hlo_to_mlir_hlo.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/pjrt/mlir_to_hlo.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/pjrt/pjrt_future.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/xla_data.pb.h"
+
+#endif  // XLA_EXTENSION_XLA_EXTENSION_H_
@@ -60,6 +60,51 @@ defmodule XLA do
     XLA.Utils.stop_inets_profile()
   end
 
+  @doc """
+  Extracts the precompiled XLA archive into `target_dir`.
+
+  Returns the path to the extracted `xla_extension` directory. The
+  archive is resolved like in `archive_path!/0`. If it needs to be
+  downloaded, it is verified, cached and extracted in a single pass
+  over the download, instead of reading it again after the download.
+  """
+  @spec extract_archive!(Path.t()) :: Path.t()
+  def extract_archive!(target_dir) do
+    XLA.Utils.start_inets_profile()
+
+    cond do
+      build?() ->
+        extract_file!(archive_path_for_build(), target_dir)
+
+      path = xla_archive_path() ->
+        extract_file!(path, target_dir)
+
+      url = xla_archive_url() ->
+        path = archive_path_for_external_download(url)
+
+        if File.exists?(path),
+          do: extract_file!(path, target_dir),
+          else: download_external!(url, path, target_dir)
+
+      true ->
+        path = archive_path_for_precompiled_download()
+
+        if File.exists?(path),
+          do: extract_file!(path, target_dir),
+          else: download_precompiled!(path, target_dir)
+    end
+
+    Path.join(target_dir, "xla_extension")
+  after
+    XLA.Utils.stop_inets_profile()
+  end
+
+  defp extract_file!(path, target_dir) do
+    path
+    |> File.stream!([], 64_000)
+    |> Enum.into(%XLA.TarExtractor{dir: target_dir})
+  end
+
   defp build?() do
     System.get_env("XLA_BUILD") in ~w(1 true)
   end
@@ -153,7 +198,17 @@ defmodule XLA do
   end
 
   defp archive_filename(target) do
-    "xla_extension-#{@version}-#{target}.tar.gz"
+    "xla_extension-#{@version}-#{target}#{archive_variant()}.tar.gz"
+  end
+
+  # The performance-tuned build (BUILD_MODE=pgo) contains ThinLTO bitcode,
+  # which requires a different linker setup, so it is a distinct archive
+  defp archive_variant() do
+    if build?() and String.trim(System.get_env("BUILD_MODE", "")) == "pgo" do
+      "-lto-pgo"
+    else
+      ""
+    end
   end
 
   defp cache_path(parts) do
@@ -161,10 +216,26 @@ defmodule XLA do
     Path.join([base_dir, @version | parts])
   end
 
-  defp download_external!(url, archive_path) do
+  defp download_connections() do
+    case System.get_env("XLA_DOWNLOAD_CONNECTIONS", "1") |> Integer.parse() do
+      {connections, ""} when connections > 0 ->
+        connections
+
+      _other ->
+        raise "expected XLA_DOWNLOAD_CONNECTIONS to be a positive integer, got: " <>
+                inspect(System.get_env("XLA_DOWNLOAD_CONNECTIONS"))
+    end
+  end
+
+  defp download_external!(url, archive_path, target_dir \\ nil) do
     Logger.info("Downloading XLA archive from #{url}")
 
-    case download_archive(url, archive_path) do
+    result =
+      staged_extract(target_dir, fn extract_dir ->
+        with {:ok, _checksum} <- download_archive(url, archive_path, extract_dir), do: :ok
+      end)
+
+    case result do
       :ok ->
         Logger.info("Successfully downloaded the XLA archive")
 
@@ -174,7 +245,7 @@ defmodule XLA do
     end
   end
 
-  defp download_precompiled!(archive_path) do
+  defp download_precompiled!(archive_path, target_dir \\ nil) do
     expected_filename = Path.basename(archive_path)
 
     target = target()
@@ -198,37 +269,93 @@ defmodule XLA do
 
     url = release_file_url(expected_filename)
 
-    with :ok <- download_archive(url, archive_path),
-         :ok <- verify_integrity(archive_path) do
-      Logger.info("Successfully downloaded the XLA archive")
-    else
+    result =
+      staged_extract(target_dir, fn extract_dir ->
+        with {:ok, checksum} <- download_archive(url, archive_path, extract_dir) do
+          verify_integrity(archive_path, checksum)
+        end
+      end)
+
+    case result do
+      :ok ->
+        Logger.info("Successfully downloaded the XLA archive")
+
       {:error, message} ->
         File.rm(archive_path)
         raise message
     end
   end
 
+  # Extracts into a temporary directory next to target_dir/xla_extension
+  # and moves the package into place only once fun returns :ok, so that a
+  # failed or unverified download leaves the contents of target_dir as
+  # they were
+  defp staged_extract(nil, fun), do: fun.(nil)
+
+  defp staged_extract(target_dir, fun) do
+    staging_dir = Path.join(target_dir, ".xla_extension-#{System.unique_integer([:positive])}")
+
+    try do
+      with :ok <- fun.(staging_dir) do
+        extension_dir = Path.join(target_dir, "xla_extension")
+        File.rm_rf!(extension_dir)
+        File.rename!(Path.join(staging_dir, "xla_extension"), extension_dir)
+        :ok
+      end
+    after
+      File.rm_rf(staging_dir)
+    end
+  end
+
   defp release_file_url(filename) do
-    @base_url <> "/" <> filename
+    # The base URL is configurable so that tests can serve the release locally
+    Application.get_env(:xla, :release_base_url, @base_url) <> "/" <> filename
   end
 
-  defp download_archive(url, archive_path) do
+  # Downloads the archive, computing its checksum and optionally
+  # extracting it into extract_dir in the same pass. With parallel range
+  # requests the chunks arrive out of order, so the checksum and the
+  # extraction take a single pass over the file once it is complete
+  defp download_archive(url, archive_path, extract_dir) do
     File.mkdir_p!(Path.dirname(archive_path))
 
-    file = File.stream!(archive_path)
+    consumers =
+      if extract_dir,
+        do: [%XLA.Checksumer{}, %XLA.TarExtractor{dir: extract_dir}],
+        else: [%XLA.Checksumer{}]
+
+    result =
+      case download_connections() do
+        1 ->
+          file = File.stream!(archive_path)
+          XLA.Utils.download(url, %XLA.Tee{collectables: consumers ++ [file]})
+
+        connections ->
+          with :ok <- XLA.Utils.download_ranges(url, archive_path, connections) do
+            try do
+              results =
+                archive_path
+                |> File.stream!([], 64_000)
+                |> Enum.into(%XLA.Tee{collectables: consumers})
+
+              {:ok, results}
+            rescue
+              error -> {:error, Exception.message(error)}
+            end
+          end
+      end
 
-    case XLA.Utils.download(url, file) do
-      {:ok, _file} ->
-        :ok
+    case result do
+      {:ok, [checksum | _]} ->
+        {:ok, checksum}
 
       {:error, message} ->
         {:error, "failed to download the XLA archive from #{url}, reason: #{message}"}
     end
   end
 
-  defp verify_integrity(path) do
+  defp verify_integrity(path, checksum) do
     filename = Path.basename(path)
-    checksum = compute_file_checksum!(path)
 
     case read_checksums!() do
       %{^filename => ^checksum} ->
@@ -263,18 +390,13 @@ defmodule XLA do
     end
   end
 
-  defp compute_file_checksum!(path) do
-    path
-    |> File.stream!([], 64_000)
-    |> Enum.into(%XLA.Checksumer{})
-  end
-
   defp checksum_path() do
     # Note that this path points to the project source, which normally
     # may not be available at runtime (in releases). However, we expect
     # XLA to be called only during compilation, in which case this path
-    # is still available
-    Path.expand("../checksum.txt", __DIR__)
+    # is still available. It is configurable so that tests never write
+    # to the project source
+    Application.get_env(:xla, :checksum_path, Path.expand("../checksum.txt", __DIR__))
   end
 
   defp precompiled_targets(), do: @precompiled_targets
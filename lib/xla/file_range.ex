@@ -0,0 +1,32 @@
+defmodule XLA.FileRange do
+  @moduledoc false
+
+  # Writes the collected chunks to `path` starting at byte `offset`,
+  # without truncating the file, so that several processes can each fill
+  # their own range of it.
+
+  defstruct [:path, offset: 0]
+
+  defimpl Collectable do
+    def into(range) do
+      {:ok, file} = :file.open(range.path, [:read, :write, :raw, :binary])
+      {:ok, _} = :file.position(file, range.offset)
+
+      collector = fn
+        file, {:cont, chunk} ->
+          :ok = :file.write(file, chunk)
+          file
+
+        file, :done ->
+          :ok = :file.close(file)
+          range.path
+
+        file, :halt ->
+          :file.close(file)
+          :ok
+      end
+
+      {file, collector}
+    end
+  end
+end
@@ -0,0 +1,230 @@
+defmodule XLA.TarExtractor do
+  @moduledoc false
+
+  # Extracts a gzipped tarball into `dir` as it is being collected, so
+  # that an archive can be unpacked while it is downloaded. Supports
+  # regular files, directories and relative symlinks, with long paths in
+  # either the GNU or the pax format. The result is `dir`.
+
+  defstruct [:dir]
+
+  defimpl Collectable do
+    import Bitwise
+
+    @block_size 512
+
+    def into(extractor) do
+      z = :zlib.open()
+      # Window bits of 31 select the gzip format
+      :ok = :zlib.inflateInit(z, 31)
+      File.mkdir_p!(extractor.dir)
+
+      state = %{
+        dir: extractor.dir,
+        z: z,
+        buffer: "",
+        entry: nil,
+        skip: 0,
+        long_path: nil,
+        done: false
+      }
+
+      collector = fn
+        state, {:cont, chunk} ->
+          data = state.z |> :zlib.inflate(chunk) |> IO.iodata_to_binary()
+          process(%{state | buffer: state.buffer <> data})
+
+        state, :done ->
+          # Raises when the gzip stream is incomplete
+          :zlib.inflateEnd(state.z)
+          :zlib.close(state.z)
+
+          if state.entry != nil or not state.done do
+            raise "unexpected end of the XLA archive"
+          end
+
+          state.dir
+
+        state, :halt ->
+          close_entry(state.entry)
+          :zlib.close(state.z)
+          :ok
+      end
+
+      {state, collector}
+    end
+
+    defp process(%{skip: skip, buffer: buffer} = state) when skip > 0 do
+      size = min(skip, byte_size(buffer))
+      <<_::binary-size(size), rest::binary>> = buffer
+      state = %{state | skip: skip - size, buffer: rest}
+      if state.skip == 0, do: process(state), else: state
+    end
+
+    defp process(%{entry: nil, done: true} = state) do
+      # Everything after the end-of-archive marker is padding
+      %{state | buffer: ""}
+    end
+
+    defp process(%{entry: nil, buffer: <<header::binary-size(@block_size), rest::binary>>} = state) do
+      state = %{state | buffer: rest}
+
+      if header == <<0::size(@block_size * 8)>> do
+        process(%{state | done: true})
+      else
+        state
+        |> start_entry(parse_header(header))
+        |> process()
+      end
+    end
+
+    defp process(%{entry: nil} = state), do: state
+
+    defp process(%{entry: entry, buffer: buffer} = state) do
+      size = min(entry.remaining, byte_size(buffer))
+      <<data::binary-size(size), rest::binary>> = buffer
+      entry = %{consume(entry, data) | remaining: entry.remaining - size}
+      state = %{state | buffer: rest}
+
+      if entry.remaining == 0 do
+        state = finish_entry(state, entry)
+        process(%{state | entry: nil, skip: padding(entry.size)})
+      else
+        %{state | entry: entry}
+      end
+    end
+
+    defp parse_header(header) do
+      <<name::binary-100, mode::binary-8, _uid::binary-8, _gid::binary-8, size::binary-12,
+        _mtime::binary-12, _checksum::binary-8, type, linkname::binary-100, magic::binary-6,
+        _version::binary-2, _uname::binary-32, _gname::binary-32, _devmajor::binary-8,
+        _devminor::binary-8, prefix::binary-155, _pad::binary-12>> = header
+
+      name = cstring(name)
+      prefix = cstring(prefix)
+
+      path =
+        if String.starts_with?(magic, "ustar") and prefix != "" do
+          prefix <> "/" <> name
+        else
+          name
+        end
+
+      %{
+        path: path,
+        mode: octal(mode),
+        size: octal(size),
+        type: type,
+        linkname: cstring(linkname)
+      }
+    end
+
+    defp start_entry(state, header) do
+      path = state.long_path || header.path
+      state = %{state | long_path: nil}
+      entry = %{type: :skip, io: nil, path: nil, mode: header.mode, size: header.size}
+
+      entry =
+        case header.type do
+          type when type in [?0, 0, ?7] ->
+            target = safe_join(state.dir, path)
+            File.mkdir_p!(Path.dirname(target))
+            {:ok, file} = :file.open(target, [:write, :raw, :binary])
+            %{entry | type: :file, io: file, path: target}
+
+          ?5 ->
+            File.mkdir_p!(safe_join(state.dir, path))
+            entry
+
+          ?2 ->
+            target = safe_join(state.dir, path)
+            # Relative links within the archive only, so that no later
+            # entry is written outside of dir through a link
+            safe_join(Path.dirname(target), header.linkname)
+            File.mkdir_p!(Path.dirname(target))
+            File.rm(target)
+            File.ln_s!(header.linkname, target)
+            entry
+
+          ?L ->
+            %{entry | type: :long_path, io: []}
+
+          ?x ->
+            %{entry | type: :pax, io: []}
+
+          _other ->
+            entry
+        end
+
+      %{state | entry: Map.put(entry, :remaining, header.size)}
+    end
+
+    defp consume(%{type: :file} = entry, data) do
+      :ok = :file.write(entry.io, data)
+      entry
+    end
+
+    defp consume(%{type: type} = entry, data) when type in [:long_path, :pax] do
+      %{entry | io: [entry.io | data]}
+    end
+
+    defp consume(entry, _data), do: entry
+
+    defp finish_entry(state, %{type: :file} = entry) do
+      :ok = :file.close(entry.io)
+      File.chmod!(entry.path, entry.mode &&& 0o777)
+      state
+    end
+
+    defp finish_entry(state, %{type: :long_path} = entry) do
+      %{state | long_path: entry.io |> IO.iodata_to_binary() |> cstring()}
+    end
+
+    defp finish_entry(state, %{type: :pax} = entry) do
+      %{state | long_path: entry.io |> IO.iodata_to_binary() |> pax_path()}
+    end
+
+    defp finish_entry(state, _entry), do: state
+
+    defp close_entry(%{type: :file, io: file}), do: :file.close(file)
+    defp close_entry(_entry), do: :ok
+
+    # Records have the form "<length> <key>=<value>\n"
+    defp pax_path(data) do
+      data
+      |> String.split("\n", trim: true)
+      |> Enum.find_value(fn record ->
+        with [_length, pair] <- String.split(record, " ", parts: 2),
+             ["path", path] <- String.split(pair, "=", parts: 2) do
+          path
+        else
+          _ -> nil
+        end
+      end)
+    end
+
+    defp safe_join(dir, path) do
+      parts = path |> Path.split() |> Enum.reject(&(&1 == "."))
+
+      if Path.type(path) != :relative or ".." in parts do
+        raise "refusing to extract #{inspect(path)} outside of the target directory"
+      end
+
+      Path.join([dir | parts])
+    end
+
+    defp padding(size), do: rem(@block_size - rem(size, @block_size), @block_size)
+
+    defp cstring(binary), do: binary |> :binary.split(<<0>>) |> hd()
+
+    # Sizes above 8GB use base-256, marked by the highest bit
+    defp octal(<<1::1, _::7, rest::binary>>), do: :binary.decode_unsigned(rest)
+
+    defp octal(binary) do
+      case binary |> cstring() |> String.trim() do
+        "" -> 0
+        digits -> String.to_integer(digits, 8)
+      end
+    end
+  end
+end
@@ -0,0 +1,29 @@
+defmodule XLA.Tee do
+  @moduledoc false
+
+  # Collects every chunk into all of the given collectables, so a single
+  # pass over a stream can write, checksum and extract it at once. The
+  # result is the list of results of the individual collectables.
+
+  defstruct collectables: []
+
+  defimpl Collectable do
+    def into(tee) do
+      intos = Enum.map(tee.collectables, &Collectable.into/1)
+
+      collector = fn
+        intos, {:cont, chunk} ->
+          Enum.map(intos, fn {acc, collector} -> {collector.(acc, {:cont, chunk}), collector} end)
+
+        intos, :done ->
+          Enum.map(intos, fn {acc, collector} -> collector.(acc, :done) end)
+
+        intos, :halt ->
+          Enum.each(intos, fn {acc, collector} -> collector.(acc, :halt) end)
+          :ok
+      end
+
+      {intos, collector}
+    end
+  end
+end
@@ -11,6 +11,8 @@ defmodule XLA.Utils do
 
     * `:headers` - request headers
 
+    * `:status` - the expected response status. Defaults to `200`
+
   """
   @spec download(String.t(), Collectable.t(), keyword()) ::
           {:ok, Collectable.t()} | {:error, String.t()}
@@ -33,15 +35,20 @@ defmodule XLA.Utils do
       end
     end
 
-    opts = [stream: :self, sync: false, receiver: receiver]
+    request_opts = [stream: :self, sync: false, receiver: receiver]
 
-    {:ok, request_id} = :httpc.request(:get, request, http_opts, opts, :xla)
+    {:ok, request_id} = :httpc.request(:get, request, http_opts, request_opts, :xla)
 
     try do
       {acc, collector} = Collectable.into(collectable)
 
       try do
-        download_loop(%{request_id: request_id, acc: acc, collector: collector})
+        download_loop(%{
+          request_id: request_id,
+          acc: acc,
+          collector: collector,
+          status: opts[:status] || 200
+        })
       catch
         kind, reason ->
           collector.(acc, :halt)
@@ -86,7 +93,7 @@ defmodule XLA.Utils do
     {:error, "reason: #{inspect(error)}"}
   end
 
-  defp download_receive(state, {_, {{_, 200, _}, _headers, body}}) do
+  defp download_receive(%{status: status} = state, {_, {{_, status, _}, _headers, body}}) do
     acc = state.collector.(state.acc, {:cont, body})
     {:ok, %{state | acc: acc}}
   end
@@ -95,6 +102,16 @@ defmodule XLA.Utils do
     {:error, "got HTTP status #{status}"}
   end
 
+  # httpc streams both 200 and 206 responses, so make sure a range was
+  # returned when we asked for one
+  defp download_receive(%{status: 206} = state, {_, :stream_start, headers}) do
+    if List.keymember?(headers, ~c"content-range", 0) do
+      download_loop(state)
+    else
+      {:error, "expected a partial response to the range request"}
+    end
+  end
+
   defp download_receive(state, {_, :stream_start, _headers}) do
     download_loop(state)
   end
@@ -108,6 +125,66 @@ defmodule XLA.Utils do
     {:ok, state}
   end
 
+  @doc """
+  Downloads resource at the given URL into the file at `path`, using
+  up to `connections` concurrent HTTP range requests.
+
+  Falls back to a single request when the server does not report the
+  content length or does not accept range requests.
+  """
+  @spec download_ranges(String.t(), Path.t(), pos_integer()) :: :ok | {:error, String.t()}
+  def download_ranges(url, path, connections) do
+    case content_info(url) do
+      {:ok, size, true} when connections > 1 and size > 0 ->
+        File.write!(path, "")
+
+        size
+        |> split_ranges(connections)
+        |> Enum.map(fn {first, last} ->
+          Task.async(fn ->
+            download(url, %XLA.FileRange{path: path, offset: first},
+              headers: [{"range", "bytes=#{first}-#{last}"}],
+              status: 206
+            )
+          end)
+        end)
+        |> Task.await_many(:infinity)
+        |> Enum.find(:ok, &match?({:error, _}, &1))
+
+      _other ->
+        case download(url, File.stream!(path)) do
+          {:ok, _file} -> :ok
+          {:error, message} -> {:error, message}
+        end
+    end
+  end
+
+  defp content_info(url) do
+    request = {url, build_headers([])}
+
+    case :httpc.request(:head, request, [ssl: http_ssl_opts()], [], :xla) do
+      {:ok, {{_, 200, _}, headers, _body}} ->
+        length = List.keyfind(headers, ~c"content-length", 0)
+        ranges = List.keyfind(headers, ~c"accept-ranges", 0)
+
+        case length do
+          {_, value} -> {:ok, List.to_integer(value), ranges == {~c"accept-ranges", ~c"bytes"}}
+          nil -> :error
+        end
+
+      _other ->
+        :error
+    end
+  end
+
+  defp split_ranges(size, connections) do
+    chunk = div(size + connections - 1, connections)
+
+    for first <- 0..(size - 1)//chunk do
+      {first, min(first + chunk, size) - 1}
+    end
+  end
+
   defp http_ssl_opts() do
     # Use secure options, see https://gist.github.com/jonatanklosko/5e20ca84127f6b31bbe3906498e1a1d7
     [
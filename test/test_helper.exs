@@ -0,0 +1,133 @@
+defmodule XLA.TestHTTPServer do
+  @moduledoc false
+
+  # Minimal local stand-in for the release file server. Serves `body`
+  # at any path, answers HEAD and single-range GET requests, and records
+  # every request as {method, range}.
+  #
+  # Options:
+  #
+  #   * `:ranges` - whether range requests are supported. Defaults to `true`
+  #
+  #   * `:status` - status of every response. Defaults to `200`
+
+  def start(body, opts \\ []) do
+    {:ok, socket} =
+      :gen_tcp.listen(0, [:binary, packet: :http_bin, active: false, ip: {127, 0, 0, 1}])
+
+    {:ok, port} = :inet.port(socket)
+    {:ok, requests} = Agent.start_link(fn -> [] end)
+
+    pid = spawn_link(fn -> accept_loop(socket, body, requests, opts) end)
+    :ok = :gen_tcp.controlling_process(socket, pid)
+
+    %{url: "http://127.0.0.1:#{port}/xla_extension.tar.gz", requests: requests}
+  end
+
+  def requests(server) do
+    server.requests |> Agent.get(& &1) |> Enum.reverse()
+  end
+
+  defp accept_loop(socket, body, requests, opts) do
+    {:ok, client} = :gen_tcp.accept(socket)
+    pid =
+      spawn(fn ->
+        # Wait for the socket to be handed over
+        receive do
+          :serve -> serve(client, body, requests, opts)
+        end
+      end)
+
+    :ok = :gen_tcp.controlling_process(client, pid)
+    send(pid, :serve)
+    accept_loop(socket, body, requests, opts)
+  end
+
+  defp serve(client, body, requests, opts) do
+    {method, headers} = read_request(client)
+    range = headers["range"]
+    Agent.update(requests, &[{method, range} | &1])
+
+    ranges? = Keyword.get(opts, :ranges, true)
+
+    {status, part, extra_headers} =
+      case {Keyword.get(opts, :status, 200), ranges?, range} do
+        {200, true, "bytes=" <> spec} ->
+          [first, last] = spec |> String.split("-") |> Enum.map(&String.to_integer/1)
+          content_range = "bytes #{first}-#{last}/#{byte_size(body)}"
+          {206, binary_part(body, first, last - first + 1), [{"content-range", content_range}]}
+
+        {200, _ranges?, _range} ->
+          {200, body, []}
+
+        {status, _ranges?, _range} ->
+          {status, "", []}
+      end
+
+    headers =
+      [
+        {"content-length", byte_size(part)},
+        {"accept-ranges", if(ranges?, do: "bytes", else: "none")},
+        {"connection", "close"}
+      ] ++ extra_headers
+
+    response = [
+      "HTTP/1.1 #{status} #{reason(status)}\r\n",
+      Enum.map(headers, fn {key, value} -> "#{key}: #{value}\r\n" end),
+      "\r\n",
+      if(method == :HEAD, do: "", else: part)
+    ]
+
+    :ok = :gen_tcp.send(client, response)
+    :gen_tcp.close(client)
+  end
+
+  defp read_request(client) do
+    {:ok, {:http_request, method, _path, _version}} = :gen_tcp.recv(client, 0)
+    read_headers(client, method, %{})
+  end
+
+  defp read_headers(client, method, headers) do
+    case :gen_tcp.recv(client, 0) do
+      {:ok, {:http_header, _, name, _, value}} ->
+        name = name |> to_string() |> String.downcase()
+        read_headers(client, method, Map.put(headers, name, value))
+
+      {:ok, :http_eoh} ->
+        {method, headers}
+    end
+  end
+
+  defp reason(200), do: "OK"
+  defp reason(206), do: "Partial Content"
+  defp reason(404), do: "Not Found"
+  defp reason(_status), do: "Error"
+end
+
+defmodule XLA.TestArchive do
+  @moduledoc false
+
+  # Builds a gzipped tarball shaped like the XLA package, including a
+  # header with a path too long for the plain ustar name field.
+  def build(dir) do
+    long_dir = Path.join(["xla_extension", "include" | List.duplicate("nested_directory", 16)])
+
+    files = [
+      {"xla_extension/lib/libxla_extension.a", :crypto.strong_rand_bytes(300_000)},
+      {"xla_extension/lib/libxla_extension.link", "-lm\n"},
+      {Path.join(long_dir, "header.h"), "#pragma once\n"}
+    ]
+
+    path = Path.join(dir, "archive.tar.gz")
+    entries = for {name, content} <- files, do: {String.to_charlist(name), content}
+    :ok = :erl_tar.create(String.to_charlist(path), entries, [:compressed])
+
+    {File.read!(path), files}
+  end
+
+  def sha256(binary) do
+    :sha256 |> :crypto.hash(binary) |> Base.encode16(case: :lower)
+  end
+end
+
+ExUnit.start()
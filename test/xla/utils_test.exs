@@ -0,0 +1,71 @@
+defmodule XLA.UtilsTest do
+  use ExUnit.Case, async: false
+
+  alias XLA.{TestArchive, TestHTTPServer}
+
+  @moduletag :tmp_dir
+
+  setup do
+    XLA.Utils.start_inets_profile()
+    on_exit(fn -> XLA.Utils.stop_inets_profile() end)
+  end
+
+  test "downloads, checksums and extracts in a single request", %{tmp_dir: tmp_dir} do
+    {archive, files} = TestArchive.build(tmp_dir)
+    server = TestHTTPServer.start(archive)
+
+    path = Path.join(tmp_dir, "download.tar.gz")
+    dir = Path.join(tmp_dir, "extracted")
+
+    tee = %XLA.Tee{
+      collectables: [%XLA.Checksumer{}, %XLA.TarExtractor{dir: dir}, File.stream!(path)]
+    }
+
+    assert {:ok, [checksum, ^dir, _file]} = XLA.Utils.download(server.url, tee)
+    assert checksum == TestArchive.sha256(archive)
+    assert File.read!(path) == archive
+
+    for {name, content} <- files do
+      assert File.read!(Path.join(dir, name)) == content
+    end
+
+    assert TestHTTPServer.requests(server) == [{:GET, nil}]
+  end
+
+  test "downloads with parallel range requests", %{tmp_dir: tmp_dir} do
+    {archive, _files} = TestArchive.build(tmp_dir)
+    server = TestHTTPServer.start(archive)
+    path = Path.join(tmp_dir, "download.tar.gz")
+
+    assert :ok = XLA.Utils.download_ranges(server.url, path, 4)
+    assert File.read!(path) == archive
+
+    ranges = for {:GET, range} <- TestHTTPServer.requests(server), do: range
+    assert length(ranges) == 4
+    assert Enum.all?(ranges, &String.starts_with?(&1, "bytes="))
+  end
+
+  test "falls back to a single request without range support", %{tmp_dir: tmp_dir} do
+    {archive, _files} = TestArchive.build(tmp_dir)
+    server = TestHTTPServer.start(archive, ranges: false)
+    path = Path.join(tmp_dir, "download.tar.gz")
+
+    assert :ok = XLA.Utils.download_ranges(server.url, path, 4)
+    assert File.read!(path) == archive
+    assert TestHTTPServer.requests(server) == [{:HEAD, nil}, {:GET, nil}]
+  end
+
+  test "returns an error on HTTP errors", %{tmp_dir: tmp_dir} do
+    server = TestHTTPServer.start("", status: 404)
+    path = Path.join(tmp_dir, "download.tar.gz")
+
+    assert {:error, "got HTTP status 404"} = XLA.Utils.download(server.url, File.stream!(path))
+  end
+
+  test "extraction fails on a truncated archive", %{tmp_dir: tmp_dir} do
+    {archive, _files} = TestArchive.build(tmp_dir)
+    truncated = binary_part(archive, 0, div(byte_size(archive), 2))
+
+    assert catch_error(Enum.into([truncated], %XLA.TarExtractor{dir: tmp_dir}))
+  end
+end
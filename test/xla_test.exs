@@ -0,0 +1,102 @@
+defmodule XLATest do
+  use ExUnit.Case, async: false
+
+  alias XLA.{TestArchive, TestHTTPServer}
+
+  @moduletag :tmp_dir
+
+  @env_vars [
+    "XLA_BUILD",
+    "XLA_ARCHIVE_PATH",
+    "XLA_ARCHIVE_URL",
+    "XLA_CACHE_DIR",
+    "XLA_DOWNLOAD_CONNECTIONS",
+    "XLA_TARGET",
+    "XLA_TARGET_PLATFORM"
+  ]
+
+  setup %{tmp_dir: tmp_dir} do
+    previous = Map.new(@env_vars, &{&1, System.get_env(&1)})
+
+    on_exit(fn ->
+      for {name, value} <- previous do
+        if value, do: System.put_env(name, value), else: System.delete_env(name)
+      end
+
+      Application.delete_env(:xla, :release_base_url)
+      Application.delete_env(:xla, :checksum_path)
+    end)
+
+    Enum.each(@env_vars, &System.delete_env/1)
+    System.put_env("XLA_CACHE_DIR", Path.join(tmp_dir, "cache"))
+    # Never touch the checksum file of the project
+    Application.put_env(:xla, :checksum_path, Path.join(tmp_dir, "checksum.txt"))
+    :ok
+  end
+
+  describe "extract_archive!/1" do
+    test "downloads and extracts the archive in one pass", %{tmp_dir: tmp_dir} do
+      {archive, files} = TestArchive.build(tmp_dir)
+      server = TestHTTPServer.start(archive)
+      System.put_env("XLA_ARCHIVE_URL", server.url)
+
+      dir = Path.join(tmp_dir, "extracted")
+      assert XLA.extract_archive!(dir) == Path.join(dir, "xla_extension")
+
+      for {name, content} <- files do
+        assert File.read!(Path.join(dir, name)) == content
+      end
+
+      # The temporary extraction directory is gone
+      assert File.ls!(dir) == ["xla_extension"]
+      assert TestHTTPServer.requests(server) == [{:GET, nil}]
+
+      # The archive is cached, so extracting again does not download
+      other_dir = Path.join(tmp_dir, "extracted_again")
+      XLA.extract_archive!(other_dir)
+      assert File.read!(Path.join(other_dir, "xla_extension/lib/libxla_extension.link")) == "-lm\n"
+      assert length(TestHTTPServer.requests(server)) == 1
+    end
+
+    test "extracts after parallel range requests", %{tmp_dir: tmp_dir} do
+      {archive, files} = TestArchive.build(tmp_dir)
+      server = TestHTTPServer.start(archive)
+      System.put_env("XLA_ARCHIVE_URL", server.url)
+      System.put_env("XLA_DOWNLOAD_CONNECTIONS", "3")
+
+      dir = Path.join(tmp_dir, "extracted")
+      XLA.extract_archive!(dir)
+
+      for {name, content} <- files do
+        assert File.read!(Path.join(dir, name)) == content
+      end
+
+      assert length(for {:GET, "bytes=" <> _} <- TestHTTPServer.requests(server), do: 1) == 3
+    end
+
+    test "keeps the contents of target_dir when the checksum does not match",
+         %{tmp_dir: tmp_dir} do
+      {archive, _files} = TestArchive.build(tmp_dir)
+      server = TestHTTPServer.start(archive)
+      base_url = String.replace_suffix(server.url, "/xla_extension.tar.gz", "")
+      Application.put_env(:xla, :release_base_url, base_url)
+      System.put_env("XLA_TARGET_PLATFORM", "x86_64-linux-gnu")
+      System.put_env("XLA_TARGET", "cpu")
+
+      filename = XLA.archive_filename_with_target()
+      XLA.write_checksums!(%{filename => TestArchive.sha256("not the archive")})
+
+      dir = Path.join(tmp_dir, "extracted")
+      File.mkdir_p!(dir)
+      File.write!(Path.join(dir, "unrelated.txt"), "keep me")
+
+      assert_raise RuntimeError, ~r/the checksum does not match/, fn ->
+        XLA.extract_archive!(dir)
+      end
+
+      assert File.read!(Path.join(dir, "unrelated.txt")) == "keep me"
+      assert File.ls!(dir) == ["unrelated.txt"]
+      assert TestHTTPServer.requests(server) == [{:GET, nil}]
+    end
+  end
+end
@@ -0,0 +1,81 @@
+/**
+ * aot_run - Run an executable compiled ahead of time
+ *
+ * Runtime half of xla/extension/aot.h. Loads an artifact written by
+ * xla_aot, feeds its parameters with zeros and executes it, reporting
+ * how long each startup phase took on stderr. Uses only the load path,
+ * so it links against the runtime archive (XLA_LAYER=xla_runtime):
+ *
+ *   make aot_run XLA_LAYER=xla_runtime
+ *
+ * Usage:
+ *   aot_run <model.xla_aot> [iterations]
+ */
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/shape.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/aot.h"
+#include "xla/extension/spatial_kernel_handlers.h"
+#include "absl/strings/numbers.h"
+
+#include "bench_common.h"
+
+using namespace xla;
+using bench::CheckOr;
+using bench::Check;
+using bench::Clock;
+using bench::ElapsedNs;
+
+int main(int argc, char** argv) {
+    int iters = 1;
+    if (argc < 2 || argc > 3 || (argc == 3 && (!absl::SimpleAtoi(argv[2], &iters) || iters < 1))) {
+        std::cerr << "Usage: aot_run <model.xla_aot> [iterations]" << std::endl;
+        return 2;
+    }
+    // Artifacts may call the spatial kernels, which nothing else registers here
+    xla::extension::RegisterSpatialKernels();
+
+    auto start = Clock::now();
+    auto client = CheckOr(GetPjRtCpuClient(CpuClientOptions()), "Creating CPU client");
+    double client_ms = ElapsedNs(start) / 1e6;
+
+    start = Clock::now();
+    auto artifact = CheckOr(xla::extension::ReadAotArtifact(argv[1]), "Reading artifact");
+    auto executable = CheckOr(xla::extension::LoadAotExecutable(client.get(), artifact),
+                              "Loading executable");
+    double load_ms = ElapsedNs(start) / 1e6;
+
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+    std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+    std::vector<PjRtBuffer*> arguments;
+    for (const Shape& shape : artifact.program_shape.parameters()) {
+        Literal zeros = Literal::CreateFromShape(shape);
+        buffers.push_back(CheckOr(client->BufferFromHostLiteral(zeros, memory_space),
+                                  "Transferring input"));
+        arguments.push_back(buffers.back().get());
+    }
+    std::vector<std::vector<PjRtBuffer*>> argument_handles = {arguments};
+    ExecuteOptions execute_options;
+
+    double first_ms = 0;
+    for (int i = 0; i < iters; i++) {
+        start = Clock::now();
+        auto results = CheckOr(executable->Execute(argument_handles, execute_options), "Executing");
+        for (auto& result : results[0]) Check(result->GetReadyFuture().Await(), "Waiting for outputs");
+        if (i == 0) first_ms = ElapsedNs(start) / 1e6;
+    }
+
+    std::cerr << "client " << client_ms << " ms, load " << load_ms << " ms, first execution "
+              << first_ms << " ms, startup " << client_ms + load_ms + first_ms << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,69 @@
+/**
+ * Heap allocation counter for the benchmarks.
+ *
+ * Replaces the global operator new/delete to count allocations made by
+ * the benchmark and by XLA itself (the static archive shares the same
+ * operator new). Include it from exactly one translation unit.
+ *
+ * Note that XLA allocates large tensor storage with aligned malloc,
+ * which bypasses operator new, so the counter covers the bookkeeping
+ * (buffers, literals, futures, shapes) rather than raw tensor bytes.
+ */
+
+#ifndef XLA_TEST_STATIC_LIB_BENCH_ALLOC_COUNTER_H_
+#define XLA_TEST_STATIC_LIB_BENCH_ALLOC_COUNTER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace bench {
+
+inline std::atomic<int64_t> g_allocations{0};
+inline std::atomic<int64_t> g_allocated_bytes{0};
+
+struct AllocationSnapshot {
+    int64_t allocations;
+    int64_t bytes;
+};
+
+inline AllocationSnapshot Allocations() {
+    return {g_allocations.load(std::memory_order_relaxed),
+            g_allocated_bytes.load(std::memory_order_relaxed)};
+}
+
+inline void* CountedAlloc(size_t size, size_t alignment) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+    void* ptr = nullptr;
+    if (alignment <= alignof(std::max_align_t)) {
+        ptr = std::malloc(size == 0 ? 1 : size);
+    } else if (posix_memalign(&ptr, alignment, size == 0 ? 1 : size) != 0) {
+        ptr = nullptr;
+    }
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+}  // namespace bench
+
+void* operator new(size_t size) { return bench::CountedAlloc(size, 0); }
+void* operator new[](size_t size) { return bench::CountedAlloc(size, 0); }
+void* operator new(size_t size, std::align_val_t al) {
+    return bench::CountedAlloc(size, static_cast<size_t>(al));
+}
+void* operator new[](size_t size, std::align_val_t al) {
+    return bench::CountedAlloc(size, static_cast<size_t>(al));
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+#endif  // XLA_TEST_STATIC_LIB_BENCH_ALLOC_COUNTER_H_
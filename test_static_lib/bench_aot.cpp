@@ -0,0 +1,143 @@
+/**
+ * XLA Ahead-of-Time Startup Benchmark
+ *
+ * Time from process start to the first result for MLPs of 2, 8 and 32
+ * tanh(x @ w) layers of width 256, on two paths:
+ *
+ *   compile_at_start  create the client, CompileAndLoad, execute once
+ *   load_aot          create the client, read and load an artifact of
+ *                     xla/extension/aot.h, execute once
+ *
+ * Reported phases are `prepare` (CompileAndLoad or read and load) and
+ * `startup` (client creation through the first result), with the size of
+ * the artifact. Binary size of a load-only program is measured by
+ * `make aot-report` instead.
+ *
+ * Environment overrides:
+ *   BENCH_COMPILE_ITERS - startups per path and model (default 5)
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/aot.h"
+
+#include "bench_common.h"
+
+using namespace xla;
+using bench::CheckOr;
+using bench::Check;
+using bench::Clock;
+using bench::ElapsedNs;
+
+namespace {
+
+constexpr int64_t kWidth = 256;
+
+XlaComputation BuildMlp(int layers) {
+    XlaBuilder builder("mlp");
+    Shape shape = ShapeUtil::MakeShape(F32, {kWidth, kWidth});
+    XlaOp x = Parameter(&builder, 0, shape, "x");
+    for (int i = 0; i < layers; i++) {
+        x = Tanh(Dot(x, Parameter(&builder, i + 1, shape, "w" + std::to_string(i))));
+    }
+    return CheckOr(builder.Build(), "Building MLP");
+}
+
+// Feeds the parameters with zeros and waits for the first result
+void ExecuteOnce(PjRtClient* client, PjRtLoadedExecutable* executable, int parameters) {
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+    Literal zeros = Literal::CreateFromShape(ShapeUtil::MakeShape(F32, {kWidth, kWidth}));
+    std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+    std::vector<PjRtBuffer*> arguments;
+    for (int i = 0; i < parameters; i++) {
+        buffers.push_back(CheckOr(client->BufferFromHostLiteral(zeros, memory_space),
+                                  "Transferring input"));
+        arguments.push_back(buffers.back().get());
+    }
+    std::vector<std::vector<PjRtBuffer*>> argument_handles = {arguments};
+    ExecuteOptions execute_options;
+    auto results = CheckOr(executable->Execute(argument_handles, execute_options), "Executing");
+    Check(results[0][0]->GetReadyFuture().Await(), "Waiting for result");
+}
+
+}  // namespace
+
+int main() {
+    const int iters = bench::EnvInt("BENCH_COMPILE_ITERS", 5);
+
+    std::cerr << "========================================" << std::endl;
+    std::cerr << "XLA Ahead-of-Time Startup Benchmark" << std::endl;
+    std::cerr << "========================================" << std::endl;
+
+    bench::Report report("aot");
+    const std::string path = "bench_aot_model.xla_aot";
+
+    for (int layers : {2, 8, 32}) {
+        XlaComputation mlp = BuildMlp(layers);
+        const std::string model = "mlp_" + std::to_string(layers);
+        CompileOptions compile_options;
+
+        // The build step, not part of startup
+        {
+            auto client = CheckOr(GetPjRtCpuClient(CpuClientOptions()), "Creating CPU client");
+            auto artifact = CheckOr(xla::extension::CompileForExport(client.get(), mlp,
+                                                                     compile_options, {}),
+                                    "Compiling for export");
+            Check(xla::extension::WriteAotArtifact(path, artifact), "Writing artifact");
+        }
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        std::fseek(file, 0, SEEK_END);
+        const double artifact_bytes = static_cast<double>(std::ftell(file));
+        std::fclose(file);
+
+        std::vector<double> compile_prepare, compile_startup, load_prepare, load_startup;
+        for (int i = 0; i < iters; i++) {
+            {
+                auto start = Clock::now();
+                auto client = CheckOr(GetPjRtCpuClient(CpuClientOptions()), "Creating CPU client");
+                auto prepare = Clock::now();
+                auto executable = CheckOr(client->CompileAndLoad(mlp, compile_options), "Compiling");
+                compile_prepare.push_back(ElapsedNs(prepare));
+                ExecuteOnce(client.get(), executable.get(), layers + 1);
+                compile_startup.push_back(ElapsedNs(start));
+            }
+            {
+                auto start = Clock::now();
+                auto client = CheckOr(GetPjRtCpuClient(CpuClientOptions()), "Creating CPU client");
+                auto prepare = Clock::now();
+                auto artifact = CheckOr(xla::extension::ReadAotArtifact(path), "Reading artifact");
+                auto executable = CheckOr(xla::extension::LoadAotExecutable(client.get(), artifact),
+                                          "Loading");
+                load_prepare.push_back(ElapsedNs(prepare));
+                ExecuteOnce(client.get(), executable.get(), layers + 1);
+                load_startup.push_back(ElapsedNs(start));
+            }
+        }
+
+        report.Add({{"model", model}, {"path", "compile_at_start"}, {"phase", "prepare"}},
+                   compile_prepare);
+        report.Add({{"model", model}, {"path", "compile_at_start"}, {"phase", "startup"}},
+                   compile_startup);
+        report.Add({{"model", model}, {"path", "load_aot"}, {"phase", "prepare"}}, load_prepare,
+                   {{"artifact_bytes", artifact_bytes}});
+        report.Add({{"model", model}, {"path", "load_aot"}, {"phase", "startup"}}, load_startup,
+                   {{"artifact_bytes", artifact_bytes}});
+    }
+
+    std::remove(path.c_str());
+    report.Print();
+    return 0;
+}
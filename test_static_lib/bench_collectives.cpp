@@ -0,0 +1,168 @@
+/**
+ * XLA Multi-Process Collectives Benchmark
+ *
+ * Forks a group of processes on localhost, each with a single-device CPU
+ * client joined through xla/extension/multi_process.h, and times
+ * cross-process all-reduce and all-gather of f32 messages from 4 bytes
+ * up to BENCH_MAX_BYTES, growing by 16x. Every sample is one execution,
+ * waited for on the host, so small messages measure latency and large
+ * ones bandwidth.
+ *
+ * Reports, next to the latency, `algbw_gbps` (message bytes per second)
+ * and `busbw_gbps`, the algorithm bandwidth scaled by 2(n-1)/n for
+ * all-reduce and (n-1)/n for all-gather, which is comparable across
+ * process counts. Only process 0 prints.
+ *
+ * Environment overrides:
+ *   BENCH_ITERS     - samples per case (default 50)
+ *   BENCH_PROCESSES - processes in the group (default 2)
+ *   BENCH_MAX_BYTES - largest message (default 64 MiB)
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/literal.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/multi_process.h"
+
+#include "bench_common.h"
+
+using namespace xla;
+using bench::CheckOr;
+using bench::Check;
+using bench::Clock;
+using bench::ElapsedNs;
+using namespace xla::extension;
+
+namespace {
+
+int FreePort() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        std::cerr << "ERROR: no free port" << std::endl;
+        exit(1);
+    }
+    close(fd);
+    return ntohs(addr.sin_port);
+}
+
+XlaComputation BuildCollective(const std::string& op, int64_t elements, int processes) {
+    XlaBuilder builder(op);
+    auto x = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {elements}), "x");
+    if (op == "all_reduce") {
+        CrossReplicaSum(x);
+    } else {
+        AllGather(x, /*all_gather_dimension=*/0, /*shard_count=*/processes);
+    }
+    return CheckOr(builder.Build(), "Building " + op);
+}
+
+void RunProcess(int process_id, int processes, const std::string& address, int iters,
+                int64_t max_bytes) {
+    MultiProcessOptions options;
+    options.coordinator_address = address;
+    options.num_processes = processes;
+    options.process_id = process_id;
+    auto group = CheckOr(MultiProcessCpuClient::Create(options), "Joining the group");
+    PjRtClient* client = group->client();
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+    auto compile_options = CheckOr(MultiProcessCompileOptions(client), "Getting compile options");
+    ExecuteOptions execute_options;
+
+    bench::Report report("collectives");
+    report.SetInfo("processes", std::to_string(processes));
+
+    for (const std::string op : {"all_reduce", "all_gather"}) {
+        for (int64_t bytes = 4; bytes <= max_bytes; bytes *= 16) {
+            const int64_t elements = bytes / sizeof(float);
+            auto executable = CheckOr(
+                client->CompileAndLoad(BuildCollective(op, elements, processes), compile_options),
+                "Compiling " + op);
+            Literal input(ShapeUtil::MakeShape(F32, {elements}));
+            input.PopulateWithValue(1.0f);
+            auto x = CheckOr(client->BufferFromHostLiteral(input, memory_space), "Transferring");
+            Check(x->GetReadyFuture().Await(), "Waiting for input");
+            std::vector<std::vector<PjRtBuffer*>> argument_handles = {{x.get()}};
+
+            // Warmup, which also connects the Gloo pairs
+            for (int i = 0; i < 3; i++) {
+                auto results = CheckOr(executable->Execute(argument_handles, execute_options),
+                                       "Executing");
+                Check(results[0][0]->GetReadyFuture().Await(), "Waiting for " + op);
+            }
+            std::vector<double> samples;
+            for (int i = 0; i < iters; i++) {
+                auto start = Clock::now();
+                auto results = CheckOr(executable->Execute(argument_handles, execute_options),
+                                       "Executing");
+                Check(results[0][0]->GetReadyFuture().Await(), "Waiting for " + op);
+                samples.push_back(ElapsedNs(start));
+            }
+            if (process_id != 0) continue;
+
+            const double algbw = bytes / bench::Summarize(samples).p50_ns;
+            const double factor = (op == "all_reduce" ? 2.0 : 1.0) * (processes - 1) / processes;
+            report.Add({{"op", op}, {"bytes", std::to_string(bytes)}}, samples,
+                       {{"algbw_gbps", algbw}, {"busbw_gbps", algbw * factor}});
+        }
+    }
+
+    if (process_id == 0) report.Print();
+}
+
+}  // namespace
+
+int main() {
+    const int iters = bench::EnvInt("BENCH_ITERS", 50);
+    const int processes = bench::EnvInt("BENCH_PROCESSES", 2);
+    const int64_t max_bytes = bench::EnvInt("BENCH_MAX_BYTES", 64 << 20);
+
+    std::cerr << "========================================" << std::endl;
+    std::cerr << "XLA Multi-Process Collectives Benchmark" << std::endl;
+    std::cerr << "========================================" << std::endl;
+
+    // Fork before any XLA threads exist
+    const std::string address = "localhost:" + std::to_string(FreePort());
+    std::vector<pid_t> children;
+    for (int process_id = 0; process_id < processes; process_id++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            RunProcess(process_id, processes, address, iters, max_bytes);
+            std::cout.flush();
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    int failures = 0;
+    for (pid_t pid : children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) failures++;
+    }
+    if (failures > 0) {
+        std::cerr << "ERROR: " << failures << " processes failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,187 @@
+/**
+ * Shared helpers for the XLA static library benchmarks.
+ *
+ * Every bench_*.cpp program collects wall-clock samples per measured
+ * phase and prints a single JSON document on stdout, so results can be
+ * diffed between XLA revisions (see OPENXLA_GIT_REV in the top-level
+ * Makefile). Human-readable progress goes to stderr.
+ */
+
+#ifndef XLA_TEST_STATIC_LIB_BENCH_COMMON_H_
+#define XLA_TEST_STATIC_LIB_BENCH_COMMON_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+// Helper function to check StatusOr and exit on error
+template<typename T>
+T CheckOr(absl::StatusOr<T> status_or, const std::string& context) {
+    if (!status_or.ok()) {
+        std::cerr << "ERROR in " << context << ": "
+                  << status_or.status().message() << std::endl;
+        exit(1);
+    }
+    return std::move(status_or).value();
+}
+
+// Helper function to check Status and exit on error
+inline void Check(const absl::Status& status, const std::string& context) {
+    if (!status.ok()) {
+        std::cerr << "ERROR in " << context << ": "
+                  << status.message() << std::endl;
+        exit(1);
+    }
+}
+
+// Returns elapsed nanoseconds since `start`
+inline double ElapsedNs(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// Reads an integer override from the environment (e.g. BENCH_ITERS)
+inline int64_t EnvInt(const char* name, int64_t default_value) {
+    const char* value = std::getenv(name);
+    if (value == nullptr || *value == '\0') return default_value;
+    return std::strtoll(value, nullptr, 10);
+}
+
+struct Summary {
+    int64_t count = 0;
+    double mean_ns = 0;
+    double p50_ns = 0;
+    double p99_ns = 0;
+    double min_ns = 0;
+    double max_ns = 0;
+    double ops_per_sec = 0;
+};
+
+inline double Percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+inline Summary Summarize(std::vector<double> samples_ns) {
+    Summary summary;
+    if (samples_ns.empty()) return summary;
+    std::sort(samples_ns.begin(), samples_ns.end());
+    double total = 0;
+    for (double s : samples_ns) total += s;
+    summary.count = static_cast<int64_t>(samples_ns.size());
+    summary.mean_ns = total / samples_ns.size();
+    summary.p50_ns = Percentile(samples_ns, 0.50);
+    summary.p99_ns = Percentile(samples_ns, 0.99);
+    summary.min_ns = samples_ns.front();
+    summary.max_ns = samples_ns.back();
+    summary.ops_per_sec = summary.mean_ns > 0 ? 1e9 / summary.mean_ns : 0;
+    return summary;
+}
+
+inline std::string JsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            default: out += c;
+        }
+    }
+    return out;
+}
+
+// One measured phase of one benchmark case. `labels` are string
+// parameters (op, phase, dtype) and `metrics` are extra numeric values
+// (bytes, flops, allocations) reported next to the timing summary.
+struct Result {
+    std::map<std::string, std::string> labels;
+    std::map<std::string, double> metrics;
+    Summary summary;
+};
+
+// Collects results and writes them as one JSON document
+class Report {
+ public:
+    explicit Report(std::string suite) : suite_(std::move(suite)) {}
+
+    void SetInfo(const std::string& key, const std::string& value) {
+        info_[key] = value;
+    }
+
+    Result& Add(std::map<std::string, std::string> labels,
+                const std::vector<double>& samples_ns,
+                std::map<std::string, double> metrics = {}) {
+        Result result;
+        result.labels = std::move(labels);
+        result.metrics = std::move(metrics);
+        result.summary = Summarize(samples_ns);
+        results_.push_back(std::move(result));
+
+        const Result& r = results_.back();
+        std::cerr << "  ";
+        for (const auto& [key, value] : r.labels) {
+            std::cerr << key << "=" << value << " ";
+        }
+        std::cerr << "p50=" << r.summary.p50_ns / 1e3 << "us"
+                  << " p99=" << r.summary.p99_ns / 1e3 << "us"
+                  << " ops/s=" << r.summary.ops_per_sec << std::endl;
+        return results_.back();
+    }
+
+    void Print(std::ostream& os = std::cout) const {
+        os << "{\"suite\": \"" << JsonEscape(suite_) << "\"";
+        for (const auto& [key, value] : info_) {
+            os << ", \"" << JsonEscape(key) << "\": \"" << JsonEscape(value) << "\"";
+        }
+        os << ", \"results\": [";
+        for (size_t i = 0; i < results_.size(); i++) {
+            const Result& r = results_[i];
+            os << (i == 0 ? "\n  {" : ",\n  {");
+            bool first = true;
+            for (const auto& [key, value] : r.labels) {
+                os << (first ? "" : ", ") << "\"" << JsonEscape(key) << "\": \""
+                   << JsonEscape(value) << "\"";
+                first = false;
+            }
+            for (const auto& [key, value] : r.metrics) {
+                os << (first ? "" : ", ") << "\"" << JsonEscape(key) << "\": " << value;
+                first = false;
+            }
+            os << (first ? "" : ", ")
+               << "\"count\": " << r.summary.count
+               << ", \"mean_ns\": " << r.summary.mean_ns
+               << ", \"p50_ns\": " << r.summary.p50_ns
+               << ", \"p99_ns\": " << r.summary.p99_ns
+               << ", \"min_ns\": " << r.summary.min_ns
+               << ", \"max_ns\": " << r.summary.max_ns
+               << ", \"ops_per_sec\": " << r.summary.ops_per_sec << "}";
+        }
+        os << "\n]}" << std::endl;
+    }
+
+    const std::vector<Result>& results() const { return results_; }
+
+ private:
+    std::string suite_;
+    std::map<std::string, std::string> info_;
+    std::vector<Result> results_;
+};
+
+}  // namespace bench
+
+#endif  // XLA_TEST_STATIC_LIB_BENCH_COMMON_H_
@@ -0,0 +1,275 @@
+/**
+ * XLA Concurrent Client Benchmark
+ *
+ * Many threads sharing one PjRtClient, as in a server: every worker
+ * thread executes a small computation (dispatch-bound, a 32x32 matmul)
+ * in a loop and waits for its result, while I/O threads (one per four
+ * workers) keep transferring 64 KiB literals with BufferFromHostLiteral.
+ * Cases cover
+ *
+ *   mode         sync or async client (CpuClientOptions::asynchronous)
+ *   executables  shared (one executable for all threads) or separate
+ *                (one per thread)
+ *   threads      1, 2, 4, ... up to BENCH_MAX_THREADS
+ *
+ * and report per-execution latency with `executions_per_sec`,
+ * `scaling_efficiency` (throughput over threads x the 1-thread
+ * throughput of the same mode) and `io_transfers_per_sec`.
+ *
+ * To find where dispatch stops scaling, each mode is also profiled at 1
+ * and at the largest thread count with shared executables
+ * (xla/extension/profiler.h, PjRt client events only). The events whose
+ * mean duration grows the most are reported as phase=hotspot rows with
+ * `mean_ns_1_thread`, `inflation` (mean at N threads over mean at 1) and
+ * `extra_ns` (total time added by the growth), lock waits show up as
+ * inflated client events rather than as compute.
+ *
+ * Environment overrides:
+ *   BENCH_ITERS       - executions per worker thread (default 200)
+ *   BENCH_MAX_THREADS - largest thread count (default 64)
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/profiler.h"
+
+#include "bench_common.h"
+
+using namespace xla;
+using bench::CheckOr;
+using bench::Check;
+using bench::Clock;
+using bench::ElapsedNs;
+
+namespace {
+
+constexpr int64_t kSize = 32;
+constexpr int kHotspots = 10;
+
+XlaComputation BuildStep() {
+    XlaBuilder builder("step");
+    auto x = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {kSize, kSize}), "x");
+    Tanh(Dot(x, x));
+    return CheckOr(builder.Build(), "Building step");
+}
+
+struct CaseResult {
+    std::vector<double> latencies_ns;
+    double wall_ns = 0;
+    int64_t transfers = 0;
+};
+
+// Runs `executables.size()` worker threads and their I/O threads
+CaseResult RunCase(PjRtClient* client, const std::vector<PjRtLoadedExecutable*>& executables,
+                   PjRtBuffer* input, const Literal& io_literal, int iters) {
+    const int threads = executables.size();
+    const int io_threads = std::max(1, threads / 4);
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::atomic<bool> done{false};
+    std::atomic<int64_t> transfers{0};
+    std::vector<std::vector<double>> latencies(threads);
+    auto wait_for_go = [&] {
+        ready++;
+        while (!go.load()) std::this_thread::yield();
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            std::vector<std::vector<PjRtBuffer*>> argument_handles = {{input}};
+            ExecuteOptions execute_options;
+            latencies[t].reserve(iters);
+            wait_for_go();
+            for (int i = 0; i < iters; i++) {
+                auto start = Clock::now();
+                auto results = CheckOr(executables[t]->Execute(argument_handles, execute_options),
+                                       "Executing");
+                Check(results[0][0]->GetReadyFuture().Await(), "Waiting for result");
+                latencies[t].push_back(ElapsedNs(start));
+            }
+        });
+    }
+    std::vector<std::thread> io;
+    for (int t = 0; t < io_threads; t++) {
+        io.emplace_back([&] {
+            wait_for_go();
+            while (!done.load()) {
+                auto buffer = CheckOr(client->BufferFromHostLiteral(io_literal, memory_space),
+                                      "Transferring");
+                Check(buffer->GetReadyFuture().Await(), "Waiting for transfer");
+                transfers++;
+            }
+        });
+    }
+
+    while (ready.load() < threads + io_threads) std::this_thread::yield();
+    auto start = Clock::now();
+    go = true;
+    for (auto& worker : workers) worker.join();
+    CaseResult result;
+    result.wall_ns = ElapsedNs(start);
+    done = true;
+    for (auto& thread : io) thread.join();
+
+    result.transfers = transfers.load();
+    for (auto& thread_latencies : latencies) {
+        result.latencies_ns.insert(result.latencies_ns.end(), thread_latencies.begin(),
+                                   thread_latencies.end());
+    }
+    return result;
+}
+
+// Durations of host events by name
+std::map<std::string, std::vector<double>> EventDurations(const tensorflow::profiler::XSpace& space) {
+    std::map<std::string, std::vector<double>> durations;
+    for (const auto& plane : space.planes()) {
+        for (const auto& line : plane.lines()) {
+            for (const auto& event : line.events()) {
+                auto it = plane.event_metadata().find(event.metadata_id());
+                if (it == plane.event_metadata().end()) continue;
+                durations[it->second.name()].push_back(event.duration_ps() / 1e3);
+            }
+        }
+    }
+    return durations;
+}
+
+std::map<std::string, std::vector<double>> ProfileCase(
+    PjRtClient* client, const std::vector<PjRtLoadedExecutable*>& executables, PjRtBuffer* input,
+    const Literal& io_literal, int iters) {
+    xla::extension::ProfilerOptions options;
+    options.host_tracer_level = 1;
+    auto session = CheckOr(xla::extension::ProfilerSession::Start(options), "Starting profiler");
+    RunCase(client, executables, input, io_literal, iters);
+    return EventDurations(CheckOr(session->Stop(), "Stopping profiler"));
+}
+
+double Mean(const std::vector<double>& values) {
+    double sum = 0;
+    for (double v : values) sum += v;
+    return values.empty() ? 0 : sum / values.size();
+}
+
+}  // namespace
+
+int main() {
+    const int iters = bench::EnvInt("BENCH_ITERS", 200);
+    const int max_threads = bench::EnvInt("BENCH_MAX_THREADS", 64);
+
+    std::cerr << "========================================" << std::endl;
+    std::cerr << "XLA Concurrent Client Benchmark" << std::endl;
+    std::cerr << "========================================" << std::endl;
+
+    bench::Report report("concurrency");
+    report.SetInfo("hardware_concurrency", std::to_string(std::thread::hardware_concurrency()));
+
+    auto computation = BuildStep();
+    Literal input_literal(ShapeUtil::MakeShape(F32, {kSize, kSize}));
+    input_literal.PopulateWithValue(0.01f);
+    Literal io_literal(ShapeUtil::MakeShape(F32, {16 << 10}));
+    io_literal.PopulateWithValue(1.0f);
+
+    for (bool asynchronous : {false, true}) {
+        const std::string mode = asynchronous ? "async" : "sync";
+        CpuClientOptions options;
+        options.asynchronous = asynchronous;
+        auto client = CheckOr(GetPjRtCpuClient(options), "Creating CPU client");
+        auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                    "Getting memory space");
+        auto input = CheckOr(client->BufferFromHostLiteral(input_literal, memory_space),
+                             "Transferring input");
+        Check(input->GetReadyFuture().Await(), "Waiting for input");
+
+        // One executable per thread of the largest case, the first is shared
+        CompileOptions compile_options;
+        std::vector<std::unique_ptr<PjRtLoadedExecutable>> compiled;
+        for (int t = 0; t < max_threads; t++) {
+            compiled.push_back(CheckOr(client->CompileAndLoad(computation, compile_options),
+                                       "Compiling"));
+        }
+
+        for (bool shared : {true, false}) {
+            double single_thread_throughput = 0;
+            for (int threads = 1; threads <= max_threads; threads *= 2) {
+                std::cerr << mode << " " << (shared ? "shared" : "separate") << " threads="
+                          << threads << "..." << std::endl;
+                std::vector<PjRtLoadedExecutable*> executables;
+                for (int t = 0; t < threads; t++) {
+                    executables.push_back(compiled[shared ? 0 : t].get());
+                }
+                CaseResult result = RunCase(client.get(), executables, input.get(), io_literal,
+                                            iters);
+
+                const double throughput = result.latencies_ns.size() * 1e9 / result.wall_ns;
+                if (threads == 1) single_thread_throughput = throughput;
+                report.Add({{"mode", mode},
+                            {"executables", shared ? "shared" : "separate"},
+                            {"threads", std::to_string(threads)}},
+                           result.latencies_ns,
+                           {{"executions_per_sec", throughput},
+                            {"scaling_efficiency", throughput / (single_thread_throughput * threads)},
+                            {"io_transfers_per_sec", result.transfers * 1e9 / result.wall_ns}});
+            }
+        }
+
+        // Hotspots: client events inflated at the largest thread count
+        std::cerr << mode << " profiling..." << std::endl;
+        const int profile_iters = std::min(iters, 50);
+        auto single = ProfileCase(client.get(), {compiled[0].get()}, input.get(), io_literal,
+                                  profile_iters);
+        auto many = ProfileCase(client.get(),
+                                std::vector<PjRtLoadedExecutable*>(max_threads, compiled[0].get()),
+                                input.get(), io_literal, profile_iters);
+
+        struct Hotspot {
+            std::string event;
+            double mean_ns_1_thread;
+            double inflation;
+            double extra_ns;
+        };
+        std::vector<Hotspot> hotspots;
+        for (const auto& [event, durations] : many) {
+            auto it = single.find(event);
+            if (it == single.end()) continue;
+            const double before = Mean(it->second);
+            const double after = Mean(durations);
+            if (before <= 0) continue;
+            hotspots.push_back({event, before, after / before,
+                                (after - before) * durations.size()});
+        }
+        std::sort(hotspots.begin(), hotspots.end(),
+                  [](const Hotspot& a, const Hotspot& b) { return a.extra_ns > b.extra_ns; });
+        if (hotspots.size() > static_cast<size_t>(kHotspots)) hotspots.resize(kHotspots);
+        for (const Hotspot& hotspot : hotspots) {
+            report.Add({{"mode", mode}, {"phase", "hotspot"}, {"event", hotspot.event},
+                        {"threads", std::to_string(max_threads)}},
+                       many[hotspot.event],
+                       {{"mean_ns_1_thread", hotspot.mean_ns_1_thread},
+                        {"inflation", hotspot.inflation},
+                        {"extra_ns", hotspot.extra_ns}});
+        }
+    }
+
+    report.Print();
+    return 0;
+}
@@ -0,0 +1,145 @@
+/**
+ * XLA CPU Placement Benchmark
+ *
+ * Step latency distribution of a small model, `tanh(x @ w) + b` on
+ * 256x256 F32 inputs, on the default CPU client and on clients placed
+ * with xla/extension/cpu_affinity.h:
+ *
+ *   default        GetPjRtCpuClient, threads float across all CPUs
+ *   node<N>        worker threads, feeding thread and memory on NUMA node N
+ *   node0_half     node 0 with the intra-op pool on half of its CPUs
+ *
+ * Reports p99.9 and p99/p50 next to the usual latency summary, the
+ * spread that cross-socket migrations show up in.
+ *
+ * Environment overrides:
+ *   BENCH_ITERS - timed steps per case (default 2000)
+ *   BENCH_SIZE  - matrix size (default 256)
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/cpu_affinity.h"
+
+#include "bench_common.h"
+
+using namespace xla;
+using bench::CheckOr;
+using bench::Check;
+using bench::Clock;
+using bench::ElapsedNs;
+using xla::extension::CpuPlacement;
+
+namespace {
+
+struct Case {
+    std::string name;
+    bool placed;
+    CpuPlacement placement;
+};
+
+std::vector<double> RunCase(const Case& c, int64_t n, int iters) {
+    if (c.placed) Check(xla::extension::PlaceCurrentThread(c.placement), "Placing the feeding thread");
+
+    CpuClientOptions options;
+    options.asynchronous = true;
+    auto client = CheckOr(c.placed ? xla::extension::GetPlacedCpuClient(options, c.placement)
+                                   : GetPjRtCpuClient(options),
+                          "Creating CPU client");
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+
+    XlaBuilder builder("step");
+    Shape shape = ShapeUtil::MakeShape(F32, {n, n});
+    auto x = Parameter(&builder, 0, shape, "x");
+    auto w = Parameter(&builder, 1, shape, "w");
+    auto b = Parameter(&builder, 2, shape, "b");
+    Add(Tanh(Dot(x, w)), b);
+    auto computation = CheckOr(builder.Build(), "Building computation");
+    CompileOptions compile_options;
+    auto executable = CheckOr(client->CompileAndLoad(computation, compile_options), "Compiling");
+
+    // Inputs are created on the feeding thread, so they are node-local
+    // when it is placed
+    std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+    for (int k = 0; k < 3; k++) {
+        Literal literal(shape);
+        auto data = literal.data<float>();
+        for (size_t i = 0; i < data.size(); i++) data[i] = 0.001f * ((i + k) % 101);
+        buffers.push_back(CheckOr(client->BufferFromHostLiteral(literal, memory_space),
+                                  "Transferring input"));
+    }
+    std::vector<std::vector<PjRtBuffer*>> argument_handles = {
+        {buffers[0].get(), buffers[1].get(), buffers[2].get()}};
+    ExecuteOptions execute_options;
+
+    std::vector<double> samples;
+    for (int i = 0; i < iters + 10; i++) {
+        auto start = Clock::now();
+        auto results = CheckOr(executable->Execute(argument_handles, execute_options), "Executing");
+        Check(results[0][0]->GetReadyFuture().Await(), "Waiting for result");
+        // The first steps warm up the thread pools
+        if (i >= 10) samples.push_back(ElapsedNs(start));
+    }
+    return samples;
+}
+
+}  // namespace
+
+int main() {
+    const int iters = bench::EnvInt("BENCH_ITERS", 2000);
+    const int64_t n = bench::EnvInt("BENCH_SIZE", 256);
+
+    std::cerr << "========================================" << std::endl;
+    std::cerr << "XLA CPU Placement Benchmark" << std::endl;
+    std::cerr << "========================================" << std::endl;
+
+    const int nodes = xla::extension::NumaNodeCount();
+    bench::Report report("cpu_affinity");
+    report.SetInfo("numa_nodes", std::to_string(nodes));
+
+    std::vector<Case> cases = {{"default", false, {}}};
+    for (int node = 0; node < nodes; node++) {
+        auto cpus = xla::extension::NumaNodeCpus(node);
+        if (!cpus.ok()) continue;
+        CpuPlacement placement;
+        placement.numa_node = node;
+        cases.push_back({"node" + std::to_string(node), true, placement});
+        if (node == 0 && cpus->size() > 1) {
+            placement.intra_op_threads = static_cast<int>(cpus->size() / 2);
+            cases.push_back({"node0_half", true, placement});
+        }
+    }
+
+    for (const Case& c : cases) {
+        // A fresh thread per case, so that placing it does not leak into
+        // the next case
+        std::vector<double> samples;
+        std::thread runner([&] { samples = RunCase(c, n, iters); });
+        runner.join();
+
+        std::vector<double> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+        bench::Summary summary = bench::Summarize(samples);
+        report.Add({{"placement", c.name}, {"size", std::to_string(n)}}, samples,
+                   {{"p999_ns", bench::Percentile(sorted, 0.999)},
+                    {"p99_over_p50", summary.p50_ns > 0 ? summary.p99_ns / summary.p50_ns : 0},
+                    {"intra_op_threads", static_cast<double>(c.placement.intra_op_threads)}});
+    }
+
+    report.Print();
+    return 0;
+}
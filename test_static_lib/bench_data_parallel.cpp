@@ -0,0 +1,132 @@
+/**
+ * XLA Data-Parallel Scaling Benchmark
+ *
+ * Runs a batch of independent simulation steps as replicas on 1, 2, 4, 8
+ * and 16 CPU devices of a single client and reports throughput
+ * (replica-steps per second) and scaling efficiency relative to one
+ * device. Each step includes a cross-replica all-reduce of a scalar, as a
+ * batch-wide statistic would.
+ *
+ * Environment overrides:
+ *   BENCH_STEPS       - timed steps per device count (default 200)
+ *   BENCH_MAX_DEVICES - largest device count (default 16)
+ *   BENCH_STATE       - f32 elements of per-replica state (default 64K)
+ */
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/data_parallel.h"
+#include "xla/extension/host_buffer.h"
+
+#include "bench_common.h"
+
+using namespace xla;
+using bench::CheckOr;
+using bench::Check;
+using bench::Clock;
+using bench::ElapsedNs;
+using namespace xla::extension;
+
+namespace {
+
+XlaComputation ScalarAdd() {
+    XlaBuilder builder("scalar_add");
+    auto p0 = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {}), "p0");
+    auto p1 = Parameter(&builder, 1, ShapeUtil::MakeShape(F32, {}), "p1");
+    Add(p0, p1);
+    return CheckOr(builder.Build(), "Building scalar add");
+}
+
+// state' = state + 0.01 * tanh(state), plus the batch-wide energy
+XlaComputation BuildStep(int64_t state_size) {
+    XlaBuilder builder("simulation_step");
+    auto state = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {state_size}), "state");
+    auto next = Add(state, Mul(ConstantR0<float>(&builder, 0.01f), Tanh(state)));
+    auto energy = ReduceAll(Mul(next, next), ConstantR0<float>(&builder, 0.0f), ScalarAdd());
+    Tuple(&builder, {next, CrossReplicaSum(energy)});
+    return CheckOr(builder.Build(), "Building simulation step");
+}
+
+}  // namespace
+
+int main() {
+    const int steps = bench::EnvInt("BENCH_STEPS", 200);
+    const int max_devices = bench::EnvInt("BENCH_MAX_DEVICES", 16);
+    const int64_t state_size = bench::EnvInt("BENCH_STATE", 64 << 10);
+
+    std::cerr << "========================================" << std::endl;
+    std::cerr << "XLA Data-Parallel Scaling Benchmark" << std::endl;
+    std::cerr << "========================================" << std::endl;
+
+    bench::Report report("data_parallel");
+    report.SetInfo("hardware_concurrency", std::to_string(std::thread::hardware_concurrency()));
+
+    auto computation = BuildStep(state_size);
+    double single_device_throughput = 0;
+
+    for (int devices : {1, 2, 4, 8, 16}) {
+        if (devices > max_devices) break;
+
+        CpuClientOptions options;
+        options.asynchronous = true;
+        options.cpu_device_count = devices;
+        auto client = CheckOr(GetPjRtCpuClient(options), "Creating CPU client");
+
+        auto compile_options = CheckOr(DataParallelCompileOptions(client.get(), devices),
+                                       "Creating compile options");
+        auto executable = CheckOr(client->CompileAndLoad(computation, compile_options),
+                                  "Compiling replicated step");
+
+        AlignedHostBuffer batch(devices * state_size * sizeof(float));
+        for (float& v : batch.as_span<float>()) v = 0.5f;
+        std::vector<std::vector<std::unique_ptr<PjRtBuffer>>> state;
+        state.push_back(CheckOr(
+            ScatterToReplicas(client.get(), executable.get(), batch.data(), F32, {state_size}),
+            "Scattering state"));
+
+        ExecuteOptions execute_options;
+        std::vector<double> step_ns;
+        for (int step = 0; step < steps; step++) {
+            auto argument_handles = ReplicaArgumentHandles(state);
+            auto start = Clock::now();
+            auto results = CheckOr(executable->Execute(argument_handles, execute_options),
+                                   "Executing step");
+            for (auto& replica_results : results) {
+                Check(replica_results[1]->GetReadyFuture().Await(), "Waiting for step");
+            }
+            step_ns.push_back(ElapsedNs(start));
+
+            // The new state stays on the devices for the next step
+            std::vector<std::unique_ptr<PjRtBuffer>> next_state;
+            for (auto& replica_results : results) {
+                next_state.push_back(std::move(replica_results[0]));
+            }
+            state[0] = std::move(next_state);
+        }
+
+        bench::Summary summary = bench::Summarize(step_ns);
+        double throughput = summary.ops_per_sec * devices;
+        if (devices == 1) single_device_throughput = throughput;
+        double efficiency = single_device_throughput > 0
+            ? throughput / (single_device_throughput * devices) : 0;
+
+        report.Add({{"devices", std::to_string(devices)}}, step_ns,
+                   {{"replica_steps_per_sec", throughput},
+                    {"scaling_efficiency", efficiency},
+                    {"state_elements", static_cast<double>(state_size)}});
+    }
+
+    report.Print();
+    return 0;
+}
@@ -0,0 +1,266 @@
+/**
+ * XLA Static Library Execution Benchmark
+ *
+ * Times each stage of the PjRt CPU pipeline separately:
+ * 1. CompileAndLoad
+ * 2. BufferFromHostLiteral (host -> device, until the buffer is ready)
+ * 3. Execute (until the result buffer is ready)
+ * 4. ToLiteralSync (device -> host)
+ *
+ * across tensor sizes (scalar up to 64 MB) and op mixes (elementwise,
+ * Dot, Reduce, Broadcast/Transpose). Results are printed as JSON.
+ *
+ * Environment overrides:
+ *   BENCH_ITERS          - timed iterations per case (default 50)
+ *   BENCH_COMPILE_ITERS  - timed compilations per case (default 3)
+ *   BENCH_MAX_BYTES      - largest input tensor in bytes (default 64 MB)
+ */
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+
+#include "bench_common.h"
+
+using namespace xla;
+using bench::CheckOr;
+using bench::Check;
+using bench::Clock;
+using bench::ElapsedNs;
+
+namespace {
+
+enum class OpMix { kElementwise, kDot, kReduce, kBroadcastTranspose };
+
+const char* OpMixName(OpMix op) {
+    switch (op) {
+        case OpMix::kElementwise: return "elementwise";
+        case OpMix::kDot: return "dot";
+        case OpMix::kReduce: return "reduce";
+        case OpMix::kBroadcastTranspose: return "broadcast_transpose";
+    }
+    return "unknown";
+}
+
+struct Case {
+    OpMix op;
+    int64_t elements;              // Elements in the main input
+    std::vector<Shape> arg_shapes;
+    XlaComputation computation;
+};
+
+std::vector<int64_t> VectorDims(int64_t elements) {
+    if (elements == 1) return {};
+    return {elements};
+}
+
+int64_t SquareSide(int64_t elements) {
+    return std::max<int64_t>(1, static_cast<int64_t>(std::sqrt(static_cast<double>(elements))));
+}
+
+XlaComputation ScalarAdd() {
+    XlaBuilder builder("scalar_add");
+    auto p0 = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {}), "p0");
+    auto p1 = Parameter(&builder, 1, ShapeUtil::MakeShape(F32, {}), "p1");
+    Add(p0, p1);
+    return CheckOr(builder.Build(), "Building scalar add");
+}
+
+Case BuildCase(OpMix op, int64_t elements) {
+    Case c;
+    c.op = op;
+    XlaBuilder builder(std::string("bench_") + OpMixName(op));
+
+    switch (op) {
+        case OpMix::kElementwise: {
+            // (a + b) * a - b
+            Shape shape = ShapeUtil::MakeShape(F32, VectorDims(elements));
+            auto a = Parameter(&builder, 0, shape, "a");
+            auto b = Parameter(&builder, 1, shape, "b");
+            Sub(Mul(Add(a, b), a), b);
+            c.arg_shapes = {shape, shape};
+            c.elements = elements;
+            break;
+        }
+        case OpMix::kDot: {
+            int64_t n = SquareSide(elements);
+            Shape shape = ShapeUtil::MakeShape(F32, {n, n});
+            auto a = Parameter(&builder, 0, shape, "a");
+            auto b = Parameter(&builder, 1, shape, "b");
+            Dot(a, b);
+            c.arg_shapes = {shape, shape};
+            c.elements = n * n;
+            break;
+        }
+        case OpMix::kReduce: {
+            Shape shape = ShapeUtil::MakeShape(F32, VectorDims(elements));
+            auto x = Parameter(&builder, 0, shape, "x");
+            ReduceAll(x, ConstantR0<float>(&builder, 0.0f), ScalarAdd());
+            c.arg_shapes = {shape};
+            c.elements = elements;
+            break;
+        }
+        case OpMix::kBroadcastTranspose: {
+            // transpose(x) + broadcast(row)
+            int64_t n = SquareSide(elements);
+            Shape shape = ShapeUtil::MakeShape(F32, {n, n});
+            Shape row_shape = ShapeUtil::MakeShape(F32, {n});
+            auto x = Parameter(&builder, 0, shape, "x");
+            auto row = Parameter(&builder, 1, row_shape, "row");
+            Add(Transpose(x, {1, 0}), BroadcastInDim(row, {n, n}, {1}));
+            c.arg_shapes = {shape, row_shape};
+            c.elements = n * n;
+            break;
+        }
+    }
+
+    c.computation = CheckOr(builder.Build(), std::string("Building ") + OpMixName(op));
+    return c;
+}
+
+Literal MakeInput(const Shape& shape) {
+    Literal literal(shape);
+    auto data = literal.data<float>();
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<float>(i % 1024) * 0.001f;
+    }
+    return literal;
+}
+
+std::string SizeLabel(int64_t bytes) {
+    if (bytes >= (1 << 20)) return std::to_string(bytes >> 20) + "MB";
+    if (bytes >= (1 << 10)) return std::to_string(bytes >> 10) + "KB";
+    return std::to_string(bytes) + "B";
+}
+
+void RunCase(PjRtClient* client, PjRtMemorySpace* memory_space,
+             const Case& c, int iters, int compile_iters, bench::Report& report) {
+    const int64_t input_bytes = c.elements * sizeof(float);
+    std::map<std::string, std::string> base = {
+        {"op", OpMixName(c.op)},
+        {"size", SizeLabel(input_bytes)},
+    };
+    std::map<std::string, double> metrics = {
+        {"elements", static_cast<double>(c.elements)},
+        {"input_bytes", static_cast<double>(input_bytes)},
+    };
+    auto with_phase = [&](const char* phase) {
+        auto labels = base;
+        labels["phase"] = phase;
+        return labels;
+    };
+
+    CompileOptions compile_options;
+    compile_options.executable_build_options.set_num_replicas(1);
+    compile_options.executable_build_options.set_num_partitions(1);
+
+    // 1. CompileAndLoad
+    std::vector<double> compile_ns;
+    std::unique_ptr<PjRtLoadedExecutable> executable;
+    for (int i = 0; i < compile_iters; i++) {
+        auto start = Clock::now();
+        executable = CheckOr(client->CompileAndLoad(c.computation, compile_options),
+                             "Compiling benchmark computation");
+        compile_ns.push_back(ElapsedNs(start));
+    }
+    report.Add(with_phase("compile"), compile_ns, metrics);
+
+    std::vector<Literal> inputs;
+    for (const Shape& shape : c.arg_shapes) {
+        inputs.push_back(MakeInput(shape));
+    }
+
+    std::vector<double> transfer_ns, execute_ns, readback_ns;
+    for (int i = 0; i < iters; i++) {
+        // 2. BufferFromHostLiteral, timed until all inputs are ready
+        std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+        auto start = Clock::now();
+        for (const Literal& input : inputs) {
+            buffers.push_back(CheckOr(client->BufferFromHostLiteral(input, memory_space),
+                                      "Transferring input to device"));
+        }
+        for (auto& buffer : buffers) {
+            Check(buffer->GetReadyFuture().Await(), "Waiting for input buffer");
+        }
+        transfer_ns.push_back(ElapsedNs(start));
+
+        std::vector<std::vector<PjRtBuffer*>> argument_handles(1);
+        for (auto& buffer : buffers) {
+            argument_handles[0].push_back(buffer.get());
+        }
+
+        // 3. Execute, timed until the output is ready
+        ExecuteOptions execute_options;
+        start = Clock::now();
+        auto results = CheckOr(executable->Execute(argument_handles, execute_options),
+                               "Executing benchmark computation");
+        Check(results[0][0]->GetReadyFuture().Await(), "Waiting for result buffer");
+        execute_ns.push_back(ElapsedNs(start));
+
+        // 4. ToLiteralSync
+        start = Clock::now();
+        auto literal = CheckOr(results[0][0]->ToLiteralSync(), "Transferring result to host");
+        readback_ns.push_back(ElapsedNs(start));
+    }
+
+    report.Add(with_phase("transfer"), transfer_ns, metrics);
+    report.Add(with_phase("execute"), execute_ns, metrics);
+    report.Add(with_phase("readback"), readback_ns, metrics);
+}
+
+}  // namespace
+
+int main() {
+    const int iters = bench::EnvInt("BENCH_ITERS", 50);
+    const int compile_iters = bench::EnvInt("BENCH_COMPILE_ITERS", 3);
+    const int64_t max_bytes = bench::EnvInt("BENCH_MAX_BYTES", 64 << 20);
+
+    std::cerr << "========================================" << std::endl;
+    std::cerr << "XLA Static Library Execution Benchmark" << std::endl;
+    std::cerr << "========================================" << std::endl;
+
+    CpuClientOptions options;
+    options.asynchronous = true;
+    options.cpu_device_count = 1;
+
+    auto client = CheckOr(GetPjRtCpuClient(options), "Creating CPU client");
+    auto device = client->addressable_devices()[0];
+    auto memory_space = CheckOr(device->default_memory_space(), "Getting memory space");
+
+    bench::Report report("execution");
+    report.SetInfo("platform", std::string(client->platform_name()));
+    report.SetInfo("platform_version", std::string(client->platform_version()));
+
+    // Scalar, 4 KB, 256 KB, 4 MB, 16 MB, 64 MB of f32 input
+    const std::vector<int64_t> sizes_bytes = {
+        4, 4 << 10, 256 << 10, 4 << 20, 16 << 20, 64 << 20
+    };
+    // Dot is O(n^3), so it is capped at 1024x1024 (4 MB)
+    const int64_t max_dot_bytes = 4 << 20;
+
+    for (OpMix op : {OpMix::kElementwise, OpMix::kDot, OpMix::kReduce,
+                     OpMix::kBroadcastTranspose}) {
+        std::cerr << "\n[" << OpMixName(op) << "]" << std::endl;
+        for (int64_t bytes : sizes_bytes) {
+            if (bytes > max_bytes) continue;
+            if (op == OpMix::kDot && bytes > max_dot_bytes) continue;
+            Case c = BuildCase(op, bytes / static_cast<int64_t>(sizeof(float)));
+            RunCase(client.get(), memory_space, c, iters, compile_iters, report);
+        }
+    }
+
+    report.Print();
+    return 0;
+}
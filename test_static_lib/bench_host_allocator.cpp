@@ -0,0 +1,223 @@
+/**
+ * XLA Pool Host Allocator Benchmark
+ *
+ * Runs a step loop of a small model, `out = tanh(x * w + b)`, with fresh
+ * inputs every step, the way a training or inference loop feeds the
+ * client:
+ *
+ *   literal: LiteralUtil::CreateR1 -> BufferFromHostLiteral
+ *   malloc:  a fresh AlignedHostBuffer -> BufferFromHostMemory
+ *   pooled:  PooledHostBuffer from a PoolAllocator ->
+ *            BufferFromPooledHostBuffer
+ *
+ * Both malloc and pooled inputs are zero-copy, so malloc is the baseline
+ * the pool is measured against; literal adds the cost of the copies.
+ *
+ * Reports step latency, heap allocations per step (operator new), pool
+ * misses per step (system allocations for tensor memory, one per input
+ * on the malloc path), hit rate and fragmentation of the pool. The
+ * pooled path is also run on a huge-page backed pool.
+ *
+ * Environment overrides:
+ *   BENCH_ITERS - timed steps per case (default 500)
+ */
+
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/host_allocator.h"
+#include "xla/extension/host_buffer.h"
+
+#include "bench_common.h"
+#include "bench_alloc_counter.h"
+
+using namespace xla;
+using bench::CheckOr;
+using bench::Check;
+using bench::Clock;
+using bench::ElapsedNs;
+using xla::extension::AlignedHostBuffer;
+using xla::extension::PoolAllocator;
+using xla::extension::PoolAllocatorOptions;
+using xla::extension::PoolAllocatorStats;
+using xla::extension::PooledHostBuffer;
+
+namespace {
+
+struct StepStats {
+    std::vector<double> latency_ns;
+    int64_t allocations = 0;
+    PoolAllocatorStats pool;
+};
+
+void Fill(absl::Span<float> data, int step) {
+    for (size_t i = 0; i < data.size(); i++) data[i] = 0.001f * ((i + step) % 97);
+}
+
+void RunStep(PjRtLoadedExecutable* executable, std::vector<PjRtBuffer*> handles,
+             std::vector<float>& out) {
+    std::vector<std::vector<PjRtBuffer*>> argument_handles = {handles};
+    ExecuteOptions execute_options;
+    auto results = CheckOr(executable->Execute(argument_handles, execute_options), "Executing");
+    Check(xla::extension::CopyToHostMemory(results[0][0].get(), out.data(),
+                                           out.size() * sizeof(float)).Await(),
+          "Reading back");
+}
+
+StepStats RunLiteralPath(PjRtClient* client, PjRtMemorySpace* memory_space,
+                         PjRtLoadedExecutable* executable, int64_t n, int iters) {
+    std::vector<float> host(n), out(n);
+    StepStats stats;
+
+    for (int i = 0; i < iters + 1; i++) {
+        auto allocs_before = bench::Allocations();
+        auto start = Clock::now();
+
+        std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+        for (int k = 0; k < 3; k++) {
+            Fill(absl::MakeSpan(host), i + k);
+            Literal literal = LiteralUtil::CreateR1<float>(host);
+            buffers.push_back(CheckOr(client->BufferFromHostLiteral(literal, memory_space),
+                                      "Transferring input"));
+        }
+        RunStep(executable, {buffers[0].get(), buffers[1].get(), buffers[2].get()}, out);
+
+        // The first step warms up the thread pools
+        if (i == 0) continue;
+        stats.latency_ns.push_back(ElapsedNs(start));
+        stats.allocations += bench::Allocations().allocations - allocs_before.allocations;
+    }
+    return stats;
+}
+
+StepStats RunMallocPath(PjRtClient* client, PjRtMemorySpace* memory_space,
+                        PjRtLoadedExecutable* executable, int64_t n, int iters) {
+    std::vector<float> out(n);
+    StepStats stats;
+
+    for (int i = 0; i < iters + 1; i++) {
+        auto allocs_before = bench::Allocations();
+        auto start = Clock::now();
+
+        std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+        for (int k = 0; k < 3; k++) {
+            AlignedHostBuffer host(n * sizeof(float));
+            Fill(host.as_span<float>(), i + k);
+            const void* data = host.data();
+            // The device buffer aliases the allocation, which is freed with it
+            buffers.push_back(CheckOr(
+                xla::extension::BufferFromHostMemory(client, memory_space, data, F32, {n},
+                                                     [host = std::move(host)]() mutable {}),
+                "Transferring input"));
+        }
+        RunStep(executable, {buffers[0].get(), buffers[1].get(), buffers[2].get()}, out);
+
+        // The first step warms up the thread pools
+        if (i == 0) continue;
+        stats.latency_ns.push_back(ElapsedNs(start));
+        stats.allocations += bench::Allocations().allocations - allocs_before.allocations;
+        // Every input is a system allocation, the counterpart of a pool miss
+        stats.pool.allocations += 3;
+        stats.pool.misses += 3;
+    }
+    return stats;
+}
+
+StepStats RunPooledPath(PjRtClient* client, PjRtMemorySpace* memory_space,
+                        PjRtLoadedExecutable* executable, int64_t n, int iters,
+                        std::shared_ptr<PoolAllocator> pool) {
+    std::vector<float> out(n);
+    StepStats stats;
+
+    for (int i = 0; i < iters + 1; i++) {
+        auto allocs_before = bench::Allocations();
+        auto start = Clock::now();
+
+        std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+        for (int k = 0; k < 3; k++) {
+            PooledHostBuffer host(pool, n * sizeof(float));
+            Fill(host.as_span<float>(), i + k);
+            buffers.push_back(CheckOr(
+                xla::extension::BufferFromPooledHostBuffer(client, memory_space, std::move(host),
+                                                           F32, {n}),
+                "Transferring input"));
+        }
+        RunStep(executable, {buffers[0].get(), buffers[1].get(), buffers[2].get()}, out);
+
+        // The first step warms up the thread pools and the pool
+        if (i == 0) {
+            buffers.clear();
+            pool->ClearStats();
+            continue;
+        }
+        stats.latency_ns.push_back(ElapsedNs(start));
+        stats.allocations += bench::Allocations().allocations - allocs_before.allocations;
+    }
+    stats.pool = pool->Stats();
+    return stats;
+}
+
+}  // namespace
+
+int main() {
+    const int iters = bench::EnvInt("BENCH_ITERS", 500);
+
+    std::cerr << "========================================" << std::endl;
+    std::cerr << "XLA Pool Host Allocator Benchmark" << std::endl;
+    std::cerr << "========================================" << std::endl;
+
+    CpuClientOptions options;
+    options.asynchronous = true;
+    options.cpu_device_count = 1;
+    auto client = CheckOr(GetPjRtCpuClient(options), "Creating CPU client");
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+
+    bench::Report report("host_allocator");
+    report.SetInfo("platform_version", std::string(client->platform_version()));
+
+    for (int64_t n : {int64_t{64}, int64_t{1024}, int64_t{16384}}) {
+        XlaBuilder builder("step");
+        Shape shape = ShapeUtil::MakeShape(F32, {n});
+        Tanh(Parameter(&builder, 0, shape, "x") * Parameter(&builder, 1, shape, "w") +
+             Parameter(&builder, 2, shape, "b"));
+        auto computation = CheckOr(builder.Build(), "Building computation");
+        CompileOptions compile_options;
+        auto executable = CheckOr(client->CompileAndLoad(computation, compile_options), "Compiling");
+
+        for (const char* path : {"literal", "malloc", "pooled", "pooled_huge_pages"}) {
+            StepStats stats;
+            if (std::string(path) == "literal") {
+                stats = RunLiteralPath(client.get(), memory_space, executable.get(), n, iters);
+            } else if (std::string(path) == "malloc") {
+                stats = RunMallocPath(client.get(), memory_space, executable.get(), n, iters);
+            } else {
+                PoolAllocatorOptions pool_options;
+                pool_options.huge_pages = std::string(path) == "pooled_huge_pages";
+                stats = RunPooledPath(client.get(), memory_space, executable.get(), n, iters,
+                                      std::make_shared<PoolAllocator>(pool_options));
+            }
+            report.Add({{"path", path}, {"tensor_bytes", std::to_string(n * sizeof(float))}},
+                       stats.latency_ns,
+                       {{"allocations_per_step", static_cast<double>(stats.allocations) / iters},
+                        {"pool_misses_per_step", static_cast<double>(stats.pool.misses) / iters},
+                        {"hit_rate", stats.pool.hit_rate()},
+                        {"fragmentation", stats.pool.fragmentation()}});
+        }
+    }
+
+    report.Print();
+    return 0;
+}
@@ -0,0 +1,324 @@
+/**
+ * XLA Linear Algebra Benchmark
+ *
+ * Compiles and runs the builder libraries bundled into the archive
+ * (xla/hlo/builder/lib) on batches of random matrices:
+ *
+ *   qr     QrExplicit, Householder QR with explicit Q
+ *   lu     LuDecomposition, partial pivoting
+ *   svd    SVD (one-sided Jacobi), U, singular values and V
+ *   eig    SelfAdjointEig of symmetric matrices, eigenvectors and values
+ *   sort   Sort along rows of n*n elements
+ *   top_k  TopK (k = 8) along rows of n*n elements
+ *
+ * for f32 and f64, n in {3, 8, 32, 128, 512, 1024} up to BENCH_MAX_DIM
+ * and batches of 1, 16 and 256 matrices, skipping inputs larger than
+ * BENCH_MAX_BYTES.
+ *
+ * Reports execution latency with `gflops_per_sec` from the nominal
+ * LAPACK flop counts (qr 8/3 n^3, lu 2/3 n^3, svd 21 n^3, eig 9 n^3 per
+ * matrix), so that rates compare across implementations, and
+ * `elements_per_sec` for the sorts. Every case is checked once against a
+ * reference, and `residual` and `accurate` (0 or 1) are reported:
+ *
+ *   qr, lu, svd, eig  relative Frobenius residual of the reconstruction
+ *                     (QR, LU against PA, U S V^T, A V against V W),
+ *                     computed with HIGHEST precision dots
+ *   sort, top_k       exact match with std::sort on the host
+ *
+ * Tolerances are 1e-4 (f32) and 1e-10 (f64) for qr and lu, and 1e-3
+ * and 1e-5 for the iterative svd and eig, which stop at their own
+ * convergence threshold. Inaccurate cases are listed on stderr.
+ *
+ * Environment overrides:
+ *   BENCH_ITERS     - timed executions per case (default 10), fewer once
+ *                     a case has run for 2 s
+ *   BENCH_MAX_DIM   - largest matrix dimension (default 1024)
+ *   BENCH_MAX_BYTES - largest batch input in bytes (default 64 MiB)
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/primitive_util.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/hlo/builder/lib/arithmetic.h"
+#include "xla/hlo/builder/lib/comparators.h"
+#include "xla/hlo/builder/lib/constants.h"
+#include "xla/hlo/builder/lib/lu_decomposition.h"
+#include "xla/hlo/builder/lib/matrix.h"
+#include "xla/hlo/builder/lib/qr.h"
+#include "xla/hlo/builder/lib/self_adjoint_eig.h"
+#include "xla/hlo/builder/lib/sorting.h"
+#include "xla/hlo/builder/lib/svd.h"
+#include "xla/pjrt/pjrt_executable.h"
+
+#include "bench_common.h"
+
+using namespace xla;
+using bench::CheckOr;
+using bench::Check;
+using bench::Clock;
+using bench::ElapsedNs;
+
+namespace {
+
+constexpr int64_t kTopK = 8;
+constexpr double kCaseSeconds = 2.0;
+
+struct Op {
+    std::string name;
+    // Nominal flops per n x n matrix, 0 for the sorts
+    std::function<double(double)> flops;
+    double f32_tolerance;
+    double f64_tolerance;
+};
+
+const std::vector<Op>& Ops() {
+    static const std::vector<Op> ops = {
+        {"qr", [](double n) { return 8.0 / 3 * n * n * n; }, 1e-4, 1e-10},
+        {"lu", [](double n) { return 2.0 / 3 * n * n * n; }, 1e-4, 1e-10},
+        {"svd", [](double n) { return 21 * n * n * n; }, 1e-3, 1e-5},
+        {"eig", [](double n) { return 9 * n * n * n; }, 1e-3, 1e-5},
+        {"sort", [](double) { return 0.0; }, 0, 0},
+        {"top_k", [](double) { return 0.0; }, 0, 0},
+    };
+    return ops;
+}
+
+bool IsSort(const std::string& op) { return op == "sort" || op == "top_k"; }
+
+// Input of a case: [batch, n, n] matrices, or [batch, n * n] rows to sort
+Shape InputShape(const std::string& op, PrimitiveType type, int64_t batch, int64_t n) {
+    return IsSort(op) ? ShapeUtil::MakeShape(type, {batch, n * n})
+                      : ShapeUtil::MakeShape(type, {batch, n, n});
+}
+
+// Uniform in [-1, 1), symmetric for eig
+Literal RandomInput(const std::string& op, const Shape& shape, std::mt19937_64& rng) {
+    Literal literal(shape);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    auto fill = [&](auto values) {
+        for (auto& v : values) v = dist(rng);
+        if (op != "eig") return;
+        const int64_t n = shape.dimensions(1);
+        for (int64_t b = 0; b < shape.dimensions(0); b++) {
+            auto* m = values.data() + b * n * n;
+            for (int64_t i = 0; i < n; i++) {
+                for (int64_t j = 0; j < i; j++) m[j * n + i] = m[i * n + j];
+            }
+        }
+    };
+    if (shape.element_type() == F32) {
+        fill(literal.data<float>());
+    } else {
+        fill(literal.data<double>());
+    }
+    return literal;
+}
+
+XlaOp Mm(XlaOp a, XlaOp b) { return BatchDot(a, b, PrecisionConfig::HIGHEST); }
+
+// ||a - b||_F / ||a||_F as F64
+XlaOp RelativeResidual(XlaBuilder* builder, PrimitiveType type, XlaOp a, XlaOp b) {
+    auto add = CreateScalarAddComputation(type, builder);
+    auto zero = Zero(builder, type);
+    auto diff = Sub(a, b);
+    return ConvertElementType(Div(Sqrt(ReduceAll(Mul(diff, diff), zero, add)),
+                                  Sqrt(ReduceAll(Mul(a, a), zero, add))),
+                              F64);
+}
+
+// The op alone, or only its reconstruction residual when `check`
+XlaComputation BuildCase(const std::string& op, const Shape& shape, bool check) {
+    XlaBuilder builder(op);
+    const PrimitiveType type = shape.element_type();
+    auto a = Parameter(&builder, 0, shape, "a");
+    const int64_t n = IsSort(op) ? 0 : shape.dimensions(1);
+
+    if (op == "qr") {
+        XlaOp q, r;
+        QrExplicit(a, /*full_matrices=*/true, q, r);
+        if (check) {
+            RelativeResidual(&builder, type, a, Mm(q, r));
+        } else {
+            Tuple(&builder, {q, r});
+        }
+    } else if (op == "lu") {
+        auto lu = LuDecomposition(a);
+        if (check) {
+            // P[i, j] = (j == permutation[i]), L unit lower and U upper of lu
+            Shape matrices = ShapeUtil::MakeShape(S32, shape.dimensions());
+            auto p = ConvertElementType(
+                Eq(BroadcastInDim(lu.permutation, shape.dimensions(), {0, 1}),
+                   Iota(&builder, matrices, 2)),
+                type);
+            auto lower = Triangle(lu.lu, /*lower=*/true);
+            auto l = Add(Sub(lower, Triangle(lower, /*lower=*/false)),
+                         Broadcast(IdentityMatrix(&builder, type, n, n), {shape.dimensions(0)}));
+            auto u = Triangle(lu.lu, /*lower=*/false);
+            RelativeResidual(&builder, type, Mm(p, a), Mm(l, u));
+        } else {
+            Tuple(&builder, {lu.lu, lu.pivots, lu.permutation});
+        }
+    } else if (op == "svd") {
+        auto svd = SVD(a);
+        if (check) {
+            auto us = Mul(svd.u, BroadcastInDim(svd.d, shape.dimensions(), {0, 2}));
+            RelativeResidual(&builder, type, a, Mm(us, TransposeInMinorDims(svd.v)));
+        } else {
+            Tuple(&builder, {svd.u, svd.d, svd.v});
+        }
+    } else if (op == "eig") {
+        auto eig = SelfAdjointEig(a);
+        if (check) {
+            auto vw = Mul(eig.v, BroadcastInDim(eig.w, shape.dimensions(), {0, 2}));
+            auto av = Mm(a, eig.v);
+            // Relative to ||A V|| = ||A||, V is orthogonal
+            RelativeResidual(&builder, type, av, vw);
+        } else {
+            Tuple(&builder, {eig.v, eig.w});
+        }
+    } else if (op == "sort") {
+        Sort({a}, CreateScalarLtComputation({type}, &builder), /*dimension=*/1);
+    } else {
+        GetTupleElement(TopK(a, std::min(kTopK, shape.dimensions(1))), 0);
+    }
+    return CheckOr(builder.Build(), "Building " + op);
+}
+
+// Sorted rows of the input on the host, all of them or the k largest
+template <typename T>
+bool MatchesHostSort(const std::string& op, const Literal& input, const Literal& output) {
+    const int64_t batch = input.shape().dimensions(0);
+    const int64_t length = input.shape().dimensions(1);
+    const int64_t k = output.shape().dimensions(1);
+    auto in = input.data<T>();
+    auto out = output.data<T>();
+    for (int64_t b = 0; b < batch; b++) {
+        std::vector<T> row(in.begin() + b * length, in.begin() + (b + 1) * length);
+        if (op == "sort") {
+            std::sort(row.begin(), row.end());
+        } else {
+            std::sort(row.begin(), row.end(), std::greater<T>());
+        }
+        if (!std::equal(row.begin(), row.begin() + k, out.begin() + b * k)) return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    const int iters = bench::EnvInt("BENCH_ITERS", 10);
+    const int64_t max_dim = bench::EnvInt("BENCH_MAX_DIM", 1024);
+    const int64_t max_bytes = bench::EnvInt("BENCH_MAX_BYTES", 64 << 20);
+
+    std::cerr << "========================================" << std::endl;
+    std::cerr << "XLA Linear Algebra Benchmark" << std::endl;
+    std::cerr << "========================================" << std::endl;
+
+    CpuClientOptions options;
+    options.asynchronous = true;
+    auto client = CheckOr(GetPjRtCpuClient(options), "Creating CPU client");
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+    CompileOptions compile_options;
+    ExecuteOptions execute_options;
+    std::mt19937_64 rng(42);
+
+    bench::Report report("linalg");
+    std::vector<std::string> inaccurate;
+
+    for (const Op& op : Ops()) {
+        for (PrimitiveType type : {F32, F64}) {
+            const std::string type_name = primitive_util::LowercasePrimitiveTypeName(type);
+            for (int64_t n : {3, 8, 32, 128, 512, 1024}) {
+                if (n > max_dim) break;
+                for (int64_t batch : {1, 16, 256}) {
+                    Shape shape = InputShape(op.name, type, batch, n);
+                    if (ShapeUtil::ByteSizeOf(shape) > max_bytes) break;
+                    const std::string name = op.name + " " + type_name + " n=" +
+                                             std::to_string(n) + " batch=" + std::to_string(batch);
+                    std::cerr << name << "..." << std::endl;
+
+                    Literal input = RandomInput(op.name, shape, rng);
+                    auto a = CheckOr(client->BufferFromHostLiteral(input, memory_space),
+                                     "Transferring");
+                    Check(a->GetReadyFuture().Await(), "Waiting for input");
+                    std::vector<std::vector<PjRtBuffer*>> argument_handles = {{a.get()}};
+
+                    // Accuracy, once
+                    auto checked = CheckOr(
+                        client->CompileAndLoad(BuildCase(op.name, shape, !IsSort(op.name)),
+                                               compile_options),
+                        "Compiling check of " + name);
+                    auto check = CheckOr(checked->Execute(argument_handles, execute_options),
+                                         "Checking");
+                    auto output = CheckOr(check[0][0]->ToLiteralSync(), "Reading check");
+                    double residual = 0;
+                    bool accurate = false;
+                    if (IsSort(op.name)) {
+                        accurate = type == F32 ? MatchesHostSort<float>(op.name, input, *output)
+                                               : MatchesHostSort<double>(op.name, input, *output);
+                    } else {
+                        residual = output->data<double>()[0];
+                        accurate = residual <= (type == F32 ? op.f32_tolerance : op.f64_tolerance);
+                    }
+                    if (!accurate) inaccurate.push_back(name);
+
+                    // Throughput
+                    auto executable = IsSort(op.name)
+                        ? std::move(checked)
+                        : CheckOr(client->CompileAndLoad(BuildCase(op.name, shape, false),
+                                                         compile_options),
+                                  "Compiling " + name);
+                    std::vector<double> samples;
+                    auto case_start = Clock::now();
+                    for (int i = 0; i < iters; i++) {
+                        auto start = Clock::now();
+                        auto results = CheckOr(executable->Execute(argument_handles, execute_options),
+                                               "Executing");
+                        for (const auto& result : results[0]) {
+                            Check(result->GetReadyFuture().Await(), "Waiting for outputs");
+                        }
+                        samples.push_back(ElapsedNs(start));
+                        if (samples.size() >= 3 && ElapsedNs(case_start) > kCaseSeconds * 1e9) break;
+                    }
+
+                    const double p50_ns = bench::Summarize(samples).p50_ns;
+                    std::map<std::string, double> metrics = {
+                        {"residual", residual}, {"accurate", accurate ? 1.0 : 0.0}};
+                    if (IsSort(op.name)) {
+                        metrics["elements_per_sec"] = batch * n * n * 1e9 / p50_ns;
+                    } else {
+                        metrics["gflops_per_sec"] = batch * op.flops(n) / p50_ns;
+                    }
+                    report.Add({{"op", op.name}, {"dtype", type_name}, {"n", std::to_string(n)},
+                                {"batch", std::to_string(batch)}},
+                               samples, metrics);
+                }
+            }
+        }
+    }
+
+    for (const std::string& name : inaccurate) {
+        std::cerr << "WARNING: " << name << " is outside its tolerance" << std::endl;
+    }
+    report.Print();
+    return 0;
+}
@@ -0,0 +1,186 @@
+/**
+ * XLA Low-Precision Bandwidth Benchmark
+ *
+ * Memory-bound models with their large operand stored in f32 and in the
+ * low-precision types of xla/extension/low_precision.h:
+ *
+ *   stream  y = 2x + 1 over BENCH_MAX_BYTES of f32, computed in the
+ *           storage type, which reads and writes every element once
+ *   gemv    y = x W for W [n, n] of BENCH_MAX_BYTES of f32 and x f32,
+ *           accumulated in f32 (MixedPrecisionDot for the float types,
+ *           DequantizedDot with per-column scales for s8 and s4)
+ *
+ * for f32, bf16, f8e4m3fn, f8e5m2, s8 and s4. Reports execution latency
+ * with `bytes` (the packed size of the data the model reads and writes),
+ * `gbps` (bytes over the median latency), `elements_per_sec` and
+ * `speedup_vs_f32` (median latency of f32 over that of the type). The
+ * element count is the same for every type, so a type that keeps the
+ * speed of f32 per byte runs proportionally faster; where the CPU lacks
+ * native arithmetic for a type, the upcasts show up as a lower `gbps`.
+ *
+ * Environment overrides:
+ *   BENCH_ITERS     - timed executions per case (default 20)
+ *   BENCH_MAX_BYTES - f32 size of the large operand (default 256 MiB)
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/primitive_util.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/low_precision.h"
+
+#include "bench_common.h"
+
+using namespace xla;
+using bench::CheckOr;
+using bench::Check;
+using bench::Clock;
+using bench::ElapsedNs;
+
+namespace {
+
+bool IsInteger(PrimitiveType type) { return type == S8 || type == S4; }
+
+// Small integers for the integer types, values in [-1, 1] for the float types
+std::unique_ptr<PjRtBuffer> Transfer(PjRtClient* client, PjRtMemorySpace* memory_space,
+                                     PrimitiveType type, const std::vector<int64_t>& dims) {
+    const int64_t count = ShapeUtil::ElementsIn(ShapeUtil::MakeShape(F32, dims));
+    if (type == S4) {
+        std::vector<int8_t> values(count);
+        for (int64_t i = 0; i < count; i++) values[i] = i % 15 - 7;
+        std::vector<uint8_t> packed(xla::extension::PackedByteSize(S4, count));
+        xla::extension::PackInt4(values, absl::MakeSpan(packed));
+        auto buffer = CheckOr(xla::extension::BufferFromPackedInt4(client, memory_space, packed,
+                                                                   S4, dims),
+                              "Transferring s4");
+        Check(buffer->GetReadyFuture().Await(), "Waiting for transfer");
+        return buffer;
+    }
+    Literal literal(ShapeUtil::MakeShape(type == S8 ? S8 : F32, dims));
+    if (type == S8) {
+        auto values = literal.data<int8_t>();
+        for (int64_t i = 0; i < count; i++) values[i] = i % 255 - 127;
+    } else {
+        auto values = literal.data<float>();
+        for (int64_t i = 0; i < count; i++) values[i] = std::sin(0.001 * i);
+    }
+    if (type != S8 && type != F32) literal = CheckOr(literal.Convert(type), "Converting");
+    auto buffer = CheckOr(client->BufferFromHostLiteral(literal, memory_space), "Transferring");
+    Check(buffer->GetReadyFuture().Await(), "Waiting for transfer");
+    return buffer;
+}
+
+XlaComputation BuildStream(PrimitiveType type, int64_t count) {
+    XlaBuilder builder("stream");
+    auto x = Parameter(&builder, 0, ShapeUtil::MakeShape(type, {count}), "x");
+    auto two = ConvertElementType(ConstantR0<float>(&builder, 2.0f), type);
+    auto one = ConvertElementType(ConstantR0<float>(&builder, 1.0f), type);
+    Add(Mul(x, two), one);
+    return CheckOr(builder.Build(), "Building stream");
+}
+
+XlaComputation BuildGemv(PrimitiveType type, int64_t n) {
+    XlaBuilder builder("gemv");
+    auto w = Parameter(&builder, 0, ShapeUtil::MakeShape(type, {n, n}), "w");
+    auto x = Parameter(&builder, 1, ShapeUtil::MakeShape(F32, {n}), "x");
+    if (IsInteger(type)) {
+        auto scales = Parameter(&builder, 2, ShapeUtil::MakeShape(F32, {n}), "scales");
+        xla::extension::DequantizedDot(x, w, scales);
+    } else {
+        xla::extension::MixedPrecisionDot(x, w, F32);
+    }
+    return CheckOr(builder.Build(), "Building gemv");
+}
+
+}  // namespace
+
+int main() {
+    const int iters = bench::EnvInt("BENCH_ITERS", 20);
+    const int64_t max_bytes = bench::EnvInt("BENCH_MAX_BYTES", 256 << 20);
+
+    std::cerr << "========================================" << std::endl;
+    std::cerr << "XLA Low-Precision Bandwidth Benchmark" << std::endl;
+    std::cerr << "========================================" << std::endl;
+
+    CpuClientOptions options;
+    options.asynchronous = true;
+    auto client = CheckOr(GetPjRtCpuClient(options), "Creating CPU client");
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+    CompileOptions compile_options;
+    ExecuteOptions execute_options;
+
+    const int64_t count = max_bytes / sizeof(float);
+    const int64_t n = static_cast<int64_t>(std::sqrt(static_cast<double>(count)));
+
+    bench::Report report("low_precision");
+    report.SetInfo("stream_elements", std::to_string(count));
+    report.SetInfo("gemv_n", std::to_string(n));
+
+    for (const std::string model : {"stream", "gemv"}) {
+        double f32_p50_ns = 0;
+        for (PrimitiveType type : {F32, BF16, F8E4M3FN, F8E5M2, S8, S4}) {
+            const std::string type_name = primitive_util::LowercasePrimitiveTypeName(type);
+            std::cerr << model << " " << type_name << "..." << std::endl;
+
+            std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+            XlaComputation computation;
+            double elements, bytes;
+            if (model == "stream") {
+                buffers.push_back(Transfer(client.get(), memory_space, type, {count}));
+                computation = BuildStream(type, count);
+                elements = count;
+                bytes = 2.0 * xla::extension::PackedByteSize(type, count);
+            } else {
+                buffers.push_back(Transfer(client.get(), memory_space, type, {n, n}));
+                buffers.push_back(Transfer(client.get(), memory_space, F32, {n}));
+                if (IsInteger(type)) buffers.push_back(Transfer(client.get(), memory_space, F32, {n}));
+                computation = BuildGemv(type, n);
+                elements = n * n;
+                bytes = xla::extension::PackedByteSize(type, n * n) + 2.0 * n * sizeof(float);
+            }
+            auto executable = CheckOr(client->CompileAndLoad(computation, compile_options),
+                                      "Compiling " + model + " " + type_name);
+            std::vector<std::vector<PjRtBuffer*>> argument_handles(1);
+            for (const auto& buffer : buffers) argument_handles[0].push_back(buffer.get());
+
+            // Warmup
+            auto warmup = CheckOr(executable->Execute(argument_handles, execute_options),
+                                  "Executing");
+            Check(warmup[0][0]->GetReadyFuture().Await(), "Waiting for warmup");
+
+            std::vector<double> samples;
+            for (int i = 0; i < iters; i++) {
+                auto start = Clock::now();
+                auto results = CheckOr(executable->Execute(argument_handles, execute_options),
+                                       "Executing");
+                Check(results[0][0]->GetReadyFuture().Await(), "Waiting for output");
+                samples.push_back(ElapsedNs(start));
+            }
+
+            const double p50_ns = bench::Summarize(samples).p50_ns;
+            if (type == F32) f32_p50_ns = p50_ns;
+            report.Add({{"model", model}, {"dtype", type_name}}, samples,
+                       {{"bytes", bytes},
+                        {"gbps", bytes / p50_ns},
+                        {"elements_per_sec", elements * 1e9 / p50_ns},
+                        {"speedup_vs_f32", f32_p50_ns / p50_ns}});
+        }
+    }
+
+    report.Print();
+    return 0;
+}
@@ -0,0 +1,141 @@
+/**
+ * XLA Multi-Step Benchmark
+ *
+ * A microsecond-scale physics step (a 256-particle leapfrog integrator)
+ * run two ways:
+ *
+ *   separate  K Execute calls of the step, state donated through
+ *             xla/extension/state_loop.h
+ *   fused     one Execute of K steps, xla/extension/multi_step.h
+ *
+ * for K in {1, 10, 100, 1000}. Each sample is K steps, waited for on the
+ * host. Reports `steps_per_sec` next to the per-K latency, where the gap
+ * between the two modes is the per-Execute dispatch cost.
+ *
+ * Environment overrides:
+ *   BENCH_ITERS - samples per case (default 50)
+ */
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/multi_step.h"
+#include "xla/extension/state_loop.h"
+
+#include "bench_common.h"
+
+using namespace xla;
+using bench::CheckOr;
+using bench::Check;
+using bench::Clock;
+using bench::ElapsedNs;
+
+namespace {
+
+constexpr int64_t kParticles = 256;
+
+// (x, v) -> (x' = x + v * dt, v - x' * dt, sum(x')), optionally with aliases
+XlaComputation BuildStep(bool alias) {
+    XlaBuilder builder("leapfrog");
+    Shape shape = ShapeUtil::MakeShape(F32, {kParticles, 3});
+    auto x = Parameter(&builder, 0, shape, "x");
+    auto v = Parameter(&builder, 1, shape, "v");
+    auto dt = ConstantR0<float>(&builder, 0.001f);
+    auto next_x = Add(x, Mul(v, dt));
+    auto next_v = Sub(v, Mul(next_x, dt));
+    auto sum = Reduce(next_x, ConstantR0<float>(&builder, 0.0f),
+                      CreateScalarAddComputation(F32, &builder), {0, 1});
+    Tuple(&builder, {next_x, next_v, sum});
+    if (alias) xla::extension::AliasStateToOutputs(&builder, 2);
+    return CheckOr(builder.Build(), "Building step");
+}
+
+std::vector<std::unique_ptr<PjRtBuffer>> InitialState(PjRtClient* client) {
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+    Literal x(ShapeUtil::MakeShape(F32, {kParticles, 3}));
+    x.PopulateWithValue(1.0f);
+    Literal v(ShapeUtil::MakeShape(F32, {kParticles, 3}));
+    v.PopulateWithValue(0.0f);
+    std::vector<std::unique_ptr<PjRtBuffer>> state;
+    for (const Literal* literal : {&x, &v}) {
+        state.push_back(CheckOr(client->BufferFromHostLiteral(*literal, memory_space), "Transferring"));
+        Check(state.back()->GetReadyFuture().Await(), "Waiting for state");
+    }
+    return state;
+}
+
+}  // namespace
+
+int main() {
+    const int iters = bench::EnvInt("BENCH_ITERS", 50);
+
+    std::cerr << "========================================" << std::endl;
+    std::cerr << "XLA Multi-Step Benchmark" << std::endl;
+    std::cerr << "========================================" << std::endl;
+
+    CpuClientOptions options;
+    options.asynchronous = true;
+    auto client = CheckOr(GetPjRtCpuClient(options), "Creating CPU client");
+    CompileOptions compile_options;
+    auto step = CheckOr(client->CompileAndLoad(BuildStep(true), compile_options), "Compiling step");
+
+    bench::Report report("multi_step");
+    report.SetInfo("particles", std::to_string(kParticles));
+    auto add = [&](const std::string& mode, int64_t k, const std::vector<double>& samples) {
+        auto stats = bench::Summarize(samples);
+        report.Add({{"mode", mode}, {"steps", std::to_string(k)}}, samples,
+                   {{"steps_per_sec", k * 1e9 / stats.p50_ns}});
+    };
+
+    for (int64_t k : {1, 10, 100, 1000}) {
+        // separate
+        {
+            std::cerr << "separate K=" << k << "..." << std::endl;
+            auto loop = CheckOr(xla::extension::StateLoop::Create(step.get(), InitialState(client.get())),
+                                "Creating loop");
+            std::vector<double> samples;
+            for (int i = 0; i < iters; i++) {
+                auto start = Clock::now();
+                for (int64_t s = 0; s < k; s++) CheckOr(loop->Step(), "Stepping");
+                Check(loop->state()[0]->GetReadyFuture().Await(), "Waiting for steps");
+                samples.push_back(ElapsedNs(start));
+            }
+            add("separate", k, samples);
+        }
+
+        // fused
+        {
+            std::cerr << "fused K=" << k << "..." << std::endl;
+            xla::extension::MultiStepOptions multi_step_options;
+            multi_step_options.steps = k;
+            auto runner = CheckOr(xla::extension::MultiStepRunner::Create(
+                                      client.get(), BuildStep(false), InitialState(client.get()),
+                                      multi_step_options, compile_options),
+                                  "Creating runner");
+            std::vector<double> samples;
+            for (int i = 0; i < iters; i++) {
+                auto start = Clock::now();
+                Check(runner->Run(), "Running");
+                Check(runner->state()[0]->GetReadyFuture().Await(), "Waiting for steps");
+                samples.push_back(ElapsedNs(start));
+            }
+            add("fused", k, samples);
+        }
+    }
+
+    report.Print();
+    return 0;
+}
@@ -0,0 +1,185 @@
+/**
+ * XLA Execution Pipeline Benchmark
+ *
+ * Compares end-to-end step throughput of:
+ *
+ *   sync:       the loop used by the tests, where every step creates
+ *               Literals, calls BufferFromHostLiteral, Execute and then
+ *               blocks on ToLiteralSync
+ *   pipeline_N: xla::extension::ExecutionPipeline with depth N, where
+ *               input preparation and transfer of step N+1 and readback
+ *               of step N-1 overlap with execution of step N
+ *
+ * Every step produces fresh input on the host and consumes the output,
+ * as a simulation loop would.
+ *
+ * Environment overrides:
+ *   BENCH_STEPS    - steps per mode (default 200)
+ *   BENCH_ELEMENTS - f32 elements per tensor (default 1M)
+ */
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/execution_pipeline.h"
+#include "xla/extension/host_buffer.h"
+
+#include "bench_common.h"
+
+using namespace xla;
+using bench::CheckOr;
+using bench::Check;
+using bench::Clock;
+using bench::ElapsedNs;
+using namespace xla::extension;
+
+namespace {
+
+// Host-side work done per step, both to produce input and consume output
+void ProduceInput(absl::Span<float> data, int64_t step) {
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<float>((step + i) % 97) * 0.01f;
+    }
+}
+
+double ConsumeOutput(absl::Span<const float> data) {
+    double sum = 0;
+    for (float v : data) sum += v;
+    return sum;
+}
+
+std::unique_ptr<PjRtLoadedExecutable> Compile(PjRtClient* client, int64_t n) {
+    // A few transcendental ops, so that execution is comparable to transfers
+    XlaBuilder builder("step");
+    auto x = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {n}), "x");
+    Add(Mul(Tanh(x), Exp(Neg(x))), Sin(x));
+    auto computation = CheckOr(builder.Build(), "Building computation");
+    CompileOptions compile_options;
+    return CheckOr(client->CompileAndLoad(computation, compile_options), "Compiling");
+}
+
+double RunSync(PjRtClient* client, PjRtMemorySpace* memory_space,
+               PjRtLoadedExecutable* executable, int64_t n, int steps) {
+    std::vector<float> input(n);
+    double checksum = 0;
+    for (int step = 0; step < steps; step++) {
+        ProduceInput(absl::MakeSpan(input), step);
+        Literal literal = LiteralUtil::CreateR1<float>(input);
+        auto buffer = CheckOr(client->BufferFromHostLiteral(literal, memory_space), "Transferring");
+        std::vector<std::vector<PjRtBuffer*>> argument_handles = {{buffer.get()}};
+        ExecuteOptions execute_options;
+        auto results = CheckOr(executable->Execute(argument_handles, execute_options), "Executing");
+        auto output = CheckOr(results[0][0]->ToLiteralSync(), "Reading back");
+        checksum += ConsumeOutput(output->data<float>());
+    }
+    return checksum;
+}
+
+double RunPipeline(PjRtClient* client, PjRtMemorySpace* memory_space,
+                   PjRtLoadedExecutable* executable, int64_t n, int steps, int depth) {
+    std::vector<AlignedHostBuffer> inputs, outputs;
+    for (int i = 0; i < depth; i++) {
+        inputs.emplace_back(n * sizeof(float));
+        outputs.emplace_back(n * sizeof(float));
+    }
+
+    double checksum = 0;
+    ExecutionPipeline* pipeline_ptr = nullptr;
+    ExecutionPipeline::Options options;
+    options.depth = depth;
+    ExecutionPipeline pipeline(
+        executable, options,
+        [&](int64_t step, absl::Span<const std::unique_ptr<PjRtBuffer>> results) {
+            auto& out = outputs[pipeline_ptr->slot(step)];
+            return std::vector<PjRtFuture<>>{
+                CopyToHostMemory(results[0].get(), out.data(), out.size())};
+        },
+        [&](int64_t step, absl::Status status, std::vector<std::unique_ptr<PjRtBuffer>>) {
+            Check(status, "Pipeline step");
+            checksum += ConsumeOutput(outputs[pipeline_ptr->slot(step)].as_span<float>());
+        });
+    pipeline_ptr = &pipeline;
+
+    for (int s = 0; s < steps; s++) {
+        int64_t step = CheckOr(pipeline.NextStep(), "Reserving step");
+        auto in = inputs[pipeline.slot(step)].as_span<float>();
+        ProduceInput(in, step);
+        std::vector<std::unique_ptr<PjRtBuffer>> arguments;
+        arguments.push_back(CheckOr(
+            BufferFromHostMemory(client, memory_space, in.data(), F32, {n}), "Transferring"));
+        Check(pipeline.Submit(std::move(arguments)), "Submitting step");
+    }
+    Check(pipeline.Flush(), "Flushing pipeline");
+    return checksum;
+}
+
+}  // namespace
+
+int main() {
+    const int steps = bench::EnvInt("BENCH_STEPS", 200);
+    const int64_t n = bench::EnvInt("BENCH_ELEMENTS", 1 << 20);
+    const int repeats = 5;
+
+    std::cerr << "========================================" << std::endl;
+    std::cerr << "XLA Execution Pipeline Benchmark" << std::endl;
+    std::cerr << "========================================" << std::endl;
+
+    CpuClientOptions options;
+    options.asynchronous = true;
+    options.cpu_device_count = 1;
+    auto client = CheckOr(GetPjRtCpuClient(options), "Creating CPU client");
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+    auto executable = Compile(client.get(), n);
+
+    bench::Report report("pipeline");
+    report.SetInfo("platform_version", std::string(client->platform_version()));
+
+    std::vector<std::string> modes = {"sync", "pipeline_1", "pipeline_2", "pipeline_3"};
+    std::map<std::string, double> checksums;
+    for (const std::string& mode : modes) {
+        // Each sample is the average step time over a full run
+        std::vector<double> step_ns;
+        for (int r = 0; r < repeats; r++) {
+            auto start = Clock::now();
+            double checksum = mode == "sync"
+                ? RunSync(client.get(), memory_space, executable.get(), n, steps)
+                : RunPipeline(client.get(), memory_space, executable.get(), n, steps,
+                              std::stoi(mode.substr(mode.find('_') + 1)));
+            step_ns.push_back(ElapsedNs(start) / steps);
+            checksums[mode] = checksum;
+        }
+        report.Add({{"mode", mode}}, step_ns,
+                   {{"steps", static_cast<double>(steps)}, {"elements", static_cast<double>(n)}});
+    }
+
+    // All modes compute the same thing
+    for (const std::string& mode : modes) {
+        if (std::abs(checksums[mode] - checksums["sync"]) > 1e-3 * std::abs(checksums["sync"])) {
+            std::cerr << "ERROR: " << mode << " checksum differs from sync" << std::endl;
+            return 1;
+        }
+    }
+
+    double sync_ops = report.results()[0].summary.ops_per_sec;
+    for (const auto& result : report.results()) {
+        std::cerr << "  " << result.labels.at("mode") << ": "
+                  << result.summary.ops_per_sec << " steps/s ("
+                  << result.summary.ops_per_sec / sync_ops << "x sync)" << std::endl;
+    }
+
+    report.Print();
+    return 0;
+}
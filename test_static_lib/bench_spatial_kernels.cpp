@@ -0,0 +1,148 @@
+/**
+ * XLA Spatial-Algebra Kernel Benchmark
+ *
+ * Compares the custom-call kernels of xla/extension/spatial_kernels.h
+ * with the equivalent HLO graphs (spatial_hlo.h) for batched 3x3, 4x4
+ * and 6x6 matmul, 6x6 matvec, quaternion product and rotation and the
+ * spatial motion transform. Inputs stay on the device, each sample is
+ * one Execute until the result is ready. Reports `items_per_sec` next
+ * to latency.
+ *
+ * Environment overrides:
+ *   BENCH_ITERS     - timed executions per case (default 100)
+ *   BENCH_MAX_BATCH - largest batch size (default 262144)
+ */
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/spatial_kernels.h"
+
+#include "bench_common.h"
+#include "spatial_hlo.h"
+
+using namespace xla;
+using bench::CheckOr;
+using bench::Check;
+using bench::Clock;
+using bench::ElapsedNs;
+
+namespace {
+
+struct Op {
+    std::string name;
+    // Item dimensions of every operand, without the batch dimension
+    std::vector<std::vector<int64_t>> operand_dims;
+    XlaOp (*kernel)(absl::Span<const XlaOp>);
+    XlaOp (*hlo)(absl::Span<const XlaOp>);
+};
+
+std::vector<Op> Ops() {
+    auto matmul_kernel = [](absl::Span<const XlaOp> p) { return extension::BatchedSmallMatMul(p[0], p[1]); };
+    auto matmul_hlo = [](absl::Span<const XlaOp> p) { return spatial_hlo::BatchedDot(p[0], p[1]); };
+    return {
+        {"matmul_3x3", {{3, 3}, {3, 3}}, matmul_kernel, matmul_hlo},
+        {"matmul_4x4", {{4, 4}, {4, 4}}, matmul_kernel, matmul_hlo},
+        {"matmul_6x6", {{6, 6}, {6, 6}}, matmul_kernel, matmul_hlo},
+        {"matvec_6x6", {{6, 6}, {6}},
+         [](absl::Span<const XlaOp> p) { return extension::BatchedSmallMatVec(p[0], p[1]); },
+         [](absl::Span<const XlaOp> p) { return spatial_hlo::BatchedDot(p[0], p[1]); }},
+        {"quaternion_multiply", {{4}, {4}},
+         [](absl::Span<const XlaOp> p) { return extension::QuaternionMultiply(p[0], p[1]); },
+         [](absl::Span<const XlaOp> p) { return spatial_hlo::QuaternionMultiply(p[0], p[1]); }},
+        {"quaternion_rotate", {{4}, {3}},
+         [](absl::Span<const XlaOp> p) { return extension::QuaternionRotate(p[0], p[1]); },
+         [](absl::Span<const XlaOp> p) { return spatial_hlo::QuaternionRotate(p[0], p[1]); }},
+        {"spatial_transform", {{3, 3}, {3}, {6}},
+         [](absl::Span<const XlaOp> p) { return extension::SpatialMotionTransform(p[0], p[1], p[2]); },
+         [](absl::Span<const XlaOp> p) { return spatial_hlo::SpatialMotionTransform(p[0], p[1], p[2]); }},
+    };
+}
+
+}  // namespace
+
+int main() {
+    const int iters = bench::EnvInt("BENCH_ITERS", 100);
+    const int64_t max_batch = bench::EnvInt("BENCH_MAX_BATCH", 262144);
+
+    std::cerr << "========================================" << std::endl;
+    std::cerr << "XLA Spatial-Algebra Kernel Benchmark" << std::endl;
+    std::cerr << "========================================" << std::endl;
+
+    auto client = CheckOr(GetPjRtCpuClient(CpuClientOptions()), "Creating CPU client");
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+
+    bench::Report report("spatial_kernels");
+    report.SetInfo("platform_version", std::string(client->platform_version()));
+    report.SetInfo("kernel_isa", extension::SpatialKernelIsa());
+
+    for (const Op& op : Ops()) {
+        for (int64_t batch : {int64_t{64}, int64_t{4096}, int64_t{262144}}) {
+            if (batch > max_batch) continue;
+
+            std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+            std::vector<PjRtBuffer*> handles;
+            std::vector<Shape> shapes;
+            for (const auto& item_dims : op.operand_dims) {
+                std::vector<int64_t> dims = {batch};
+                dims.insert(dims.end(), item_dims.begin(), item_dims.end());
+                Literal literal(ShapeUtil::MakeShape(F32, dims));
+                auto data = literal.data<float>();
+                // Quaternion operands are the identity rotation, so that
+                // they have unit norm
+                bool quaternion = item_dims == std::vector<int64_t>{4};
+                for (size_t i = 0; i < data.size(); i++) {
+                    data[i] = quaternion ? (i % 4 == 0 ? 1.0f : 0.0f) : 0.01f * (i % 13);
+                }
+                shapes.push_back(literal.shape());
+                buffers.push_back(CheckOr(client->BufferFromHostLiteral(literal, memory_space),
+                                          "Transferring operand"));
+                handles.push_back(buffers.back().get());
+            }
+
+            for (const char* impl : {"kernel", "hlo"}) {
+                XlaBuilder builder(op.name);
+                std::vector<XlaOp> params;
+                for (size_t i = 0; i < shapes.size(); i++) {
+                    params.push_back(Parameter(&builder, i, shapes[i], "p" + std::to_string(i)));
+                }
+                (std::string(impl) == "kernel" ? op.kernel : op.hlo)(params);
+                auto computation = CheckOr(builder.Build(), "Building " + op.name);
+                CompileOptions compile_options;
+                auto executable = CheckOr(client->CompileAndLoad(computation, compile_options),
+                                          "Compiling " + op.name);
+
+                std::vector<std::vector<PjRtBuffer*>> argument_handles = {handles};
+                ExecuteOptions execute_options;
+                std::vector<double> samples;
+                for (int i = 0; i < iters + 1; i++) {
+                    auto start = Clock::now();
+                    auto results = CheckOr(executable->Execute(argument_handles, execute_options),
+                                           "Executing " + op.name);
+                    Check(results[0][0]->GetReadyFuture().Await(), "Waiting for result");
+                    // The first execution warms up the thread pools
+                    if (i > 0) samples.push_back(ElapsedNs(start));
+                }
+
+                bench::Summary summary = bench::Summarize(samples);
+                report.Add({{"op", op.name}, {"impl", impl}, {"batch", std::to_string(batch)}},
+                           samples,
+                           {{"items_per_sec", summary.mean_ns > 0 ? batch * 1e9 / summary.mean_ns : 0}});
+            }
+        }
+    }
+
+    report.Print();
+    return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * XLA SPMD Matmul Benchmark
+ *
+ * Compares a large C = A x B unsharded on one device against the same
+ * computation SPMD-partitioned by rows of A across 2, 4 and 8 CPU
+ * devices. Reports execution wall-clock time and per-device memory from
+ * the compiled buffer assignment: `total_bytes_per_device` reserved for
+ * arguments, outputs and temporaries (minus aliased bytes), and
+ * `peak_bytes_per_device` for the peak of live buffers (0 when the
+ * compiler reports none), each also summed over devices.
+ *
+ * Environment overrides:
+ *   BENCH_ITERS          - timed executions per configuration (default 20)
+ *   BENCH_MATMUL_SIZE    - M = K = N (default 2048)
+ *   BENCH_MAX_PARTITIONS - largest partition count (default 8)
+ */
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/host_buffer.h"
+#include "xla/extension/spmd.h"
+
+#include "bench_common.h"
+
+using namespace xla;
+using bench::CheckOr;
+using bench::Check;
+using bench::Clock;
+using bench::ElapsedNs;
+using namespace xla::extension;
+
+int main() {
+    const int iters = bench::EnvInt("BENCH_ITERS", 20);
+    const int64_t n = bench::EnvInt("BENCH_MATMUL_SIZE", 2048);
+    const int max_partitions = bench::EnvInt("BENCH_MAX_PARTITIONS", 8);
+
+    std::cerr << "========================================" << std::endl;
+    std::cerr << "XLA SPMD Matmul Benchmark" << std::endl;
+    std::cerr << "========================================" << std::endl;
+
+    bench::Report report("spmd_matmul");
+
+    AlignedHostBuffer a(n * n * sizeof(float)), b(n * n * sizeof(float));
+    for (int64_t i = 0; i < n * n; i++) {
+        a.as_span<float>()[i] = static_cast<float>(i % 13) * 0.01f;
+        b.as_span<float>()[i] = static_cast<float>(i % 11) * 0.01f;
+    }
+
+    for (int partitions : {1, 2, 4, 8}) {
+        if (partitions > max_partitions || n % partitions != 0) continue;
+
+        CpuClientOptions options;
+        options.asynchronous = true;
+        options.cpu_device_count = partitions;
+        auto client = CheckOr(GetPjRtCpuClient(options), "Creating CPU client");
+
+        XlaBuilder builder("matmul");
+        Shape shape = ShapeUtil::MakeShape(F32, {n, n});
+        auto lhs = ShardedParameter(&builder, 0, shape, "a", TiledSharding(2, 0, partitions));
+        auto rhs = ShardedParameter(&builder, 1, shape, "b", ReplicatedSharding());
+        {
+            XlaScopedShardingAssignment assign(&builder, TiledSharding(2, 0, partitions));
+            Dot(lhs, rhs);
+        }
+        auto computation = CheckOr(builder.Build(), "Building matmul");
+
+        auto compile_options = CheckOr(SpmdCompileOptions(client.get(), partitions),
+                                       "Creating compile options");
+        auto executable = CheckOr(client->CompileAndLoad(computation, compile_options),
+                                  "Compiling matmul");
+
+        double total_bytes = -1, peak_bytes = -1;
+        auto stats = executable->GetCompiledMemoryStats();
+        if (stats.ok()) {
+            total_bytes = static_cast<double>(stats->argument_size_in_bytes +
+                                              stats->output_size_in_bytes +
+                                              stats->temp_size_in_bytes -
+                                              stats->alias_size_in_bytes);
+            peak_bytes = static_cast<double>(stats->peak_memory_in_bytes);
+        }
+
+        std::vector<std::vector<std::unique_ptr<PjRtBuffer>>> arguments;
+        arguments.push_back(CheckOr(
+            ShardToPartitions(client.get(), executable.get(), a.data(), F32, {n, n}, true),
+            "Sharding a"));
+        arguments.push_back(CheckOr(
+            ShardToPartitions(client.get(), executable.get(), b.data(), F32, {n, n}, false),
+            "Replicating b"));
+        std::vector<std::vector<PjRtBuffer*>> argument_handles(partitions);
+        for (auto& argument : arguments) {
+            for (int p = 0; p < partitions; p++) argument_handles[p].push_back(argument[p].get());
+        }
+
+        ExecuteOptions execute_options;
+        std::vector<double> execute_ns;
+        for (int i = 0; i < iters + 1; i++) {
+            auto start = Clock::now();
+            auto results = CheckOr(executable->Execute(argument_handles, execute_options),
+                                   "Executing matmul");
+            for (auto& partition_results : results) {
+                Check(partition_results[0]->GetReadyFuture().Await(), "Waiting for result");
+            }
+            // The first execution warms up the thread pools
+            if (i > 0) execute_ns.push_back(ElapsedNs(start));
+        }
+
+        bench::Summary summary = bench::Summarize(execute_ns);
+        double gflops = 2.0 * n * n * n / summary.mean_ns;
+        report.Add({{"mode", partitions == 1 ? "unsharded" : "sharded"},
+                    {"partitions", std::to_string(partitions)}},
+                   execute_ns,
+                   {{"matmul_size", static_cast<double>(n)},
+                    {"gflops", gflops},
+                    {"total_bytes_per_device", total_bytes},
+                    {"total_bytes", total_bytes < 0 ? -1 : total_bytes * partitions},
+                    {"peak_bytes_per_device", peak_bytes},
+                    {"peak_bytes_total", peak_bytes < 0 ? -1 : peak_bytes * partitions}});
+    }
+
+    report.Print();
+    return 0;
+}
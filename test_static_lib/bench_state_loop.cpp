@@ -0,0 +1,165 @@
+/**
+ * XLA State Loop Benchmark
+ *
+ * A large state vector updated over thousands of steps by
+ * `x = x * 0.999 + 0.001 * u`, three ways:
+ *
+ *   host_roundtrip  the pattern of the tests: a fresh BufferFromHostLiteral
+ *                   of the state every step, read back with ToLiteralSync
+ *   device          state stays on the device, without aliasing, so every
+ *                   step allocates a new state next to the old one
+ *   donated         xla/extension/state_loop.h, the state is donated and
+ *                   updated in place
+ *
+ * Reports per-step latency with `peak_rss_bytes` (VmHWM, reset before each
+ * case on Linux) and `state_bytes`. host_roundtrip runs a tenth of the
+ * steps, it copies the whole state twice per step.
+ *
+ * Environment overrides:
+ *   BENCH_ITERS       - steps per case (default 2000)
+ *   BENCH_STATE_BYTES - size of the state (default 64 MiB)
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/state_loop.h"
+
+#include "bench_common.h"
+
+using namespace xla;
+using bench::CheckOr;
+using bench::Check;
+using bench::Clock;
+using bench::ElapsedNs;
+
+namespace {
+
+// Resets the peak resident set size of the process, Linux only
+void ResetPeakRss() {
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+double PeakRssBytes() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) return std::stod(line.substr(6)) * 1024;
+    }
+    return 0;
+}
+
+XlaComputation BuildStep(int64_t n, bool alias) {
+    XlaBuilder builder("step");
+    Shape shape = ShapeUtil::MakeShape(F32, {n});
+    auto x = Parameter(&builder, 0, shape, "x");
+    auto u = Parameter(&builder, 1, ShapeUtil::MakeShape(F32, {}), "u");
+    Add(Mul(x, ConstantR0<float>(&builder, 0.999f)), Mul(u, ConstantR0<float>(&builder, 0.001f)));
+    if (alias) xla::extension::AliasStateToOutputs(&builder, 1, /*tuple_root=*/false);
+    return CheckOr(builder.Build(), "Building step");
+}
+
+}  // namespace
+
+int main() {
+    const int iters = bench::EnvInt("BENCH_ITERS", 2000);
+    const int64_t state_bytes = bench::EnvInt("BENCH_STATE_BYTES", 64 << 20);
+    const int64_t n = state_bytes / sizeof(float);
+
+    std::cerr << "========================================" << std::endl;
+    std::cerr << "XLA State Loop Benchmark" << std::endl;
+    std::cerr << "========================================" << std::endl;
+
+    CpuClientOptions options;
+    options.asynchronous = true;
+    auto client = CheckOr(GetPjRtCpuClient(options), "Creating CPU client");
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+    CompileOptions compile_options;
+    auto plain = CheckOr(client->CompileAndLoad(BuildStep(n, false), compile_options), "Compiling");
+    auto aliased = CheckOr(client->CompileAndLoad(BuildStep(n, true), compile_options), "Compiling");
+
+    Literal initial(ShapeUtil::MakeShape(F32, {n}));
+    initial.PopulateWithValue(1.0f);
+    auto u = CheckOr(client->BufferFromHostLiteral(LiteralUtil::CreateR0<float>(2.0f), memory_space),
+                     "Transferring u");
+    ExecuteOptions execute_options;
+
+    bench::Report report("state_loop");
+    report.SetInfo("state_bytes", std::to_string(state_bytes));
+    auto add = [&](const std::string& mode, const std::vector<double>& samples) {
+        report.Add({{"mode", mode}}, samples,
+                   {{"peak_rss_bytes", PeakRssBytes()}, {"state_bytes", static_cast<double>(state_bytes)}});
+    };
+
+    // host_roundtrip
+    {
+        std::cerr << "host_roundtrip..." << std::endl;
+        Literal state = initial.Clone();
+        ResetPeakRss();
+        std::vector<double> samples;
+        for (int i = 0; i < std::max(iters / 10, 1); i++) {
+            auto start = Clock::now();
+            auto x = CheckOr(client->BufferFromHostLiteral(state, memory_space), "Transferring x");
+            std::vector<std::vector<PjRtBuffer*>> argument_handles = {{x.get(), u.get()}};
+            auto results = CheckOr(plain->Execute(argument_handles, execute_options), "Executing");
+            state = std::move(*CheckOr(results[0][0]->ToLiteralSync(), "Reading back"));
+            samples.push_back(ElapsedNs(start));
+        }
+        add("host_roundtrip", samples);
+    }
+
+    // device
+    {
+        std::cerr << "device..." << std::endl;
+        auto x = CheckOr(client->BufferFromHostLiteral(initial, memory_space), "Transferring x");
+        Check(x->GetReadyFuture().Await(), "Waiting for x");
+        ResetPeakRss();
+        std::vector<double> samples;
+        for (int i = 0; i < iters; i++) {
+            auto start = Clock::now();
+            std::vector<std::vector<PjRtBuffer*>> argument_handles = {{x.get(), u.get()}};
+            auto results = CheckOr(plain->Execute(argument_handles, execute_options), "Executing");
+            x = std::move(results[0][0]);
+            Check(x->GetReadyFuture().Await(), "Waiting for step");
+            samples.push_back(ElapsedNs(start));
+        }
+        add("device", samples);
+    }
+
+    // donated
+    {
+        std::cerr << "donated..." << std::endl;
+        std::vector<std::unique_ptr<PjRtBuffer>> state;
+        state.push_back(CheckOr(client->BufferFromHostLiteral(initial, memory_space), "Transferring x"));
+        Check(state[0]->GetReadyFuture().Await(), "Waiting for x");
+        auto loop = CheckOr(xla::extension::StateLoop::Create(aliased.get(), std::move(state)),
+                            "Creating loop");
+        ResetPeakRss();
+        std::vector<double> samples;
+        for (int i = 0; i < iters; i++) {
+            auto start = Clock::now();
+            CheckOr(loop->Step({u.get()}), "Stepping");
+            Check(loop->state()[0]->GetReadyFuture().Await(), "Waiting for step");
+            samples.push_back(ElapsedNs(start));
+        }
+        add("donated", samples);
+    }
+
+    report.Print();
+    return 0;
+}
@@ -0,0 +1,64 @@
+#!/usr/bin/env bash
+#
+# Compiles each given source file with and without the precompiled
+# umbrella header and prints a JSON report with compile times and the
+# size of the include tree on stdout.
+#
+# Environment:
+#   CXX           - compiler (default clang++)
+#   CXXFLAGS      - compile flags, the same the PCH was built with
+#   PCH           - precompiled xla/extension/xla_extension.h
+#   XLA_INCLUDE   - include tree of the extracted archive
+#   COMPILE_ITERS - compiles per configuration, the mean is reported (default 3)
+
+set -euo pipefail
+
+CXX="${CXX:-clang++}"
+CXXFLAGS="${CXXFLAGS:-}"
+PCH="${PCH:-xla_extension.h.pch}"
+XLA_INCLUDE="${XLA_INCLUDE:-./xla_extension/include}"
+COMPILE_ITERS="${COMPILE_ITERS:-3}"
+
+if [ $# -eq 0 ]; then
+  echo "usage: $0 SOURCE..." >&2
+  exit 1
+fi
+
+out_dir=$(mktemp -d)
+trap 'rm -rf "$out_dir"' EXIT
+
+include_files=$(find "$XLA_INCLUDE" -type f | wc -l | tr -d ' ')
+include_bytes=$(find "$XLA_INCLUDE" -type f -exec cat {} + | wc -c | tr -d ' ')
+
+echo "{\"suite\": \"compile\", \"cxx\": \"$CXX\", \"include_files\": $include_files, \"include_bytes\": $include_bytes, \"results\": ["
+first=true
+
+for source in "$@"; do
+  for mode in no_pch pch; do
+    pch_flags=""
+    if [ "$mode" = pch ]; then
+      pch_flags="-include-pch $PCH"
+    fi
+
+    TIMEFORMAT=%R
+    total=0
+    for _ in $(seq "$COMPILE_ITERS"); do
+      # shellcheck disable=SC2086
+      if ! seconds=$( { time $CXX $CXXFLAGS $pch_flags -c "$source" -o "$out_dir/out.o" \
+                        > "$out_dir/compile.log" 2>&1; } 2>&1 ); then
+        cat "$out_dir/compile.log" >&2
+        exit 1
+      fi
+      total=$(awk -v a="$total" -v b="$seconds" 'BEGIN { print a + b }')
+    done
+    mean=$(awk -v t="$total" -v n="$COMPILE_ITERS" 'BEGIN { print t / n }')
+
+    $first || echo ","
+    first=false
+    printf '  {"source": "%s", "mode": "%s", "compile_seconds": %s}' "$source" "$mode" "$mean"
+    echo "Compiled $source ($mode) in ${mean}s" >&2
+  done
+done
+
+echo ""
+echo "]}"
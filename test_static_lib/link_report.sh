@@ -0,0 +1,81 @@
+#!/usr/bin/env bash
+#
+# Links each given object file against the monolithic libxla_extension.a
+# and against the layered archives it needs, and prints a JSON report
+# with link time and binary size on stdout.
+#
+# Environment:
+#   CXX         - compiler driver used for linking (default clang++)
+#   XLA_LIB_DIR - directory with the archives, .link and .deps files
+#   LINK_LAYERS - archives to compare (default "xla_extension xla_core")
+#   LINK_ITERS  - links per configuration, the mean is reported (default 3)
+
+set -euo pipefail
+
+CXX="${CXX:-clang++}"
+XLA_LIB_DIR="${XLA_LIB_DIR:-./xla_extension/lib}"
+LINK_LAYERS="${LINK_LAYERS:-xla_extension xla_core}"
+LINK_ITERS="${LINK_ITERS:-3}"
+
+if [ $# -eq 0 ]; then
+  echo "usage: $0 OBJECT..." >&2
+  exit 1
+fi
+
+out_dir=$(mktemp -d)
+trap 'rm -rf "$out_dir"' EXIT
+
+file_size() {
+  wc -c < "$1" | tr -d ' '
+}
+
+echo "{\"suite\": \"link\", \"cxx\": \"$CXX\", \"results\": ["
+first=true
+
+for layer in $LINK_LAYERS; do
+  if [ ! -f "$XLA_LIB_DIR/lib$layer.deps" ]; then
+    echo "Skipping $layer, $XLA_LIB_DIR/lib$layer.deps not found" >&2
+    continue
+  fi
+
+  libs=""
+  archive_bytes=0
+  while read -r lib; do
+    [ -n "$lib" ] || continue
+    libs="$libs -l$lib"
+    archive_bytes=$((archive_bytes + $(file_size "$XLA_LIB_DIR/lib$lib.a")))
+  done < "$XLA_LIB_DIR/lib$layer.deps"
+  link_flags=$(cat "$XLA_LIB_DIR/lib$layer.link")
+
+  for object in "$@"; do
+    program="$(basename "$object" .o)"
+    binary="$out_dir/${program}_$layer"
+
+    TIMEFORMAT=%R
+    total=0
+    for _ in $(seq "$LINK_ITERS"); do
+      rm -f "$binary"
+      # shellcheck disable=SC2086
+      if ! seconds=$( { time "$CXX" -o "$binary" "$object" -L"$XLA_LIB_DIR" $libs $link_flags \
+                        > "$out_dir/link.log" 2>&1; } 2>&1 ); then
+        cat "$out_dir/link.log" >&2
+        exit 1
+      fi
+      total=$(awk -v a="$total" -v b="$seconds" 'BEGIN { print a + b }')
+    done
+    mean=$(awk -v t="$total" -v n="$LINK_ITERS" 'BEGIN { print t / n }')
+
+    binary_bytes=$(file_size "$binary")
+    strip -o "$binary.stripped" "$binary" 2>/dev/null || cp "$binary" "$binary.stripped"
+    stripped_bytes=$(file_size "$binary.stripped")
+
+    $first || echo ","
+    first=false
+    printf '  {"archive": "%s", "program": "%s", "link_seconds": %s, "binary_bytes": %s, "stripped_bytes": %s, "archive_bytes": %s}' \
+      "$layer" "$program" "$mean" "$binary_bytes" "$stripped_bytes" "$archive_bytes"
+    echo "Linked $program against $layer in ${mean}s" >&2
+  done
+done
+
+echo ""
+echo "]}"
@@ -0,0 +1,77 @@
+/**
+ * HLO graphs equivalent to the custom-call kernels of
+ * xla/extension/spatial_kernels.h, built from DotGeneral, slices and
+ * elementwise ops. Used as the reference by test_spatial_kernels and as
+ * the baseline by bench_spatial_kernels. Operands have a single leading
+ * batch dimension.
+ */
+
+#ifndef XLA_TEST_STATIC_LIB_SPATIAL_HLO_H_
+#define XLA_TEST_STATIC_LIB_SPATIAL_HLO_H_
+
+#include <array>
+#include <cstdint>
+
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/xla_data.pb.h"
+
+namespace spatial_hlo {
+
+// Component i of a [batch, k] array, as [batch, 1]
+inline xla::XlaOp Component(xla::XlaOp x, int64_t i) {
+    return xla::SliceInDim(x, i, i + 1, 1, 1);
+}
+
+inline std::array<xla::XlaOp, 3> Cross(const std::array<xla::XlaOp, 3>& a,
+                                       const std::array<xla::XlaOp, 3>& b) {
+    return {a[1] * b[2] - a[2] * b[1],
+            a[2] * b[0] - a[0] * b[2],
+            a[0] * b[1] - a[1] * b[0]};
+}
+
+// Batched matrix product, [batch, n, k] x [batch, k(, m)]
+inline xla::XlaOp BatchedDot(xla::XlaOp a, xla::XlaOp b) {
+    xla::DotDimensionNumbers dnums;
+    dnums.add_lhs_batch_dimensions(0);
+    dnums.add_rhs_batch_dimensions(0);
+    dnums.add_lhs_contracting_dimensions(2);
+    dnums.add_rhs_contracting_dimensions(1);
+    return xla::DotGeneral(a, b, dnums);
+}
+
+// Hamilton product of [batch, 4] quaternions (w, x, y, z)
+inline xla::XlaOp QuaternionMultiply(xla::XlaOp p, xla::XlaOp q) {
+    auto pw = Component(p, 0), px = Component(p, 1), py = Component(p, 2), pz = Component(p, 3);
+    auto qw = Component(q, 0), qx = Component(q, 1), qy = Component(q, 2), qz = Component(q, 3);
+    return xla::ConcatInDim(p.builder(),
+                            {pw * qw - px * qx - py * qy - pz * qz,
+                             pw * qx + px * qw + py * qz - pz * qy,
+                             pw * qy - px * qz + py * qw + pz * qx,
+                             pw * qz + px * qy - py * qx + pz * qw},
+                            1);
+}
+
+// Vector part of q * (0, v) * conj(q)
+inline xla::XlaOp QuaternionRotate(xla::XlaOp q, xla::XlaOp v) {
+    xla::XlaBuilder* builder = q.builder();
+    auto zero = xla::ZerosLike(Component(v, 0));
+    auto pure = xla::ConcatInDim(builder, {zero, v}, 1);
+    auto conj = xla::ConcatInDim(builder, {Component(q, 0), -xla::SliceInDim(q, 1, 4, 1, 1)}, 1);
+    return xla::SliceInDim(QuaternionMultiply(QuaternionMultiply(q, pure), conj), 1, 4, 1, 1);
+}
+
+// (E w; E (v - r x w)) for E [batch, 3, 3], r [batch, 3], m = (w; v) [batch, 6]
+inline xla::XlaOp SpatialMotionTransform(xla::XlaOp e, xla::XlaOp r, xla::XlaOp m) {
+    xla::XlaBuilder* builder = e.builder();
+    std::array<xla::XlaOp, 3> w = {Component(m, 0), Component(m, 1), Component(m, 2)};
+    std::array<xla::XlaOp, 3> rv = {Component(r, 0), Component(r, 1), Component(r, 2)};
+    auto rxw = Cross(rv, w);
+    auto d = xla::SliceInDim(m, 3, 6, 1, 1) - xla::ConcatInDim(builder, {rxw[0], rxw[1], rxw[2]}, 1);
+    auto angular = BatchedDot(e, xla::SliceInDim(m, 0, 3, 1, 1));
+    auto linear = BatchedDot(e, d);
+    return xla::ConcatInDim(builder, {angular, linear}, 1);
+}
+
+}  // namespace spatial_hlo
+
+#endif  // XLA_TEST_STATIC_LIB_SPATIAL_HLO_H_
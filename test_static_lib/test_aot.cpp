@@ -0,0 +1,182 @@
+/**
+ * XLA Ahead-of-Time Compilation Test
+ *
+ * Verifies the compile-export and load path of xla/extension/aot.h:
+ * 1. Artifact encoding round trip
+ * 2. A loaded executable matches the compiled one
+ * 3. Artifacts written to and read from disk, on a fresh client
+ * 4. Compiling for a lower instruction set
+ * 5. Corrupt and incompatible artifacts are rejected, including artifacts
+ *    built for the host CPU on a machine with features this one lacks
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/aot.h"
+#include "absl/status/statusor.h"
+#include "absl/status/status.h"
+
+#include "test_common.h"
+
+using namespace xla;
+using tests::CheckOr;
+using tests::Expect;
+using namespace xla::extension;
+
+bool Near(const Literal& actual, const Literal& expected) {
+    auto a = actual.data<float>();
+    auto e = expected.data<float>();
+    if (a.size() != e.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (std::abs(a[i] - e[i]) > 1e-5f) return false;
+    }
+    return true;
+}
+
+// tanh(a @ b) on a 2x3 and a 3x2 matrix
+XlaComputation BuildModel() {
+    XlaBuilder builder("model");
+    Tanh(Dot(Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {2, 3}), "a"),
+             Parameter(&builder, 1, ShapeUtil::MakeShape(F32, {3, 2}), "b")));
+    return CheckOr(builder.Build(), "Building model");
+}
+
+Literal Run(PjRtClient* client, PjRtLoadedExecutable* executable) {
+    Literal a = LiteralUtil::CreateR2<float>({{0.1f, 0.2f, 0.3f}, {0.4f, 0.5f, 0.6f}});
+    Literal b = LiteralUtil::CreateR2<float>({{0.1f, 0.2f}, {0.3f, 0.4f}, {0.5f, 0.6f}});
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+    auto a_buffer = CheckOr(client->BufferFromHostLiteral(a, memory_space), "Transferring a");
+    auto b_buffer = CheckOr(client->BufferFromHostLiteral(b, memory_space), "Transferring b");
+    std::vector<std::vector<PjRtBuffer*>> argument_handles = {{a_buffer.get(), b_buffer.get()}};
+    ExecuteOptions execute_options;
+    auto results = CheckOr(executable->Execute(argument_handles, execute_options), "Executing");
+    return std::move(*CheckOr(results[0][0]->ToLiteralSync(), "Reading back"));
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "XLA Ahead-of-Time Compilation Test" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    auto client = CheckOr(GetPjRtCpuClient(CpuClientOptions()), "Creating CPU client");
+    XlaComputation model = BuildModel();
+    CompileOptions compile_options;
+    auto artifact = CheckOr(CompileForExport(client.get(), model, compile_options, AotTarget()),
+                            "Compiling for export");
+
+    // Test 1: Encoding
+    std::cout << "\nTest 1: Artifact encoding..." << std::endl;
+    {
+        std::string encoded = SerializeAotArtifact(artifact);
+        auto parsed = CheckOr(ParseAotArtifact(encoded), "Parsing artifact");
+        Expect(parsed.platform_name == artifact.platform_name &&
+                   parsed.platform_version == artifact.platform_version,
+               "Platform survives the round trip");
+        Expect(parsed.executable == artifact.executable, "Executable survives the round trip");
+        Expect(parsed.cpu_features == artifact.cpu_features,
+               "CPU features survive the round trip");
+#if defined(__x86_64__)
+        Expect(!artifact.cpu_features.empty(),
+               "Host CPU features are recorded without a target instruction set");
+#endif
+        Expect(parsed.program_shape.parameters_size() == 2 &&
+                   ShapeUtil::Equal(parsed.program_shape.result(),
+                                    ShapeUtil::MakeShape(F32, {2, 2})),
+               "Program shape survives the round trip");
+    }
+
+    // Test 2: Loading
+    std::cout << "\nTest 2: Loaded executable..." << std::endl;
+    {
+        auto compiled = CheckOr(client->CompileAndLoad(model, compile_options), "Compiling");
+        auto loaded = CheckOr(LoadAotExecutable(client.get(), artifact), "Loading");
+        Expect(Run(client.get(), loaded.get()) == Run(client.get(), compiled.get()),
+               "Loaded executable matches the compiled one");
+    }
+
+    // Test 3: Files
+    std::cout << "\nTest 3: Artifacts on disk..." << std::endl;
+    const std::string path = "aot_test_model.xla_aot";
+    {
+        Expect(WriteAotArtifact(path, artifact).ok(), "Artifact written");
+        // A separate client stands in for a production process
+        auto runtime = CheckOr(GetPjRtCpuClient(CpuClientOptions()), "Creating runtime client");
+        auto read = CheckOr(ReadAotArtifact(path), "Reading artifact");
+        auto loaded = CheckOr(LoadAotExecutable(runtime.get(), read), "Loading");
+        Literal expected = LiteralUtil::CreateR2<float>(
+            {{std::tanh(0.22f), std::tanh(0.28f)}, {std::tanh(0.49f), std::tanh(0.64f)}});
+        Expect(Near(Run(runtime.get(), loaded.get()), expected),
+               "Fresh client runs the artifact");
+    }
+
+    // Test 4: Target instruction set
+    std::cout << "\nTest 4: Lower instruction set..." << std::endl;
+    {
+#if defined(__x86_64__)
+        AotTarget target;
+        target.max_isa = "SSE4_2";
+        auto portable = CheckOr(CompileForExport(client.get(), model, compile_options, target),
+                                "Compiling for SSE4_2");
+        Expect(portable.max_isa == "SSE4_2" && portable.cpu_features.empty(),
+               "Target is recorded instead of the host features");
+        auto loaded = CheckOr(LoadAotExecutable(client.get(), portable), "Loading");
+        auto reference = CheckOr(LoadAotExecutable(client.get(), artifact), "Loading");
+        // Without FMA the rounding may differ in the last bits
+        Expect(Near(Run(client.get(), loaded.get()), Run(client.get(), reference.get())),
+               "SSE4_2 build computes the same result");
+#else
+        std::cout << "  (x86 only, skipped)" << std::endl;
+#endif
+    }
+
+    // Test 5: Errors
+    std::cout << "\nTest 5: Invalid artifacts..." << std::endl;
+    {
+        std::string encoded = SerializeAotArtifact(artifact);
+        Expect(!ParseAotArtifact("not an artifact").ok(), "Foreign files are rejected");
+        Expect(!ParseAotArtifact(encoded.substr(0, encoded.size() / 2)).ok(),
+               "Truncated artifacts are rejected");
+
+        AotArtifact other_platform = artifact;
+        other_platform.platform_name = "gpu";
+        Expect(absl::IsFailedPrecondition(LoadAotExecutable(client.get(), other_platform).status()),
+               "Artifacts of another platform are rejected");
+
+        AotArtifact unknown_isa = artifact;
+        unknown_isa.max_isa = "NOT_AN_ISA";
+        Expect(absl::IsFailedPrecondition(CheckAotCompatible(client.get(), unknown_isa)),
+               "Unknown instruction sets are rejected");
+
+        // Stands in for a feature of a newer build machine
+        AotArtifact newer_cpu = artifact;
+        newer_cpu.cpu_features.push_back("NOT_A_FEATURE");
+        auto parsed = CheckOr(ParseAotArtifact(SerializeAotArtifact(newer_cpu)), "Parsing");
+        auto status = LoadAotExecutable(client.get(), parsed).status();
+        Expect(absl::IsFailedPrecondition(status) &&
+                   std::string(status.message()).find("NOT_A_FEATURE") != std::string::npos,
+               "Artifacts needing CPU features the host lacks are rejected");
+        Expect(!ReadAotArtifact("does_not_exist.xla_aot").ok(), "Missing files are rejected");
+    }
+
+    std::remove(path.c_str());
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "✓ All ahead-of-time compilation tests passed!" << std::endl;
+    std::cout << "========================================" << std::endl;
+    return 0;
+}
@@ -0,0 +1,45 @@
+/**
+ * Shared helpers for the XLA static library extension tests.
+ *
+ * Every test_*.cpp program for xla/extension prints numbered test
+ * sections with one ✓ line per passed expectation on stdout, and exits
+ * with status 1 at the first failure.
+ */
+
+#ifndef XLA_TEST_STATIC_LIB_TEST_COMMON_H_
+#define XLA_TEST_STATIC_LIB_TEST_COMMON_H_
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include "absl/status/statusor.h"
+
+namespace tests {
+
+// Whether passed expectations are printed, failures always are
+inline bool g_verbose = true;
+
+// Helper function to check StatusOr and exit on error
+template<typename T>
+T CheckOr(absl::StatusOr<T> status_or, const std::string& context) {
+    if (!status_or.ok()) {
+        std::cerr << "ERROR in " << context << ": "
+                  << status_or.status().message() << std::endl;
+        exit(1);
+    }
+    return std::move(status_or).value();
+}
+
+inline void Expect(bool condition, const std::string& message) {
+    if (!condition) {
+        std::cerr << "  ✗ " << message << std::endl;
+        exit(1);
+    }
+    if (g_verbose) std::cout << "  ✓ " << message << std::endl;
+}
+
+}  // namespace tests
+
+#endif  // XLA_TEST_STATIC_LIB_TEST_COMMON_H_
@@ -0,0 +1,199 @@
+/**
+ * XLA CPU Placement Test
+ *
+ * Verifies the thread and memory placement of xla/extension/cpu_affinity.h:
+ * 1. Parsing Linux CPU lists
+ * 2. NUMA topology discovery
+ * 3. A placed client runs computations and leaves the caller unpinned
+ * 4. Worker threads started by the client are pinned to the CPU set
+ * 5. Pinning the calling thread
+ * 6. Invalid placements are rejected
+ *
+ * Placement is Linux only, elsewhere only the error paths are checked.
+ */
+
+#include <dirent.h>
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/cpu_affinity.h"
+#include "absl/status/statusor.h"
+#include "absl/status/status.h"
+
+#include "test_common.h"
+
+using namespace xla;
+using tests::CheckOr;
+using tests::Expect;
+using namespace xla::extension;
+
+bool RunsAdd(PjRtClient* client) {
+    XlaBuilder builder("add");
+    Shape shape = ShapeUtil::MakeShape(F32, {4});
+    Add(Parameter(&builder, 0, shape, "a"), Parameter(&builder, 1, shape, "b"));
+    auto computation = CheckOr(builder.Build(), "Building computation");
+    CompileOptions compile_options;
+    auto executable = CheckOr(client->CompileAndLoad(computation, compile_options), "Compiling");
+
+    Literal a = LiteralUtil::CreateR1<float>({1, 2, 3, 4});
+    Literal b = LiteralUtil::CreateR1<float>({10, 20, 30, 40});
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+    auto a_buffer = CheckOr(client->BufferFromHostLiteral(a, memory_space), "Transferring a");
+    auto b_buffer = CheckOr(client->BufferFromHostLiteral(b, memory_space), "Transferring b");
+    std::vector<std::vector<PjRtBuffer*>> argument_handles = {{a_buffer.get(), b_buffer.get()}};
+    ExecuteOptions execute_options;
+    auto results = CheckOr(executable->Execute(argument_handles, execute_options), "Executing");
+    auto literal = CheckOr(results[0][0]->ToLiteralSync(), "Reading back");
+    return *literal == LiteralUtil::CreateR1<float>({11, 22, 33, 44});
+}
+
+#if defined(__linux__)
+// Thread ids of the process
+std::set<std::string> Threads() {
+    std::set<std::string> threads;
+    if (DIR* dir = opendir("/proc/self/task")) {
+        while (dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') threads.insert(entry->d_name);
+        }
+        closedir(dir);
+    }
+    return threads;
+}
+
+// Cpus_allowed_list of a thread, for example "0-3"
+std::string AllowedCpuList(const std::string& tid) {
+    std::ifstream status("/proc/self/task/" + tid + "/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("Cpus_allowed_list:", 0) == 0) {
+            size_t start = line.find_first_not_of(" \t", line.find(':') + 1);
+            return line.substr(start);
+        }
+    }
+    return "";
+}
+
+std::string CurrentAllowedCpuList() {
+    return AllowedCpuList(std::to_string(syscall(SYS_gettid)));
+}
+#endif
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "XLA CPU Placement Test" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    // Test 1: CPU lists
+    std::cout << "\nTest 1: Parsing CPU lists..." << std::endl;
+    {
+        auto cpus = CheckOr(ParseCpuList("0-3,8-11"), "Parsing CPU list");
+        Expect(cpus == std::vector<int>({0, 1, 2, 3, 8, 9, 10, 11}), "Ranges are expanded");
+        Expect(CheckOr(ParseCpuList("5"), "Parsing CPU list") == std::vector<int>({5}),
+               "Single CPUs are parsed");
+        Expect(CheckOr(ParseCpuList(""), "Parsing CPU list").empty(), "Empty list is empty");
+        Expect(!ParseCpuList("3-1").ok() && !ParseCpuList("a,b").ok(), "Malformed lists are rejected");
+    }
+
+#if defined(__linux__)
+    // Test 2: Topology
+    std::cout << "\nTest 2: NUMA topology..." << std::endl;
+    const int nodes = NumaNodeCount();
+    auto node_cpus = CheckOr(NumaNodeCpus(0), "Getting the CPUs of node 0");
+    std::cout << "  " << nodes << " NUMA node(s), " << node_cpus.size() << " CPU(s) on node 0"
+              << std::endl;
+    Expect(nodes >= 1 && !node_cpus.empty(), "Node 0 has CPUs");
+    Expect(!NumaNodeCpus(nodes + 64).ok(), "Missing nodes are rejected");
+
+    const int cpu = node_cpus.front();
+    CpuPlacement placement;
+    placement.cpus = {cpu};
+    placement.numa_node = 0;
+
+    // Test 3: Placed client
+    std::cout << "\nTest 3: Placed client..." << std::endl;
+    std::set<std::string> threads_before = Threads();
+    const std::string caller_cpus = CurrentAllowedCpuList();
+    CpuClientOptions options;
+    options.asynchronous = true;
+    auto client = CheckOr(GetPlacedCpuClient(options, placement), "Creating placed client");
+    std::set<std::string> threads_after = Threads();
+    Expect(CurrentAllowedCpuList() == caller_cpus, "Caller's affinity is restored");
+    Expect(RunsAdd(client.get()), "Placed client computes correctly");
+
+    // Test 4: Worker threads
+    std::cout << "\nTest 4: Worker threads..." << std::endl;
+    {
+        int started = 0, pinned = 0;
+        for (const std::string& tid : threads_after) {
+            if (threads_before.count(tid)) continue;
+            started++;
+            if (AllowedCpuList(tid) == std::to_string(cpu)) pinned++;
+        }
+        std::cout << "  " << pinned << " of " << started << " new threads on CPU " << cpu << std::endl;
+        Expect(started > 0 && pinned == started, "Threads started by the client are pinned");
+    }
+
+    // Test 5: Calling thread
+    std::cout << "\nTest 5: Pinning the calling thread..." << std::endl;
+    {
+        cpu_set_t original;
+        sched_getaffinity(0, sizeof(original), &original);
+        Expect(PlaceCurrentThread(placement).ok(), "Thread placed");
+        sched_yield();
+        Expect(sched_getcpu() == cpu, "Thread runs on the placed CPU");
+        Expect(RunsAdd(client.get()), "Pinned thread feeds the placed client");
+        sched_setaffinity(0, sizeof(original), &original);
+    }
+
+    // Test 6: Invalid placements
+    std::cout << "\nTest 6: Invalid placements..." << std::endl;
+    {
+        CpuPlacement too_many;
+        too_many.cpus = {cpu};
+        too_many.intra_op_threads = 2;
+        Expect(!GetPlacedCpuClient(options, too_many).ok(), "More intra-op threads than CPUs fail");
+
+        CpuPlacement out_of_range;
+        out_of_range.cpus = {1 << 20};
+        Expect(!GetPlacedCpuClient(options, out_of_range).ok(), "Out-of-range CPUs fail");
+        Expect(CurrentAllowedCpuList() == caller_cpus, "Failures leave the caller unchanged");
+    }
+#else
+    std::cout << "\nTest 2-6: Placement is not supported on this platform..." << std::endl;
+    {
+        CpuPlacement placement;
+        placement.cpus = {0};
+        Expect(absl::IsUnimplemented(GetPlacedCpuClient(CpuClientOptions(), placement).status()),
+               "Placed clients are unimplemented");
+        auto client = CheckOr(GetPlacedCpuClient(CpuClientOptions(), CpuPlacement()),
+                              "Creating client without placement");
+        Expect(RunsAdd(client.get()), "Empty placement creates a regular client");
+    }
+#endif
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "✓ All CPU placement tests passed!" << std::endl;
+    std::cout << "========================================" << std::endl;
+    return 0;
+}
@@ -0,0 +1,216 @@
+/**
+ * XLA Executable Cache Test
+ *
+ * Verifies xla::extension::ExecutableCache by simulating two process
+ * startups against the same cache directory:
+ * 1. First startup compiles and stores the executable
+ * 2. Second startup (fresh client and cache) loads it without compiling
+ * 3. The loaded executable produces correct results
+ * 4. A corrupted entry falls back to compilation
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/executable_cache.h"
+#include "absl/status/statusor.h"
+#include "absl/status/status.h"
+
+#include "test_common.h"
+
+using namespace xla;
+using tests::CheckOr;
+using tests::Expect;
+using xla::extension::ExecutableCache;
+
+// Removed at exit, including when a check fails
+std::string g_temp_dir;
+
+void RemoveTempDir() {
+    std::error_code error;
+    std::filesystem::remove_all(g_temp_dir, error);
+}
+
+std::unique_ptr<PjRtClient> CreateCpuClient() {
+    CpuClientOptions options;
+    options.asynchronous = true;
+    options.cpu_device_count = 1;
+    return CheckOr(GetPjRtCpuClient(options), "Creating CPU client");
+}
+
+// A graph with a few ops, so that compilation takes measurable time
+XlaComputation BuildComputation() {
+    XlaBuilder builder("cached_computation");
+    Shape shape = ShapeUtil::MakeShape(F32, {4});
+    auto x = Parameter(&builder, 0, shape, "x");
+    auto y = Parameter(&builder, 1, shape, "y");
+    // (x + y) * (x - y) + x^2
+    Add(Mul(Add(x, y), Sub(x, y)), Mul(x, x));
+    return CheckOr(builder.Build(), "Building computation");
+}
+
+CompileOptions MakeCompileOptions() {
+    CompileOptions options;
+    options.executable_build_options.set_num_replicas(1);
+    options.executable_build_options.set_num_partitions(1);
+    return options;
+}
+
+double MillisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+void VerifyExecution(PjRtClient* client, PjRtLoadedExecutable* executable) {
+    std::vector<float> x_data = {1.0f, 2.0f, 3.0f, 4.0f};
+    std::vector<float> y_data = {4.0f, 3.0f, 2.0f, 1.0f};
+
+    auto memory_space = CheckOr(
+        client->addressable_devices()[0]->default_memory_space(),
+        "Getting default memory space"
+    );
+    auto x_buffer = CheckOr(
+        client->BufferFromHostLiteral(LiteralUtil::CreateR1<float>(x_data), memory_space),
+        "Transferring x to device"
+    );
+    auto y_buffer = CheckOr(
+        client->BufferFromHostLiteral(LiteralUtil::CreateR1<float>(y_data), memory_space),
+        "Transferring y to device"
+    );
+
+    std::vector<std::vector<PjRtBuffer*>> argument_handles = {
+        {x_buffer.get(), y_buffer.get()}
+    };
+    ExecuteOptions execute_options;
+    auto results = CheckOr(
+        executable->Execute(argument_handles, execute_options),
+        "Executing computation"
+    );
+    auto result = CheckOr(results[0][0]->ToLiteralSync(), "Transferring result to host");
+
+    bool correct = true;
+    for (int i = 0; i < 4; i++) {
+        float x = x_data[i], y = y_data[i];
+        float expected = (x + y) * (x - y) + x * x;
+        if (std::abs(result->data<float>()[i] - expected) > 1e-5) {
+            correct = false;
+        }
+    }
+    Expect(correct, "Results verified correct");
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "XLA Executable Cache Test" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    char dir_template[] = "/tmp/xla_executable_cache_XXXXXX";
+    if (mkdtemp(dir_template) == nullptr) {
+        std::cerr << "ERROR: could not create cache directory" << std::endl;
+        return 1;
+    }
+    g_temp_dir = dir_template;
+    std::atexit(RemoveTempDir);
+    std::string cache_dir = g_temp_dir + "/cache";
+    std::cout << "Cache directory: " << cache_dir << std::endl;
+
+    auto computation = BuildComputation();
+    auto compile_options = MakeCompileOptions();
+
+    // Test 1: First startup compiles and stores
+    std::cout << "\nTest 1: First startup (cold cache)..." << std::endl;
+    {
+        auto client = CreateCpuClient();
+        ExecutableCache cache(cache_dir);
+
+        auto start = std::chrono::steady_clock::now();
+        auto executable = CheckOr(
+            cache.CompileAndLoad(client.get(), computation, compile_options),
+            "Compiling through cache"
+        );
+        std::cout << "  Took " << MillisSince(start) << " ms" << std::endl;
+
+        Expect(cache.stats().misses == 1, "Executable was compiled");
+        Expect(cache.stats().hits == 0, "No cache hits");
+        Expect(cache.stats().stores == 1, "Executable was stored");
+        VerifyExecution(client.get(), executable.get());
+    }
+
+    // Test 2: Second startup loads from disk
+    std::cout << "\nTest 2: Second startup (warm cache)..." << std::endl;
+    {
+        auto client = CreateCpuClient();
+        ExecutableCache cache(cache_dir);
+
+        auto start = std::chrono::steady_clock::now();
+        auto executable = CheckOr(
+            cache.CompileAndLoad(client.get(), computation, compile_options),
+            "Loading through cache"
+        );
+        std::cout << "  Took " << MillisSince(start) << " ms" << std::endl;
+
+        Expect(cache.stats().hits == 1, "Executable was loaded from cache");
+        Expect(cache.stats().misses == 0, "Compilation was skipped");
+        VerifyExecution(client.get(), executable.get());
+    }
+
+    // Test 3: Different options produce a different key
+    std::cout << "\nTest 3: Cache key sensitivity..." << std::endl;
+    {
+        auto client = CreateCpuClient();
+        ExecutableCache cache(cache_dir);
+
+        auto key = CheckOr(cache.Key(client.get(), computation, compile_options), "Computing key");
+        auto same_key = CheckOr(cache.Key(client.get(), computation, compile_options), "Computing key");
+
+        CompileOptions other_options = MakeCompileOptions();
+        other_options.executable_build_options.mutable_debug_options()
+            ->set_xla_cpu_enable_fast_math(true);
+        auto other_key = CheckOr(cache.Key(client.get(), computation, other_options), "Computing key");
+
+        std::cout << "  Key: " << key << std::endl;
+        Expect(key == same_key, "Key is deterministic");
+        Expect(key != other_key, "Key depends on compile options");
+    }
+
+    // Test 4: Corrupted entry is recompiled and replaced
+    std::cout << "\nTest 4: Corrupted cache entry..." << std::endl;
+    {
+        auto client = CreateCpuClient();
+        ExecutableCache cache(cache_dir);
+
+        auto key = CheckOr(cache.Key(client.get(), computation, compile_options), "Computing key");
+        std::ofstream(cache_dir + "/" + key + ".xla_executable", std::ios::trunc) << "garbage";
+
+        auto executable = CheckOr(
+            cache.CompileAndLoad(client.get(), computation, compile_options),
+            "Compiling through cache"
+        );
+        Expect(cache.stats().load_failures == 1, "Corrupted entry was detected");
+        Expect(cache.stats().misses == 1 && cache.stats().stores == 1,
+               "Executable was recompiled and stored");
+        VerifyExecution(client.get(), executable.get());
+    }
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "✓ All tests passed successfully!" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+/**
+ * XLA HLO Loader Test
+ *
+ * Verifies xla/extension/hlo_loader.h, used by the xla_bench CLI, by
+ * loading the same matmul in every supported format and running it:
+ * 1. HLO text
+ * 2. Binary and text HloModuleProto
+ * 3. StableHLO MLIR
+ * 4. Format detection from the file extension
+ * 5. Invalid input is rejected with an error
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/hlo_loader.h"
+#include "absl/status/statusor.h"
+#include "absl/status/status.h"
+#include "google/protobuf/text_format.h"
+
+#include "test_common.h"
+
+using namespace xla;
+using tests::CheckOr;
+using tests::Expect;
+using namespace xla::extension;
+
+const char* kHloText = R"(
+HloModule matmul
+
+ENTRY main {
+  a = f32[2,3] parameter(0)
+  b = f32[3,2] parameter(1)
+  ROOT dot = f32[2,2] dot(a, b), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+}
+)";
+
+const char* kStablehlo = R"(
+module @matmul {
+  func.func public @main(%a: tensor<2x3xf32>, %b: tensor<3x2xf32>) -> tensor<2x2xf32> {
+    %0 = stablehlo.dot %a, %b : (tensor<2x3xf32>, tensor<3x2xf32>) -> tensor<2x2xf32>
+    return %0 : tensor<2x2xf32>
+  }
+}
+)";
+
+std::string WriteFile(const std::string& name, const std::string& contents) {
+    std::string path = "hlo_loader_test_" + name;
+    std::ofstream(path, std::ios::binary) << contents;
+    return path;
+}
+
+// Runs the loaded matmul on the inputs of ExecuteMatMul (test_xla.cpp)
+bool RunsMatMul(PjRtClient* client, const XlaComputation& computation) {
+    CompileOptions compile_options;
+    auto executable = CheckOr(client->CompileAndLoad(computation, compile_options), "Compiling");
+
+    Literal a = LiteralUtil::CreateR2<float>({{1, 2, 3}, {4, 5, 6}});
+    Literal b = LiteralUtil::CreateR2<float>({{1, 2}, {3, 4}, {5, 6}});
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+    auto a_buffer = CheckOr(client->BufferFromHostLiteral(a, memory_space), "Transferring a");
+    auto b_buffer = CheckOr(client->BufferFromHostLiteral(b, memory_space), "Transferring b");
+
+    std::vector<std::vector<PjRtBuffer*>> argument_handles = {{a_buffer.get(), b_buffer.get()}};
+    ExecuteOptions execute_options;
+    auto results = CheckOr(executable->Execute(argument_handles, execute_options), "Executing");
+    auto literal = CheckOr(results[0][0]->ToLiteralSync(), "Reading back");
+    return *literal == LiteralUtil::CreateR2<float>({{22, 28}, {49, 64}});
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "XLA HLO Loader Test" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    auto client = CheckOr(GetPjRtCpuClient(CpuClientOptions()), "Creating CPU client");
+    std::vector<std::string> paths;
+
+    // Test 1: HLO text
+    std::cout << "\nTest 1: HLO text..." << std::endl;
+    {
+        paths.push_back(WriteFile("matmul.hlo", kHloText));
+        auto computation = CheckOr(LoadComputation(paths.back()), "Loading HLO text");
+        Expect(RunsMatMul(client.get(), computation), "HLO text module runs");
+    }
+
+    // Test 2: HloModuleProto
+    std::cout << "\nTest 2: HloModuleProto..." << std::endl;
+    {
+        XlaBuilder builder("matmul");
+        Dot(Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {2, 3}), "a"),
+            Parameter(&builder, 1, ShapeUtil::MakeShape(F32, {3, 2}), "b"));
+        auto built = CheckOr(builder.Build(), "Building matmul");
+
+        paths.push_back(WriteFile("matmul.pb", built.proto().SerializeAsString()));
+        auto binary = CheckOr(LoadComputation(paths.back()), "Loading binary proto");
+        Expect(RunsMatMul(client.get(), binary), "Binary HloModuleProto runs");
+
+        std::string text;
+        google::protobuf::TextFormat::PrintToString(built.proto(), &text);
+        paths.push_back(WriteFile("matmul.pbtxt", text));
+        auto parsed = CheckOr(LoadComputation(paths.back()), "Loading text proto");
+        Expect(RunsMatMul(client.get(), parsed), "Text HloModuleProto runs");
+    }
+
+    // Test 3: StableHLO
+    std::cout << "\nTest 3: StableHLO MLIR..." << std::endl;
+    {
+        paths.push_back(WriteFile("matmul.mlir", kStablehlo));
+        auto computation = CheckOr(LoadComputation(paths.back()), "Loading StableHLO");
+        Expect(RunsMatMul(client.get(), computation), "StableHLO module runs");
+    }
+
+    // Test 4: Format detection
+    std::cout << "\nTest 4: Format detection..." << std::endl;
+    {
+        Expect(HloFormatFromPath("dump/module.txt").value() == HloFormat::kHloText &&
+                   HloFormatFromPath("module.pb").value() == HloFormat::kHloProto &&
+                   HloFormatFromPath("module.mlirbc").value() == HloFormat::kMlir,
+               "Formats are guessed from the extension");
+        Expect(!HloFormatFromPath("module.json").ok(), "Unknown extensions are rejected");
+
+        paths.push_back(WriteFile("matmul.module", kHloText));
+        auto computation = CheckOr(LoadComputation(paths.back(), HloFormat::kHloText),
+                                   "Loading with an explicit format");
+        Expect(RunsMatMul(client.get(), computation), "Explicit format overrides the extension");
+    }
+
+    // Test 5: Errors
+    std::cout << "\nTest 5: Invalid input..." << std::endl;
+    {
+        Expect(!ParseComputation("HloModule broken\nENTRY {", HloFormat::kHloText).ok(),
+               "Malformed HLO text is rejected");
+        Expect(!ParseComputation("\x01\x02garbage", HloFormat::kHloProto).ok(),
+               "Malformed proto is rejected");
+        Expect(!ParseComputation("func.func @main(", HloFormat::kMlir).ok(),
+               "Malformed MLIR is rejected");
+        Expect(!LoadComputation("does_not_exist.hlo").ok(), "Missing files are rejected");
+    }
+
+    for (const std::string& path : paths) std::remove(path.c_str());
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "✓ All HLO loader tests passed!" << std::endl;
+    std::cout << "========================================" << std::endl;
+    return 0;
+}
@@ -0,0 +1,266 @@
+/**
+ * XLA Pool Host Allocator Test
+ *
+ * Verifies the size-class pool in xla/extension/host_allocator.h:
+ * 1. Freed blocks are reused for requests of the same size class
+ * 2. Size classes and fragmentation accounting
+ * 3. Alignment, and over-aligned requests bypassing the pool
+ * 4. max_cached_bytes and Trim release memory to the system
+ * 5. Huge-page backed pool
+ * 6. Pooled buffers feed the CPU client without copies and return to
+ *    the pool, so a step loop stops missing after the first step
+ * 7. Concurrent allocation from several threads
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/host_allocator.h"
+#include "xla/extension/host_buffer.h"
+#include "absl/status/statusor.h"
+#include "absl/status/status.h"
+
+#include "test_common.h"
+
+using namespace xla;
+using tests::CheckOr;
+using tests::Expect;
+using namespace xla::extension;
+
+bool Aligned(const void* ptr, size_t alignment) {
+    return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+// The runtime may release host memory from one of its own threads
+bool WaitForLiveBytes(const PoolAllocator& pool, int64_t bytes) {
+    for (int i = 0; i < 1000 && pool.Stats().block_bytes_in_use != bytes; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return pool.Stats().block_bytes_in_use == bytes;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "XLA Pool Host Allocator Test" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    // Test 1: Reuse after free
+    std::cout << "\nTest 1: Freed blocks are reused..." << std::endl;
+    {
+        PoolAllocator pool;
+        void* first = pool.AllocateRaw(64, 4096);
+        pool.DeallocateRaw(first);
+        void* second = pool.AllocateRaw(64, 4000);
+        Expect(second == first, "Same size class returns the freed block");
+
+        PoolAllocatorStats stats = pool.Stats();
+        Expect(stats.allocations == 2 && stats.hits == 1 && stats.misses == 1,
+               "One hit and one miss are recorded");
+        pool.DeallocateRaw(second);
+        Expect(pool.Stats().bytes_in_use == 0 && pool.Stats().cached_bytes == 4096,
+               "Released block stays cached");
+    }
+
+    // Test 2: Size classes
+    std::cout << "\nTest 2: Size classes and fragmentation..." << std::endl;
+    {
+        Expect(PoolAllocator::BlockSize(1) == 64 && PoolAllocator::BlockSize(64) == 64,
+               "Small requests use 64-byte blocks");
+        Expect(PoolAllocator::BlockSize(65) == 96 && PoolAllocator::BlockSize(100) == 128 &&
+                   PoolAllocator::BlockSize(129) == 192 && PoolAllocator::BlockSize(193) == 256,
+               "Classes step by powers of two and their midpoints");
+
+        PoolAllocator pool;
+        void* ptr = pool.AllocateRaw(64, 100);
+        Expect(pool.RequestedSize(ptr) == 100 && pool.AllocatedSize(ptr) == 128,
+               "Requested and allocated sizes are tracked");
+        PoolAllocatorStats stats = pool.Stats();
+        Expect(std::abs(stats.fragmentation() - 28.0 / 128) < 1e-9,
+               "Rounding shows up as fragmentation");
+
+        void* other = pool.AllocateRaw(64, 200);
+        pool.DeallocateRaw(other);
+        void* next = pool.AllocateRaw(64, 100);
+        Expect(next != other, "Other size classes are not reused");
+        pool.DeallocateRaw(next);
+        pool.DeallocateRaw(ptr);
+    }
+
+    // Test 3: Alignment
+    std::cout << "\nTest 3: Alignment..." << std::endl;
+    {
+        PoolAllocator pool;
+        bool aligned = true;
+        std::vector<void*> ptrs;
+        for (size_t size : {1, 7, 100, 1000, 12345, 1 << 20}) {
+            ptrs.push_back(pool.AllocateRaw(8, size));
+            aligned = aligned && Aligned(ptrs.back(), kHostBufferAlignment);
+        }
+        Expect(aligned, "Pooled blocks are aligned to kHostBufferAlignment");
+
+        void* page = pool.AllocateRaw(4096, 100);
+        Expect(Aligned(page, 4096), "Over-aligned requests get their alignment");
+        pool.DeallocateRaw(page);
+        Expect(pool.Stats().cached_bytes == 0, "Over-aligned blocks are not cached");
+
+        for (void* ptr : ptrs) pool.DeallocateRaw(ptr);
+    }
+
+    // Test 4: Cache limit and Trim
+    std::cout << "\nTest 4: Cached memory limits..." << std::endl;
+    {
+        PoolAllocatorOptions options;
+        options.max_cached_bytes = 8192;
+        options.max_block_size = 1 << 20;
+        PoolAllocator pool(options);
+
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 4; i++) ptrs.push_back(pool.AllocateRaw(64, 4096));
+        for (void* ptr : ptrs) pool.DeallocateRaw(ptr);
+        Expect(pool.Stats().cached_bytes == 8192, "Cache stops at max_cached_bytes");
+
+        void* large = pool.AllocateRaw(64, 2 << 20);
+        pool.DeallocateRaw(large);
+        Expect(pool.Stats().cached_bytes == 8192 && pool.Stats().misses == 5,
+               "Blocks above max_block_size bypass the pool");
+
+        pool.Trim();
+        Expect(pool.Stats().cached_bytes == 0, "Trim releases the cached blocks");
+        auto tsl_stats = pool.GetStats();
+        Expect(tsl_stats.has_value() && tsl_stats->num_allocs == 5 &&
+                   tsl_stats->largest_alloc_size == (2 << 20),
+               "tsl::AllocatorStats are reported");
+    }
+
+    // Test 5: Huge pages
+    std::cout << "\nTest 5: Huge-page backed pool..." << std::endl;
+    {
+        PoolAllocatorOptions options;
+        options.huge_pages = true;
+        PoolAllocator pool(options);
+
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 64; i++) ptrs.push_back(pool.AllocateRaw(64, 1000 + i));
+        void* large = pool.AllocateRaw(64, 3 << 20);
+        bool aligned = Aligned(large, kHostBufferAlignment);
+        for (void* ptr : ptrs) {
+            aligned = aligned && Aligned(ptr, kHostBufferAlignment);
+            std::memset(ptr, 1, 1000);
+        }
+        std::memset(large, 1, 3 << 20);
+        Expect(aligned, "Slab and huge-page blocks are aligned and writable");
+
+        for (void* ptr : ptrs) pool.DeallocateRaw(ptr);
+        pool.DeallocateRaw(large);
+        pool.Trim();
+        void* reused = pool.AllocateRaw(64, 1000);
+        Expect(pool.Stats().hits == 1, "Slab blocks survive Trim and are reused");
+        pool.DeallocateRaw(reused);
+    }
+
+    // Test 6: Device buffers from pooled memory
+    std::cout << "\nTest 6: Pooled buffers on the CPU client..." << std::endl;
+    {
+        CpuClientOptions client_options;
+        client_options.asynchronous = true;
+        client_options.cpu_device_count = 1;
+        auto client = CheckOr(GetPjRtCpuClient(client_options), "Creating CPU client");
+        auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                    "Getting default memory space");
+
+        const int64_t n = 1024;
+        XlaBuilder builder("add");
+        Shape shape = ShapeUtil::MakeShape(F32, {n});
+        Add(Parameter(&builder, 0, shape, "a"), Parameter(&builder, 1, shape, "b"));
+        auto computation = CheckOr(builder.Build(), "Building computation");
+        CompileOptions compile_options;
+        auto executable = CheckOr(client->CompileAndLoad(computation, compile_options), "Compiling");
+
+        auto pool = std::make_shared<PoolAllocator>();
+        std::vector<float> out(n);
+        int64_t misses_after_first_step = 0;
+        bool aliased = true, correct = true, returned = true;
+
+        for (int step = 0; step < 10; step++) {
+            PooledHostBuffer a(pool, n * sizeof(float)), b(pool, n * sizeof(float));
+            for (int64_t i = 0; i < n; i++) {
+                a.as_span<float>()[i] = static_cast<float>(step);
+                b.as_span<float>()[i] = static_cast<float>(i);
+            }
+            const void* a_data = a.data();
+            auto a_buffer = CheckOr(
+                BufferFromPooledHostBuffer(client.get(), memory_space, std::move(a), F32, {n}),
+                "Transferring a");
+            auto b_buffer = CheckOr(
+                BufferFromPooledHostBuffer(client.get(), memory_space, std::move(b), F32, {n}),
+                "Transferring b");
+            aliased = aliased && AliasesHostMemory(client.get(), a_buffer.get(), a_data);
+
+            std::vector<std::vector<PjRtBuffer*>> argument_handles = {{a_buffer.get(), b_buffer.get()}};
+            ExecuteOptions execute_options;
+            auto results = CheckOr(executable->Execute(argument_handles, execute_options), "Executing");
+            auto status = CopyToHostMemory(results[0][0].get(), out.data(), n * sizeof(float)).Await();
+            correct = correct && status.ok() && out[0] == step && out[n - 1] == step + n - 1;
+
+            a_buffer.reset();
+            b_buffer.reset();
+            results.clear();
+            returned = returned && WaitForLiveBytes(*pool, 0);
+            if (step == 0) misses_after_first_step = pool->Stats().misses;
+        }
+        Expect(aliased, "Device buffers alias the pooled memory");
+        Expect(correct, "Results are correct on every step");
+        Expect(returned, "Blocks return to the pool with the device buffers");
+        Expect(pool->Stats().misses == misses_after_first_step,
+               "No system allocation after the first step");
+
+        PooledHostBuffer small(pool, 16);
+        auto too_small = BufferFromPooledHostBuffer(client.get(), memory_space, std::move(small), F32, {n});
+        Expect(!too_small.ok(), "Buffers smaller than the shape are rejected");
+    }
+
+    // Test 7: Concurrent use
+    std::cout << "\nTest 7: Concurrent allocation..." << std::endl;
+    {
+        auto pool = std::make_shared<PoolAllocator>();
+        std::atomic<bool> ok{true};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; t++) {
+            threads.emplace_back([&pool, &ok, t] {
+                for (int i = 0; i < 1000; i++) {
+                    PooledHostBuffer buffer(pool, 64 + 32 * ((t + i) % 16));
+                    std::memset(buffer.data(), t, buffer.size());
+                    if (static_cast<unsigned char*>(buffer.data())[buffer.size() - 1] != t) {
+                        ok = false;
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        PoolAllocatorStats stats = pool->Stats();
+        Expect(ok.load(), "Blocks are not shared between threads");
+        Expect(stats.allocations == 8000 && stats.bytes_in_use == 0,
+               "All allocations are accounted for");
+        Expect(stats.hit_rate() > 0.9, "Most requests are served from the pool");
+    }
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "✓ All pool allocator tests passed!" << std::endl;
+    std::cout << "========================================" << std::endl;
+    return 0;
+}
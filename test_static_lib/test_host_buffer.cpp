@@ -0,0 +1,186 @@
+/**
+ * XLA Zero-Copy Host Buffer Test
+ *
+ * Verifies the Literal-free transfer path in xla/extension/host_buffer.h:
+ * 1. Aligned host memory is aliased by the device buffer (no copy)
+ * 2. Unaligned host memory is copied and released after the transfer
+ * 3. Execution on zero-copy inputs with readback into a caller buffer
+ * 4. Readback into a too small destination fails cleanly
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/host_buffer.h"
+#include "absl/status/statusor.h"
+#include "absl/status/status.h"
+
+#include "test_common.h"
+
+using namespace xla;
+using tests::CheckOr;
+using tests::Expect;
+using namespace xla::extension;
+
+// The runtime may release host memory from one of its own threads
+bool WaitFor(const std::atomic<bool>& flag) {
+    for (int i = 0; i < 1000 && !flag.load(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return flag.load();
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "XLA Zero-Copy Host Buffer Test" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    CpuClientOptions options;
+    options.asynchronous = true;
+    options.cpu_device_count = 1;
+    auto client = CheckOr(GetPjRtCpuClient(options), "Creating CPU client");
+    auto memory_space = CheckOr(
+        client->addressable_devices()[0]->default_memory_space(),
+        "Getting default memory space"
+    );
+
+    const int64_t n = 1024;
+
+    // Test 1: Aligned memory is aliased
+    std::cout << "\nTest 1: Zero-copy from aligned host memory..." << std::endl;
+    {
+        AlignedHostBuffer host(n * sizeof(float));
+        auto data = host.as_span<float>();
+        for (int64_t i = 0; i < n; i++) data[i] = static_cast<float>(i);
+        Expect(IsZeroCopyAligned(host.data()), "Host memory is aligned");
+
+        std::atomic<bool> released{false};
+        auto buffer = CheckOr(
+            BufferFromHostMemory(client.get(), memory_space, host.data(), F32, {n},
+                                 [&released]() { released = true; }),
+            "Creating buffer from host memory"
+        );
+        Expect(buffer->GetReadyFuture().Await().ok(), "Buffer is ready");
+        Expect(AliasesHostMemory(client.get(), buffer.get(), host.data()),
+               "Device buffer aliases host memory");
+        Expect(!released.load(), "Host memory is held while the buffer lives");
+
+        buffer.reset();
+        Expect(WaitFor(released), "Host memory is released with the buffer");
+    }
+
+    // Test 2: Unaligned memory is copied
+    std::cout << "\nTest 2: Copy from unaligned host memory..." << std::endl;
+    {
+        AlignedHostBuffer host((n + 1) * sizeof(float));
+        float* unaligned = host.as_span<float>().data() + 1;
+        for (int64_t i = 0; i < n; i++) unaligned[i] = static_cast<float>(i);
+        Expect(!IsZeroCopyAligned(unaligned), "Host memory is unaligned");
+
+        std::atomic<bool> released{false};
+        auto buffer = CheckOr(
+            BufferFromHostMemory(client.get(), memory_space, unaligned, F32, {n},
+                                 [&released]() { released = true; }),
+            "Creating buffer from host memory"
+        );
+        Expect(buffer->GetReadyFuture().Await().ok(), "Buffer is ready");
+        Expect(WaitFor(released), "Host memory is released after the transfer");
+        Expect(!AliasesHostMemory(client.get(), buffer.get(), unaligned),
+               "Device buffer owns a copy");
+
+        AlignedHostBuffer out(n * sizeof(float));
+        Expect(CopyToHostMemory(buffer.get(), out.data(), out.size()).Await().ok(),
+               "Readback completed");
+        bool correct = true;
+        for (int64_t i = 0; i < n; i++) {
+            if (out.as_span<float>()[i] != static_cast<float>(i)) correct = false;
+        }
+        Expect(correct, "Copied contents match");
+    }
+
+    // Test 3: Execute on zero-copy inputs, read back into caller memory
+    std::cout << "\nTest 3: Execution without Literals..." << std::endl;
+    {
+        XlaBuilder builder("add_computation");
+        Shape shape = ShapeUtil::MakeShape(F32, {n});
+        Add(Parameter(&builder, 0, shape, "a"), Parameter(&builder, 1, shape, "b"));
+        auto computation = CheckOr(builder.Build(), "Building computation");
+
+        CompileOptions compile_options;
+        auto executable = CheckOr(
+            client->CompileAndLoad(computation, compile_options),
+            "Compiling computation"
+        );
+
+        AlignedHostBuffer a(n * sizeof(float)), b(n * sizeof(float));
+        AlignedHostBuffer out(n * sizeof(float));
+        for (int64_t i = 0; i < n; i++) {
+            a.as_span<float>()[i] = static_cast<float>(i);
+            b.as_span<float>()[i] = static_cast<float>(10 * i);
+        }
+
+        // The same host and output memory is reused across steps
+        for (int step = 0; step < 3; step++) {
+            auto a_buffer = CheckOr(
+                BufferFromHostMemory(client.get(), memory_space, a.data(), F32, {n}),
+                "Creating buffer a"
+            );
+            auto b_buffer = CheckOr(
+                BufferFromHostMemory(client.get(), memory_space, b.data(), F32, {n}),
+                "Creating buffer b"
+            );
+            std::vector<std::vector<PjRtBuffer*>> argument_handles = {
+                {a_buffer.get(), b_buffer.get()}
+            };
+            ExecuteOptions execute_options;
+            auto results = CheckOr(
+                executable->Execute(argument_handles, execute_options),
+                "Executing computation"
+            );
+
+            auto readback = CopyToHostMemory(results[0][0].get(), out.data(), out.size());
+            if (!readback.Await().ok()) {
+                std::cerr << "  ✗ Readback failed" << std::endl;
+                return 1;
+            }
+
+            bool correct = true;
+            for (int64_t i = 0; i < n; i++) {
+                if (std::abs(out.as_span<float>()[i] - 11.0f * i) > 1e-3) correct = false;
+            }
+            Expect(correct, "Step " + std::to_string(step) + " results verified correct");
+        }
+    }
+
+    // Test 4: Destination size is validated
+    std::cout << "\nTest 4: Readback into a too small buffer..." << std::endl;
+    {
+        AlignedHostBuffer host(n * sizeof(float));
+        auto buffer = CheckOr(
+            BufferFromHostMemory(client.get(), memory_space, host.data(), F32, {n}),
+            "Creating buffer from host memory"
+        );
+        AlignedHostBuffer small(n);
+        Expect(!CopyToHostMemory(buffer.get(), small.data(), small.size()).Await().ok(),
+               "Readback reports an error");
+    }
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "✓ All tests passed successfully!" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,282 @@
+/**
+ * XLA Low-Precision Test
+ *
+ * Builds, compiles and executes computations in low-precision types on
+ * the CPU client, with xla/extension/low_precision.h:
+ * 1. BF16, F8E4M3FN and F8E5M2 literal and buffer transfers
+ * 2. Packed int4 and int8 transfers
+ * 3. Elementwise computations in each type
+ * 4. Mixed-precision Dot accumulating in F32 and S32
+ * 5. Weight-only quantized Dot with int4 and int8 weights
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/primitive_util.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/low_precision.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+
+#include "test_common.h"
+
+using namespace xla;
+using tests::CheckOr;
+using tests::Expect;
+using namespace xla::extension;
+
+std::string Name(PrimitiveType type) {
+    return primitive_util::LowercasePrimitiveTypeName(type);
+}
+
+// Values exactly representable in every float type tested, and 2x + 1
+// of them as well
+const std::vector<float> kFloatValues = {0.0f, 0.5f, -1.0f, 1.5f, 2.0f, -4.0f, 0.25f, 1.0f};
+// Same for int4
+const std::vector<float> kIntValues = {0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 3.0f, -4.0f, -3.0f};
+
+Literal ToF32(const Literal& literal) {
+    return CheckOr(literal.Convert(F32), "Converting to f32");
+}
+
+std::unique_ptr<PjRtLoadedExecutable> Compile(PjRtClient* client, XlaBuilder& builder) {
+    CompileOptions compile_options;
+    return CheckOr(client->CompileAndLoad(CheckOr(builder.Build(), "Building"),
+                                          compile_options),
+                   "Compiling " + builder.name());
+}
+
+std::shared_ptr<Literal> Run(PjRtLoadedExecutable* executable,
+                             std::vector<PjRtBuffer*> arguments) {
+    std::vector<std::vector<PjRtBuffer*>> argument_handles = {std::move(arguments)};
+    ExecuteOptions execute_options;
+    auto results = CheckOr(executable->Execute(argument_handles, execute_options), "Executing");
+    return CheckOr(results[0][0]->ToLiteralSync(), "Reading result");
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "XLA Low-Precision Test" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    auto client = CheckOr(GetPjRtCpuClient(CpuClientOptions()), "Creating CPU client");
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+    Literal float_values = LiteralUtil::CreateR1<float>(kFloatValues);
+    Literal int_values = LiteralUtil::CreateR1<float>(kIntValues);
+
+    // Test 1: Float transfers
+    std::cout << "\nTest 1: BF16 and F8 transfers..." << std::endl;
+    {
+        for (PrimitiveType type : {BF16, F8E4M3FN, F8E5M2}) {
+            Literal literal = CheckOr(float_values.Convert(type), "Converting");
+            auto buffer = CheckOr(client->BufferFromHostLiteral(literal, memory_space),
+                                  "Transferring");
+            auto readback = CheckOr(buffer->ToLiteralSync(), "Reading back");
+            Expect(IsLowPrecisionType(type) && buffer->on_device_shape().element_type() == type &&
+                       ToF32(*readback) == float_values,
+                   Name(type) + " round trips through a device buffer");
+        }
+        Literal rounded = CheckOr(LiteralUtil::CreateR1<float>({1.0f + 1.0f / 256}).Convert(BF16),
+                                  "Converting");
+        Expect(ToF32(rounded).data<float>()[0] == 1.0f, "f32 to bf16 rounds to nearest");
+    }
+
+    // Test 2: Integer transfers
+    std::cout << "\nTest 2: Packed int4 and int8 transfers..." << std::endl;
+    {
+        std::vector<int8_t> s4_values, u4_values;
+        for (int v = -8; v < 8; v++) s4_values.push_back(v);
+        for (int v = 0; v < 15; v++) u4_values.push_back(v);
+        Expect(PackedByteSize(S4, 16) == 8 && PackedByteSize(U4, 15) == 8 &&
+                   PackedByteSize(S8, 15) == 15 && PackedByteSize(F8E5M2, 3) == 3,
+               "Packed sizes round up to whole bytes");
+
+        std::vector<uint8_t> packed(8);
+        PackInt4(s4_values, absl::MakeSpan(packed));
+        Expect(packed[0] == 0x98 && packed[7] == 0x76, "Even elements go to the low nibble");
+        std::vector<int8_t> unpacked(16);
+        UnpackInt4(packed, /*is_signed=*/true, absl::MakeSpan(unpacked));
+        Expect(unpacked == s4_values, "s4 values survive packing");
+
+        auto s4 = CheckOr(BufferFromPackedInt4(client.get(), memory_space, packed, S4, {4, 4}),
+                          "Transferring s4");
+        Expect(s4->on_device_shape().element_type() == S4 &&
+                   CheckOr(PackedInt4FromBuffer(s4.get()), "Reading s4") == packed,
+               "s4 round trips through a device buffer");
+        std::cout << "    s4 [4, 4] takes "
+                  << CheckOr(s4->GetOnDeviceSizeInBytes(), "Getting size")
+                  << " bytes on the device" << std::endl;
+        auto s4_literal = CheckOr(s4->ToLiteralSync(), "Reading s4 literal");
+        Expect(CheckOr(s4_literal->Convert(S32), "Converting").data<int32_t>()[0] == -8,
+               "s4 literal holds signed values");
+
+        std::vector<uint8_t> u4_packed(8);
+        PackInt4(u4_values, absl::MakeSpan(u4_packed));
+        auto u4 = CheckOr(BufferFromPackedInt4(client.get(), memory_space, u4_packed, U4, {15}),
+                          "Transferring u4");
+        std::vector<int8_t> u4_readback(15);
+        UnpackInt4(CheckOr(PackedInt4FromBuffer(u4.get()), "Reading u4"), /*is_signed=*/false,
+                   absl::MakeSpan(u4_readback));
+        Expect(u4_readback == u4_values, "u4 with an odd element count round trips");
+
+        Expect(!BufferFromPackedInt4(client.get(), memory_space, packed, S4, {17}).ok() &&
+                   !BufferFromPackedInt4(client.get(), memory_space, packed, S8, {16}).ok(),
+               "Size and type mismatches are rejected");
+
+        Literal s8 = CheckOr(int_values.Convert(S8), "Converting");
+        auto s8_buffer = CheckOr(client->BufferFromHostLiteral(s8, memory_space),
+                                 "Transferring s8");
+        Expect(*CheckOr(s8_buffer->ToLiteralSync(), "Reading s8") == s8,
+               "s8 round trips through a device buffer");
+    }
+
+    // Test 3: Elementwise execution
+    std::cout << "\nTest 3: Elementwise computations..." << std::endl;
+    {
+        for (PrimitiveType type : {BF16, F8E4M3FN, F8E5M2, S8, S4}) {
+            const Literal& values = primitive_util::IsFloatingPointType(type) ? float_values
+                                                                              : int_values;
+            Literal input = CheckOr(values.Convert(type), "Converting");
+
+            XlaBuilder builder("affine_" + Name(type));
+            auto x = Parameter(&builder, 0, input.shape(), "x");
+            auto two = ConvertElementType(ConstantR0<float>(&builder, 2.0f), type);
+            auto one = ConvertElementType(ConstantR0<float>(&builder, 1.0f), type);
+            Add(Mul(x, two), one);
+            auto executable = Compile(client.get(), builder);
+
+            auto buffer = CheckOr(client->BufferFromHostLiteral(input, memory_space),
+                                  "Transferring");
+            auto output = Run(executable.get(), {buffer.get()});
+            Literal result = ToF32(*output);
+            bool exact = output->shape().element_type() == type;
+            for (size_t i = 0; i < kFloatValues.size(); i++) {
+                const float v = values.data<float>()[i];
+                exact = exact && result.data<float>()[i] == 2 * v + 1;
+            }
+            Expect(exact, "2x + 1 computed in " + Name(type));
+        }
+    }
+
+    // Test 4: Mixed-precision Dot
+    std::cout << "\nTest 4: Mixed-precision Dot..." << std::endl;
+    {
+        // Sums of 512 ones, beyond what bf16 and f8 represent exactly
+        constexpr int64_t kDepth = 512;
+        for (PrimitiveType type : {BF16, F8E4M3FN, F8E5M2}) {
+            XlaBuilder builder("dot_" + Name(type));
+            auto a = Parameter(&builder, 0, ShapeUtil::MakeShape(type, {4, kDepth}), "a");
+            auto b = Parameter(&builder, 1, ShapeUtil::MakeShape(type, {kDepth, 8}), "b");
+            MixedPrecisionDot(a, b, F32);
+            auto executable = Compile(client.get(), builder);
+
+            Literal ones_a(ShapeUtil::MakeShape(F32, {4, kDepth}));
+            Literal ones_b(ShapeUtil::MakeShape(F32, {kDepth, 8}));
+            ones_a.PopulateWithValue(1.0f);
+            ones_b.PopulateWithValue(1.0f);
+            auto a_buffer = CheckOr(client->BufferFromHostLiteral(
+                                        CheckOr(ones_a.Convert(type), "Converting"), memory_space),
+                                    "Transferring");
+            auto b_buffer = CheckOr(client->BufferFromHostLiteral(
+                                        CheckOr(ones_b.Convert(type), "Converting"), memory_space),
+                                    "Transferring");
+            auto output = Run(executable.get(), {a_buffer.get(), b_buffer.get()});
+            bool exact = output->shape().element_type() == F32;
+            for (float v : output->data<float>()) exact = exact && v == kDepth;
+            Expect(exact, Name(type) + " products accumulate in f32");
+        }
+
+        // 127 * 127 * 64 overflows 16 bits
+        constexpr int64_t kIntDepth = 64;
+        XlaBuilder builder("dot_s8");
+        auto a = Parameter(&builder, 0, ShapeUtil::MakeShape(S8, {2, kIntDepth}), "a");
+        auto b = Parameter(&builder, 1, ShapeUtil::MakeShape(S8, {kIntDepth, 2}), "b");
+        MixedPrecisionDot(a, b, S32);
+        auto executable = Compile(client.get(), builder);
+        Literal max_a(ShapeUtil::MakeShape(S8, {2, kIntDepth}));
+        Literal max_b(ShapeUtil::MakeShape(S8, {kIntDepth, 2}));
+        max_a.PopulateWithValue<int8_t>(127);
+        max_b.PopulateWithValue<int8_t>(127);
+        auto a_buffer = CheckOr(client->BufferFromHostLiteral(max_a, memory_space), "Transferring");
+        auto b_buffer = CheckOr(client->BufferFromHostLiteral(max_b, memory_space), "Transferring");
+        auto output = Run(executable.get(), {a_buffer.get(), b_buffer.get()});
+        bool exact = output->shape().element_type() == S32;
+        for (int32_t v : output->data<int32_t>()) exact = exact && v == 127 * 127 * kIntDepth;
+        Expect(exact, "s8 products accumulate in s32");
+    }
+
+    // Test 5: Quantized weights
+    std::cout << "\nTest 5: Weight-only quantized Dot..." << std::endl;
+    {
+        constexpr int64_t kRows = 4, kDepth = 64, kCols = 16;
+        std::vector<float> x(kRows * kDepth), scales(kCols);
+        std::vector<int8_t> weights(kDepth * kCols);
+        for (size_t i = 0; i < x.size(); i++) x[i] = std::sin(0.1 * i);
+        for (size_t i = 0; i < weights.size(); i++) weights[i] = static_cast<int>(i * 7 % 16) - 8;
+        for (int64_t j = 0; j < kCols; j++) scales[j] = 0.01f * (j + 1);
+
+        std::vector<double> expected(kRows * kCols, 0.0);
+        for (int64_t i = 0; i < kRows; i++) {
+            for (int64_t j = 0; j < kCols; j++) {
+                for (int64_t k = 0; k < kDepth; k++) {
+                    expected[i * kCols + j] += x[i * kDepth + k] * weights[k * kCols + j];
+                }
+                expected[i * kCols + j] *= scales[j];
+            }
+        }
+
+        Literal x_literal = LiteralUtil::CreateR1<float>(x).Reshape({kRows, kDepth}).value();
+        auto x_buffer = CheckOr(client->BufferFromHostLiteral(x_literal, memory_space),
+                                "Transferring x");
+        auto scale_buffer = CheckOr(client->BufferFromHostLiteral(
+                                        LiteralUtil::CreateR1<float>(scales), memory_space),
+                                    "Transferring scales");
+        std::vector<uint8_t> packed(PackedByteSize(S4, weights.size()));
+        PackInt4(weights, absl::MakeSpan(packed));
+        auto s4_weights = CheckOr(BufferFromPackedInt4(client.get(), memory_space, packed, S4,
+                                                       {kDepth, kCols}),
+                                  "Transferring s4 weights");
+        Literal s8_literal(ShapeUtil::MakeShape(S8, {kDepth, kCols}));
+        std::copy(weights.begin(), weights.end(), s8_literal.data<int8_t>().begin());
+        auto s8_weights = CheckOr(client->BufferFromHostLiteral(s8_literal, memory_space),
+                                  "Transferring s8 weights");
+
+        for (PjRtBuffer* w : {s4_weights.get(), s8_weights.get()}) {
+            const PrimitiveType type = w->element_type();
+            XlaBuilder builder("dequantized_dot_" + Name(type));
+            auto xp = Parameter(&builder, 0, x_literal.shape(), "x");
+            auto wp = Parameter(&builder, 1, ShapeUtil::MakeShape(type, {kDepth, kCols}), "w");
+            auto sp = Parameter(&builder, 2, ShapeUtil::MakeShape(F32, {kCols}), "scales");
+            DequantizedDot(xp, wp, sp);
+            auto executable = Compile(client.get(), builder);
+            auto output = Run(executable.get(), {x_buffer.get(), w, scale_buffer.get()});
+            double max_error = 0;
+            for (size_t i = 0; i < expected.size(); i++) {
+                max_error = std::max(max_error,
+                                     std::abs(output->data<float>()[i] - expected[i]));
+            }
+            Expect(max_error < 1e-4, Name(type) + " weights match the host reference");
+        }
+    }
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "✓ All low-precision tests passed!" << std::endl;
+    std::cout << "========================================" << std::endl;
+    return 0;
+}
@@ -0,0 +1,170 @@
+/**
+ * XLA Memory Report Test
+ *
+ * Verifies the memory footprint of compiled executables reported by
+ * xla/extension/memory_report.h:
+ * 1. Argument, output and temp bytes of a compiled computation
+ * 2. Aliased outputs are counted once in the total
+ * 3. Buffers live at the peak of a heap simulation
+ * 4. Budget checks at compile time
+ * 5. Human-readable report
+ */
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/service/hlo.pb.h"
+#include "xla/extension/memory_report.h"
+#include "absl/status/statusor.h"
+#include "absl/status/status.h"
+
+#include "test_common.h"
+
+using namespace xla;
+using tests::CheckOr;
+using tests::Expect;
+using namespace xla::extension;
+
+constexpr int64_t kSize = 512;
+constexpr int64_t kMatrixBytes = kSize * kSize * sizeof(float);
+
+// sum((a @ b) @ a), whose product is an intermediate of kMatrixBytes
+XlaComputation BuildChain() {
+    XlaBuilder builder("chain");
+    Shape shape = ShapeUtil::MakeShape(F32, {kSize, kSize});
+    auto a = Parameter(&builder, 0, shape, "a");
+    auto b = Parameter(&builder, 1, shape, "b");
+    auto c = Dot(Dot(a, b), a);
+    Reduce(c, ConstantR0<float>(&builder, 0.0f), CreateScalarAddComputation(F32, &builder), {0, 1});
+    return CheckOr(builder.Build(), "Building chain");
+}
+
+HeapSimulatorTrace::Event* AddEvent(HeapSimulatorTrace* trace,
+                                    HeapSimulatorTrace::Event::Kind kind, int64_t id) {
+    auto* event = trace->add_events();
+    event->set_kind(kind);
+    event->set_buffer_id(id);
+    return event;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "XLA Memory Report Test" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    auto client = CheckOr(GetPjRtCpuClient(CpuClientOptions()), "Creating CPU client");
+    CompileOptions compile_options;
+    auto chain = CheckOr(client->CompileAndLoad(BuildChain(), compile_options), "Compiling chain");
+    auto footprint = CheckOr(GetMemoryFootprint(*chain), "Getting footprint");
+
+    // Test 1: Breakdown
+    std::cout << "\nTest 1: Footprint breakdown..." << std::endl;
+    {
+        Expect(footprint.argument_bytes == 2 * kMatrixBytes, "Arguments are two matrices");
+        Expect(footprint.output_bytes == static_cast<int64_t>(sizeof(float)),
+               "Output is one scalar");
+        Expect(footprint.temp_bytes >= kMatrixBytes, "Temp holds the intermediate product");
+        Expect(footprint.alias_bytes == 0 &&
+                   footprint.total_bytes() == footprint.argument_bytes +
+                       footprint.output_bytes + footprint.temp_bytes,
+               "Total without aliases");
+        Expect(!footprint.peak_buffers.empty() &&
+                   footprint.peak_buffers[0].bytes >= kMatrixBytes &&
+                   !footprint.peak_buffers[0].instruction.empty(),
+               "Largest live buffer is named after its instruction");
+    }
+
+    // Test 2: Aliases
+    std::cout << "\nTest 2: Aliased outputs..." << std::endl;
+    {
+        XlaBuilder builder("update");
+        auto x = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {kSize, kSize}), "x");
+        Add(x, ConstantR0<float>(&builder, 1.0f));
+        builder.SetUpAlias({}, 0, {});
+        auto update = CheckOr(client->CompileAndLoad(CheckOr(builder.Build(), "Building"),
+                                                     compile_options),
+                              "Compiling update");
+        auto aliased = CheckOr(GetMemoryFootprint(*update), "Getting footprint");
+        Expect(aliased.alias_bytes == kMatrixBytes, "Alias bytes are reported");
+        Expect(aliased.total_bytes() == kMatrixBytes + aliased.temp_bytes,
+               "Aliased output is counted once");
+    }
+
+    // Test 3: Heap simulation
+    std::cout << "\nTest 3: Buffers live at the peak..." << std::endl;
+    {
+        BufferAssignmentProto assignment;
+        const std::vector<std::pair<std::string, int64_t>> buffers = {
+            {"a", 100}, {"b", 300}, {"c", 50}, {"d", 300}};
+        for (size_t i = 0; i < buffers.size(); i++) {
+            auto* buffer = assignment.add_logical_buffers();
+            buffer->set_id(i + 1);
+            buffer->set_size(buffers[i].second);
+            buffer->mutable_defined_at()->set_instruction_name(buffers[i].first);
+        }
+        auto* trace = assignment.add_heap_simulator_traces();
+        AddEvent(trace, HeapSimulatorTrace::Event::ALLOC, 1);
+        AddEvent(trace, HeapSimulatorTrace::Event::ALLOC, 2);
+        AddEvent(trace, HeapSimulatorTrace::Event::FREE, 1);
+        AddEvent(trace, HeapSimulatorTrace::Event::ALLOC, 3);
+        AddEvent(trace, HeapSimulatorTrace::Event::SHARE_WITH, 4)->set_share_with_canonical_id(2);
+        AddEvent(trace, HeapSimulatorTrace::Event::FREE, 2);
+
+        CompiledMemoryStats stats;
+        stats.serialized_buffer_assignment = assignment.SerializeAsString();
+        auto simulated = CheckOr(MemoryFootprintFromStats(stats), "Getting footprint");
+        Expect(simulated.peak_buffers.size() == 2 &&
+                   simulated.peak_buffers[0].instruction == "b" &&
+                   simulated.peak_buffers[1].instruction == "a",
+               "Peak is b and a, largest first");
+        auto truncated = CheckOr(MemoryFootprintFromStats(stats, 1), "Getting footprint");
+        Expect(truncated.peak_buffers.size() == 1, "Buffer list is truncated");
+    }
+
+    // Test 4: Budget
+    std::cout << "\nTest 4: Memory budget..." << std::endl;
+    {
+        MemoryBudget generous;
+        generous.total_bytes = 64 * kMatrixBytes;
+        Expect(CheckMemoryBudget(footprint, generous).ok(), "Within budget");
+
+        MemoryBudget tight;
+        tight.total_bytes = 2 * kMatrixBytes;
+        auto status = CheckMemoryBudget(footprint, tight);
+        Expect(absl::IsResourceExhausted(status), "Exceeding the total fails");
+        Expect(std::string(status.message()).find(footprint.peak_buffers[0].instruction) !=
+                   std::string::npos,
+               "Failure names the largest buffers");
+
+        MemoryBudget temp;
+        temp.temp_bytes = kMatrixBytes / 2;
+        Expect(absl::IsResourceExhausted(CheckMemoryBudget(footprint, temp)),
+               "Exceeding the temp budget fails");
+    }
+
+    // Test 5: Report
+    std::cout << "\nTest 5: Human-readable report..." << std::endl;
+    {
+        std::string report = FormatMemoryFootprint(footprint);
+        std::cout << report;
+        Expect(report.find("temp") != std::string::npos &&
+                   report.find("largest live buffers") != std::string::npos,
+               "Report lists the breakdown and live buffers");
+    }
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "✓ All memory report tests passed!" << std::endl;
+    std::cout << "========================================" << std::endl;
+    return 0;
+}
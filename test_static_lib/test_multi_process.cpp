@@ -0,0 +1,182 @@
+/**
+ * XLA Multi-Process Test
+ *
+ * Runs a group of processes on localhost, each with its own CPU client,
+ * coordinated by the distributed runtime service linked into the static
+ * archive (xla/extension/multi_process.h). The test forks the processes
+ * itself, process 0 reports:
+ * 1. Processes connect and share one topology
+ * 2. Cross-process all-reduce
+ * 3. Cross-process all-gather
+ * 4. Invalid groups are rejected
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/multi_process.h"
+#include "absl/status/statusor.h"
+#include "absl/status/status.h"
+
+#include "test_common.h"
+
+using namespace xla;
+using tests::CheckOr;
+using tests::Expect;
+using namespace xla::extension;
+
+constexpr int kProcesses = 2;
+constexpr int kLocalDevices = 2;
+constexpr int kReplicas = kProcesses * kLocalDevices;
+constexpr int64_t kSize = 4;
+
+// A localhost port that was free a moment ago
+int FreePort() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        std::cerr << "ERROR: no free port" << std::endl;
+        exit(1);
+    }
+    close(fd);
+    return ntohs(addr.sin_port);
+}
+
+// Executes `computation` on every local device and returns the results
+std::vector<std::vector<float>> RunOnLocalDevices(PjRtClient* client,
+                                                  const XlaComputation& computation) {
+    auto options = CheckOr(MultiProcessCompileOptions(client), "Getting compile options");
+    auto executable = CheckOr(client->CompileAndLoad(computation, options), "Compiling");
+    std::vector<std::vector<PjRtBuffer*>> argument_handles(
+        executable->addressable_devices().size());
+    ExecuteOptions execute_options;
+    auto results = CheckOr(executable->Execute(argument_handles, execute_options), "Executing");
+
+    std::vector<std::vector<float>> values;
+    for (auto& device_results : results) {
+        auto literal = CheckOr(device_results[0]->ToLiteralSync(), "Reading result");
+        auto data = literal->data<float>();
+        values.emplace_back(data.begin(), data.end());
+    }
+    return values;
+}
+
+// Body of each process of the group
+void RunProcess(int process_id, const std::string& address) {
+    // Only process 0 prints, failures are printed by every process
+    tests::g_verbose = process_id == 0;
+    MultiProcessOptions options;
+    options.coordinator_address = address;
+    options.num_processes = kProcesses;
+    options.process_id = process_id;
+    options.local_device_count = kLocalDevices;
+    auto group = CheckOr(MultiProcessCpuClient::Create(options), "Joining the group");
+    PjRtClient* client = group->client();
+
+    // Test 1: Topology
+    if (tests::g_verbose) std::cout << "\nTest 1: Shared topology..." << std::endl;
+    {
+        Expect(client->devices().size() == kReplicas, "Devices of every process are visible");
+        Expect(client->addressable_devices().size() == kLocalDevices,
+               "Only local devices are addressable");
+        bool local = true;
+        for (PjRtDevice* device : client->addressable_devices()) {
+            local = local && device->process_index() == process_id;
+        }
+        Expect(local && client->process_index() == process_id, "Process indices match");
+    }
+
+    // Test 2: All-reduce, replica r contributes r + 1
+    if (tests::g_verbose) std::cout << "\nTest 2: Cross-process all-reduce..." << std::endl;
+    {
+        XlaBuilder builder("all_reduce");
+        auto x = Add(ConvertElementType(ReplicaId(&builder), F32), ConstantR0<float>(&builder, 1.0f));
+        CrossReplicaSum(Broadcast(x, {kSize}));
+        auto values = RunOnLocalDevices(client, CheckOr(builder.Build(), "Building"));
+        bool ok = values.size() == kLocalDevices;
+        for (const auto& v : values) {
+            for (float element : v) ok = ok && element == kReplicas * (kReplicas + 1) / 2;
+        }
+        Expect(ok, "Every replica holds the sum over all processes");
+    }
+
+    // Test 3: All-gather
+    if (tests::g_verbose) std::cout << "\nTest 3: Cross-process all-gather..." << std::endl;
+    {
+        XlaBuilder builder("all_gather");
+        auto x = Add(ConvertElementType(ReplicaId(&builder), F32), ConstantR0<float>(&builder, 1.0f));
+        AllGather(Broadcast(x, {kSize}), /*all_gather_dimension=*/0, /*shard_count=*/kReplicas);
+        auto values = RunOnLocalDevices(client, CheckOr(builder.Build(), "Building"));
+        std::vector<float> expected;
+        for (int r = 0; r < kReplicas; r++) expected.insert(expected.end(), kSize, r + 1.0f);
+        bool ok = values.size() == kLocalDevices;
+        for (const auto& v : values) ok = ok && v == expected;
+        Expect(ok, "Every replica holds the slices of all processes in order");
+    }
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "XLA Multi-Process Test" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    // Fork before any XLA threads exist
+    const std::string address = "localhost:" + std::to_string(FreePort());
+    std::vector<pid_t> children;
+    for (int process_id = 0; process_id < kProcesses; process_id++) {
+        std::cout.flush();
+        pid_t pid = fork();
+        if (pid == 0) {
+            RunProcess(process_id, address);
+            std::cout.flush();
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    bool all_exited = true;
+    for (pid_t pid : children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        all_exited = all_exited && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    Expect(all_exited, "All processes succeeded");
+
+    // Test 4: Errors
+    std::cout << "\nTest 4: Invalid groups..." << std::endl;
+    {
+        MultiProcessOptions options;
+        options.coordinator_address = address;
+        options.num_processes = 2;
+        options.process_id = 2;
+        Expect(absl::IsInvalidArgument(MultiProcessCpuClient::Create(options).status()),
+               "Process id outside the group is rejected");
+
+        options.process_id = 0;
+        options.coordinator_address = "localhost";
+        Expect(absl::IsInvalidArgument(MultiProcessCpuClient::Create(options).status()),
+               "Address without a port is rejected");
+    }
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "✓ All multi-process tests passed!" << std::endl;
+    std::cout << "========================================" << std::endl;
+    return 0;
+}
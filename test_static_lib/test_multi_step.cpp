@@ -0,0 +1,199 @@
+/**
+ * XLA Multi-Step Test
+ *
+ * Verifies the fused K-step executables of xla/extension/multi_step.h:
+ * 1. One fused step matches one Execute of the step
+ * 2. 100 fused steps match 100 Execute calls
+ * 3. Per-step outputs are decimated into the ring buffer
+ * 4. The ring continues across executions
+ * 5. Invalid step functions and options are rejected
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/multi_step.h"
+#include "absl/status/statusor.h"
+#include "absl/status/status.h"
+
+#include "test_common.h"
+
+using namespace xla;
+using tests::CheckOr;
+using tests::Expect;
+using namespace xla::extension;
+
+// A damped oscillator: (x, v, dt) -> (x + v * dt, v - x * dt, x^2 + v^2)
+XlaComputation BuildOscillator() {
+    XlaBuilder builder("oscillator");
+    Shape shape = ShapeUtil::MakeShape(F32, {8});
+    auto x = Parameter(&builder, 0, shape, "x");
+    auto v = Parameter(&builder, 1, shape, "v");
+    auto dt = Parameter(&builder, 2, ShapeUtil::MakeShape(F32, {}), "dt");
+    auto next_x = Add(x, Mul(v, dt));
+    auto next_v = Sub(Mul(v, ConstantR0<float>(&builder, 0.999f)), Mul(x, dt));
+    Tuple(&builder, {next_x, next_v, Add(Mul(next_x, next_x), Mul(next_v, next_v))});
+    return CheckOr(builder.Build(), "Building oscillator");
+}
+
+// (n) -> (n + 1, n + 1), so the output of step s is s
+XlaComputation BuildCounter() {
+    XlaBuilder builder("counter");
+    auto n = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {}), "n");
+    auto next = Add(n, ConstantR0<float>(&builder, 1.0f));
+    Tuple(&builder, {next, next});
+    return CheckOr(builder.Build(), "Building counter");
+}
+
+std::unique_ptr<PjRtBuffer> Upload(PjRtClient* client, const Literal& literal) {
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+    return CheckOr(client->BufferFromHostLiteral(literal, memory_space), "Transferring");
+}
+
+std::vector<std::unique_ptr<PjRtBuffer>> OscillatorState(PjRtClient* client) {
+    std::vector<std::unique_ptr<PjRtBuffer>> state;
+    state.push_back(Upload(client, LiteralUtil::CreateR1<float>({1, 0, 1, 0, 1, 0, 1, 0})));
+    state.push_back(Upload(client, LiteralUtil::CreateR1<float>({0, 1, 0, 1, 0, 1, 0, 1})));
+    return state;
+}
+
+// Runs the oscillator `steps` times with one Execute per step
+std::vector<Literal> Reference(PjRtClient* client, PjRtBuffer* dt, int steps) {
+    CompileOptions compile_options;
+    auto executable = CheckOr(client->CompileAndLoad(BuildOscillator(), compile_options),
+                              "Compiling step");
+    auto state = OscillatorState(client);
+    ExecuteOptions execute_options;
+    for (int i = 0; i < steps; i++) {
+        std::vector<std::vector<PjRtBuffer*>> argument_handles = {
+            {state[0].get(), state[1].get(), dt}};
+        auto results = CheckOr(executable->Execute(argument_handles, execute_options), "Executing");
+        state[0] = std::move(results[0][0]);
+        state[1] = std::move(results[0][1]);
+    }
+    std::vector<Literal> literals;
+    for (auto& buffer : state) literals.push_back(std::move(*CheckOr(buffer->ToLiteralSync(), "Reading")));
+    return literals;
+}
+
+bool Near(const Literal& actual, const Literal& expected) {
+    auto a = actual.data<float>();
+    auto e = expected.data<float>();
+    for (size_t i = 0; i < a.size(); i++) {
+        if (std::abs(a[i] - e[i]) > 1e-4f) return false;
+    }
+    return a.size() == e.size();
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "XLA Multi-Step Test" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    auto client = CheckOr(GetPjRtCpuClient(CpuClientOptions()), "Creating CPU client");
+    auto dt = Upload(client.get(), LiteralUtil::CreateR0<float>(0.01f));
+
+    // Test 1: K = 1
+    std::cout << "\nTest 1: One fused step..." << std::endl;
+    {
+        MultiStepOptions options;
+        auto runner = CheckOr(MultiStepRunner::Create(client.get(), BuildOscillator(),
+                                                      OscillatorState(client.get()), options),
+                              "Creating runner");
+        Expect(runner->Run({dt.get()}).ok(), "Run succeeds");
+        auto expected = Reference(client.get(), dt.get(), 1);
+        Expect(Near(*CheckOr(runner->state()[0]->ToLiteralSync(), "Reading x"), expected[0]) &&
+                   Near(*CheckOr(runner->state()[1]->ToLiteralSync(), "Reading v"), expected[1]),
+               "Matches one Execute");
+    }
+
+    // Test 2: K = 100
+    std::cout << "\nTest 2: 100 fused steps..." << std::endl;
+    {
+        MultiStepOptions options;
+        options.steps = 100;
+        auto runner = CheckOr(MultiStepRunner::Create(client.get(), BuildOscillator(),
+                                                      OscillatorState(client.get()), options),
+                              "Creating runner");
+        Expect(runner->Run({dt.get()}).ok(), "One execution");
+        auto expected = Reference(client.get(), dt.get(), 100);
+        Expect(Near(*CheckOr(runner->state()[0]->ToLiteralSync(), "Reading x"), expected[0]) &&
+                   Near(*CheckOr(runner->state()[1]->ToLiteralSync(), "Reading v"), expected[1]),
+               "Matches 100 Execute calls");
+        Expect(runner->steps() == 100 && runner->records() == 1, "Steps and records are counted");
+        auto energy = CheckOr(runner->rings()[0]->ToLiteralSync(), "Reading ring");
+        Expect(ShapeUtil::Equal(energy->shape(), ShapeUtil::MakeShape(F32, {1, 8})),
+               "Last step output is recorded by default");
+    }
+
+    // Test 3: Decimation
+    std::cout << "\nTest 3: Decimated ring buffer..." << std::endl;
+    MultiStepOptions options;
+    options.steps = 100;
+    options.record_every = 10;
+    options.ring_size = 4;
+    std::vector<std::unique_ptr<PjRtBuffer>> counter;
+    counter.push_back(Upload(client.get(), LiteralUtil::CreateR0<float>(0.0f)));
+    auto runner = CheckOr(MultiStepRunner::Create(client.get(), BuildCounter(), std::move(counter),
+                                                  options),
+                          "Creating runner");
+    {
+        Expect(runner->Run().ok(), "Run succeeds");
+        auto ring = CheckOr(runner->rings()[0]->ToLiteralSync(), "Reading ring");
+        // Records 7 to 10 (steps 70 to 100) in slots (r - 1) % 4
+        Expect(*ring == LiteralUtil::CreateR1<float>({90, 100, 70, 80}),
+               "Every 10th output kept in a ring of 4");
+        Expect(runner->records() == 10, "Newest record is in slot 1");
+    }
+
+    // Test 4: Across executions
+    std::cout << "\nTest 4: Ring continues across executions..." << std::endl;
+    {
+        Expect(runner->Run().ok(), "Second run succeeds");
+        auto ring = CheckOr(runner->rings()[0]->ToLiteralSync(), "Reading ring");
+        Expect(*ring == LiteralUtil::CreateR1<float>({170, 180, 190, 200}),
+               "Records 17 to 20 follow records 7 to 10");
+        auto n = CheckOr(runner->state()[0]->ToLiteralSync(), "Reading state");
+        Expect(n->data<float>()[0] == 200.0f, "State carried across executions");
+    }
+
+    // Test 5: Errors
+    std::cout << "\nTest 5: Invalid steps and options..." << std::endl;
+    {
+        XlaBuilder builder("not_a_tuple");
+        Neg(Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {}), "x"));
+        auto not_a_tuple = CheckOr(builder.Build(), "Building");
+        Expect(!BuildMultiStep(not_a_tuple, 1, MultiStepOptions()).ok(),
+               "Steps must return a tuple");
+
+        XlaBuilder mismatch_builder("mismatch");
+        auto x = Parameter(&mismatch_builder, 0, ShapeUtil::MakeShape(F32, {}), "x");
+        Tuple(&mismatch_builder, {Broadcast(x, {2})});
+        auto mismatch = CheckOr(mismatch_builder.Build(), "Building");
+        Expect(!BuildMultiStep(mismatch, 1, MultiStepOptions()).ok(),
+               "New state must match the state parameters");
+
+        MultiStepOptions zero_steps;
+        zero_steps.steps = 0;
+        Expect(!BuildMultiStep(BuildCounter(), 1, zero_steps).ok(), "Zero steps are rejected");
+    }
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "✓ All multi-step tests passed!" << std::endl;
+    std::cout << "========================================" << std::endl;
+    return 0;
+}
@@ -0,0 +1,178 @@
+/**
+ * XLA Execution Pipeline Test
+ *
+ * Verifies xla::extension::ExecutionPipeline:
+ * 1. Results are correct and delivered in step order for depth 1, 2 and 3
+ * 2. Backpressure never lets more than `depth` steps be in flight
+ * 3. Outputs handed to the done callback can be fed into later steps
+ * 4. Misuse of NextStep/Submit is reported as an error
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/execution_pipeline.h"
+#include "xla/extension/host_buffer.h"
+#include "absl/status/statusor.h"
+#include "absl/status/status.h"
+
+#include "test_common.h"
+
+using namespace xla;
+using tests::CheckOr;
+using tests::Expect;
+using namespace xla::extension;
+
+constexpr int64_t kSize = 256;
+
+// y = 2 * x + 1
+std::unique_ptr<PjRtLoadedExecutable> CompileAffine(PjRtClient* client) {
+    XlaBuilder builder("affine");
+    auto x = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {kSize}), "x");
+    Add(Mul(x, ConstantR0<float>(&builder, 2.0f)), ConstantR0<float>(&builder, 1.0f));
+    auto computation = CheckOr(builder.Build(), "Building computation");
+    CompileOptions compile_options;
+    return CheckOr(client->CompileAndLoad(computation, compile_options), "Compiling computation");
+}
+
+void TestDepth(PjRtClient* client, PjRtMemorySpace* memory_space,
+               PjRtLoadedExecutable* executable, int depth) {
+    std::cout << "\nTest: depth " << depth << "..." << std::endl;
+
+    const int steps = 20;
+    std::vector<AlignedHostBuffer> inputs, outputs;
+    for (int i = 0; i < depth; i++) {
+        inputs.emplace_back(kSize * sizeof(float));
+        outputs.emplace_back(kSize * sizeof(float));
+    }
+
+    std::vector<int64_t> completed;
+    bool correct = true;
+    int64_t max_in_flight = 0;
+
+    ExecutionPipeline* pipeline_ptr = nullptr;
+    ExecutionPipeline::Options options;
+    options.depth = depth;
+    ExecutionPipeline pipeline(
+        executable, options,
+        [&](int64_t step, absl::Span<const std::unique_ptr<PjRtBuffer>> results) {
+            auto& out = outputs[pipeline_ptr->slot(step)];
+            return std::vector<PjRtFuture<>>{
+                CopyToHostMemory(results[0].get(), out.data(), out.size())};
+        },
+        [&](int64_t step, absl::Status status, std::vector<std::unique_ptr<PjRtBuffer>>) {
+            if (!status.ok()) correct = false;
+            auto out = outputs[pipeline_ptr->slot(step)].as_span<float>();
+            for (int64_t i = 0; i < kSize; i++) {
+                if (std::abs(out[i] - (2.0f * (step + i) + 1.0f)) > 1e-3) correct = false;
+            }
+            completed.push_back(step);
+        });
+    pipeline_ptr = &pipeline;
+
+    for (int s = 0; s < steps; s++) {
+        int64_t step = CheckOr(pipeline.NextStep(), "Reserving step");
+        auto in = inputs[pipeline.slot(step)].as_span<float>();
+        for (int64_t i = 0; i < kSize; i++) in[i] = static_cast<float>(step + i);
+
+        std::vector<std::unique_ptr<PjRtBuffer>> arguments;
+        arguments.push_back(CheckOr(
+            BufferFromHostMemory(client, memory_space, in.data(), F32, {kSize}),
+            "Creating input buffer"));
+        if (!pipeline.Submit(std::move(arguments)).ok()) {
+            std::cerr << "  ✗ Submit failed" << std::endl;
+            exit(1);
+        }
+        max_in_flight = std::max(max_in_flight, pipeline.in_flight());
+    }
+    Expect(pipeline.Flush().ok(), "Flush succeeded");
+
+    bool ordered = completed.size() == static_cast<size_t>(steps);
+    for (size_t i = 0; i < completed.size(); i++) {
+        if (completed[i] != static_cast<int64_t>(i)) ordered = false;
+    }
+    Expect(ordered, "All steps completed in order");
+    Expect(correct, "Results verified correct");
+    Expect(max_in_flight <= depth, "At most " + std::to_string(depth) + " steps in flight");
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "XLA Execution Pipeline Test" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    CpuClientOptions client_options;
+    client_options.asynchronous = true;
+    client_options.cpu_device_count = 1;
+    auto client = CheckOr(GetPjRtCpuClient(client_options), "Creating CPU client");
+    auto memory_space = CheckOr(
+        client->addressable_devices()[0]->default_memory_space(),
+        "Getting default memory space"
+    );
+    auto executable = CompileAffine(client.get());
+
+    for (int depth : {1, 2, 3}) {
+        TestDepth(client.get(), memory_space, executable.get(), depth);
+    }
+
+    // Feed each step's output into the next one: x <- 2x + 1
+    std::cout << "\nTest: chaining outputs..." << std::endl;
+    {
+        std::vector<std::unique_ptr<PjRtBuffer>> state;
+        ExecutionPipeline::Options options;
+        options.depth = 1;
+        ExecutionPipeline pipeline(
+            executable.get(), options, nullptr,
+            [&](int64_t, absl::Status, std::vector<std::unique_ptr<PjRtBuffer>> outputs) {
+                state = std::move(outputs);
+            });
+
+        std::vector<float> zeros(kSize, 0.0f);
+        state.push_back(CheckOr(
+            BufferFromHostMemory(client.get(), memory_space, zeros.data(), F32, {kSize}),
+            "Creating initial state"));
+        for (int s = 0; s < 5; s++) {
+            CheckOr(pipeline.NextStep(), "Reserving step");
+            if (!pipeline.Submit(std::move(state)).ok()) {
+                std::cerr << "  ✗ Submit failed" << std::endl;
+                return 1;
+            }
+            state.clear();
+            // With depth 1 the next NextStep retires this step, here we
+            // flush explicitly so the state is available right away
+            if (!pipeline.Flush().ok()) return 1;
+        }
+
+        std::vector<float> out(kSize);
+        Expect(CopyToHostMemory(state[0].get(), out.data(), out.size() * sizeof(float)).Await().ok(),
+               "Readback completed");
+        // 0 -> 1 -> 3 -> 7 -> 15 -> 31
+        Expect(std::abs(out[0] - 31.0f) < 1e-3, "Chained state verified correct");
+    }
+
+    std::cout << "\nTest: API misuse..." << std::endl;
+    {
+        ExecutionPipeline::Options options;
+        ExecutionPipeline pipeline(executable.get(), options);
+        Expect(!pipeline.Submit({}).ok(), "Submit without NextStep fails");
+        CheckOr(pipeline.NextStep(), "Reserving step");
+        Expect(!pipeline.NextStep().ok(), "Double NextStep fails");
+    }
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "✓ All tests passed successfully!" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return 0;
+}
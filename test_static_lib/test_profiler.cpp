@@ -0,0 +1,159 @@
+/**
+ * XLA Profiler Session Test
+ *
+ * Profiles the matmul from test_xla.cpp (ExecuteMatMul) with
+ * xla/extension/profiler.h and writes a Chrome trace:
+ * 1. A session captures the host events of CompileAndLoad and Execute,
+ *    including an event named after the dot instruction
+ * 2. The trace is written as Chrome trace JSON
+ * 3. Only one session can be active at a time
+ * 4. A stopped session cannot be stopped again, a new one can start
+ *
+ * The trace goes to PROFILE_TRACE (default matmul.trace.json), open it
+ * in https://ui.perfetto.dev or chrome://tracing.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/profiler.h"
+#include "absl/status/statusor.h"
+#include "absl/status/status.h"
+
+#include "test_common.h"
+
+using namespace xla;
+using tests::CheckOr;
+using tests::Expect;
+using namespace xla::extension;
+
+// Compiles and runs the 2x3 by 3x2 matmul of ExecuteMatMul, `dot_name`
+// receives the name of the dot instruction in the optimized module
+Literal ProfiledMatMul(PjRtClient* client, std::string* dot_name) {
+    XlaBuilder builder("matmul");
+    auto a = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {2, 3}), "a");
+    auto b = Parameter(&builder, 1, ShapeUtil::MakeShape(F32, {3, 2}), "b");
+    Dot(a, b);
+    auto computation = CheckOr(builder.Build(), "Building matmul computation");
+
+    CompileOptions compile_options;
+    EnableHloOpTracing(compile_options);
+    auto executable = CheckOr(client->CompileAndLoad(computation, compile_options),
+                              "Compiling matmul");
+    auto modules = CheckOr(executable->GetHloModules(), "Getting HLO modules");
+    for (const HloInstruction* instruction : modules[0]->entry_computation()->instructions()) {
+        if (instruction->opcode() == HloOpcode::kDot) *dot_name = instruction->name();
+    }
+
+    Literal a_literal = LiteralUtil::CreateR2<float>({{1, 2, 3}, {4, 5, 6}});
+    Literal b_literal = LiteralUtil::CreateR2<float>({{1, 2}, {3, 4}, {5, 6}});
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting default memory space");
+    auto a_buffer = CheckOr(client->BufferFromHostLiteral(a_literal, memory_space),
+                            "Transferring a to device");
+    auto b_buffer = CheckOr(client->BufferFromHostLiteral(b_literal, memory_space),
+                            "Transferring b to device");
+
+    std::vector<std::vector<PjRtBuffer*>> argument_handles = {{a_buffer.get(), b_buffer.get()}};
+    ExecuteOptions execute_options;
+    auto results = CheckOr(executable->Execute(argument_handles, execute_options),
+                           "Executing matmul");
+    auto literal = CheckOr(results[0][0]->ToLiteralSync(), "Transferring result to host");
+    return std::move(*literal);
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "XLA Profiler Session Test" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    const char* trace_env = std::getenv("PROFILE_TRACE");
+    const std::string trace_path = trace_env != nullptr ? trace_env : "matmul.trace.json";
+
+    auto client = CheckOr(GetPjRtCpuClient(CpuClientOptions()), "Creating CPU client");
+
+    // Test 1: Capture
+    std::cout << "\nTest 1: Profiling the matmul..." << std::endl;
+    auto session = CheckOr(ProfilerSession::Start(), "Starting profiler session");
+    std::string dot_name;
+    Literal result = ProfiledMatMul(client.get(), &dot_name);
+    auto space = CheckOr(session->Stop(), "Stopping profiler session");
+
+    Expect(result == LiteralUtil::CreateR2<float>({{22, 28}, {49, 64}}), "Matmul result is correct");
+    int64_t events = 0;
+    for (const auto& plane : space.planes()) {
+        for (const auto& line : plane.lines()) events += line.events_size();
+    }
+    std::cout << "  Captured " << events << " events in " << space.planes_size() << " planes" << std::endl;
+    Expect(events > 0, "Host events are captured");
+
+    // Thunk events carry the HLO instruction they run as their name
+    bool dot_event = false;
+    for (const auto& plane : space.planes()) {
+        for (const auto& [id, metadata] : plane.event_metadata()) {
+            dot_event = dot_event || (!dot_name.empty() && (metadata.name() == dot_name ||
+                                                            metadata.display_name() == dot_name));
+        }
+    }
+    Expect(dot_event, "Trace has an event for the " + dot_name + " instruction");
+
+    // Test 2: Chrome trace
+    std::cout << "\nTest 2: Writing the Chrome trace..." << std::endl;
+    {
+        auto status = WriteChromeTrace(space, trace_path);
+        Expect(status.ok(), "Trace written to " + trace_path);
+
+        std::ifstream file(trace_path);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        std::string json = contents.str();
+        Expect(json.find("\"traceEvents\"") != std::string::npos, "Trace is Chrome trace JSON");
+        Expect(json.find("\"" + dot_name + "\"") != std::string::npos,
+               "Trace names the dot instruction");
+    }
+
+    // Test 3: Exclusive sessions
+    std::cout << "\nTest 3: One session at a time..." << std::endl;
+    {
+        auto first = CheckOr(ProfilerSession::Start(), "Starting profiler session");
+        Expect(!ProfilerSession::Start().ok(), "Second concurrent session is rejected");
+        CheckOr(first->Stop(), "Stopping profiler session");
+    }
+
+    // Test 4: Stop once
+    std::cout << "\nTest 4: Session lifetime..." << std::endl;
+    {
+        auto stopped = CheckOr(ProfilerSession::Start(), "Starting profiler session");
+        CheckOr(stopped->Stop(), "Stopping profiler session");
+        Expect(!stopped->Stop().ok(), "Stopping twice fails");
+
+        auto next = CheckOr(ProfilerSession::Start({/*host_tracer_level=*/1}),
+                            "Starting profiler session");
+        Expect(next->StopAndWriteChromeTrace(trace_path + ".empty").ok(),
+               "New session starts after the previous one stopped");
+        std::remove((trace_path + ".empty").c_str());
+    }
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "✓ All profiler tests passed!" << std::endl;
+    std::cout << "========================================" << std::endl;
+    return 0;
+}
@@ -0,0 +1,234 @@
+/**
+ * XLA Spatial-Algebra Kernel Test
+ *
+ * Checks the custom-call kernels of xla/extension/spatial_kernels.h
+ * against the equivalent HLO graphs (spatial_hlo.h) on the CPU client:
+ * 1. Batched 3x3, 4x4 and 6x6 (unrolled) and 5x5 (generic) matmul
+ * 2. Batched matrix-vector products in F32 and F64
+ * 3. Quaternion product and rotation
+ * 4. Spatial motion transform
+ * 5. Several leading batch dimensions
+ * 6. Invalid operands are rejected when building the computation
+ *
+ * Batch sizes are not multiples of the 16-item kernel blocks, so the
+ * partial blocks are covered as well.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/spatial_kernels.h"
+#include "absl/status/statusor.h"
+#include "absl/status/status.h"
+
+#include "spatial_hlo.h"
+#include "test_common.h"
+
+using namespace xla;
+using tests::CheckOr;
+using tests::Expect;
+
+using BuildFn = XlaOp (*)(absl::Span<const XlaOp>);
+
+std::mt19937 rng(42);
+
+Literal RandomLiteral(PrimitiveType type, const std::vector<int64_t>& dims) {
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    Literal literal(ShapeUtil::MakeShape(type, dims));
+    if (type == F32) {
+        for (float& v : literal.data<float>()) v = static_cast<float>(dist(rng));
+    } else {
+        for (double& v : literal.data<double>()) v = dist(rng);
+    }
+    return literal;
+}
+
+// Normalizes every quaternion of a [..., 4] literal
+void Normalize(Literal& literal) {
+    auto data = literal.data<float>();
+    for (size_t i = 0; i < data.size(); i += 4) {
+        float norm = std::sqrt(data[i] * data[i] + data[i + 1] * data[i + 1] +
+                               data[i + 2] * data[i + 2] + data[i + 3] * data[i + 3]);
+        for (size_t k = 0; k < 4; k++) data[i + k] /= norm;
+    }
+}
+
+Literal Run(PjRtClient* client, BuildFn build, const std::vector<const Literal*>& args) {
+    XlaBuilder builder("spatial");
+    std::vector<XlaOp> params;
+    for (size_t i = 0; i < args.size(); i++) {
+        params.push_back(Parameter(&builder, i, args[i]->shape(), "p" + std::to_string(i)));
+    }
+    build(params);
+    auto computation = CheckOr(builder.Build(), "Building computation");
+
+    CompileOptions compile_options;
+    auto executable = CheckOr(client->CompileAndLoad(computation, compile_options), "Compiling");
+
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+    std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+    std::vector<PjRtBuffer*> handles;
+    for (const Literal* arg : args) {
+        buffers.push_back(CheckOr(client->BufferFromHostLiteral(*arg, memory_space),
+                                  "Transferring argument"));
+        handles.push_back(buffers.back().get());
+    }
+
+    std::vector<std::vector<PjRtBuffer*>> argument_handles = {handles};
+    ExecuteOptions execute_options;
+    auto results = CheckOr(executable->Execute(argument_handles, execute_options), "Executing");
+    auto literal = CheckOr(results[0][0]->ToLiteralSync(), "Reading back");
+    return std::move(*literal);
+}
+
+double MaxAbsDiff(const Literal& a, const Literal& b) {
+    double diff = 0;
+    if (a.shape().element_type() == F32) {
+        auto x = a.data<float>(), y = b.data<float>();
+        for (size_t i = 0; i < x.size(); i++) diff = std::max(diff, double(std::abs(x[i] - y[i])));
+    } else {
+        auto x = a.data<double>(), y = b.data<double>();
+        for (size_t i = 0; i < x.size(); i++) diff = std::max(diff, std::abs(x[i] - y[i]));
+    }
+    return diff;
+}
+
+// Runs the kernel and the HLO graph on the same arguments and compares
+void Compare(PjRtClient* client, BuildFn kernel, BuildFn reference,
+             const std::vector<const Literal*>& args, const std::string& name) {
+    Literal actual = Run(client, kernel, args);
+    Literal expected = Run(client, reference, args);
+    double tolerance = actual.shape().element_type() == F32 ? 1e-5 : 1e-12;
+    Expect(actual.shape().dimensions() == expected.shape().dimensions() &&
+               MaxAbsDiff(actual, expected) < tolerance,
+           name + " matches the HLO graph");
+}
+
+XlaOp KernelMatMul(absl::Span<const XlaOp> p) { return extension::BatchedSmallMatMul(p[0], p[1]); }
+XlaOp HloMatMul(absl::Span<const XlaOp> p) { return spatial_hlo::BatchedDot(p[0], p[1]); }
+XlaOp KernelMatVec(absl::Span<const XlaOp> p) { return extension::BatchedSmallMatVec(p[0], p[1]); }
+XlaOp HloMatVec(absl::Span<const XlaOp> p) { return spatial_hlo::BatchedDot(p[0], p[1]); }
+XlaOp KernelQuatMul(absl::Span<const XlaOp> p) { return extension::QuaternionMultiply(p[0], p[1]); }
+XlaOp HloQuatMul(absl::Span<const XlaOp> p) { return spatial_hlo::QuaternionMultiply(p[0], p[1]); }
+XlaOp KernelQuatRotate(absl::Span<const XlaOp> p) { return extension::QuaternionRotate(p[0], p[1]); }
+XlaOp HloQuatRotate(absl::Span<const XlaOp> p) { return spatial_hlo::QuaternionRotate(p[0], p[1]); }
+XlaOp KernelTransform(absl::Span<const XlaOp> p) {
+    return extension::SpatialMotionTransform(p[0], p[1], p[2]);
+}
+XlaOp HloTransform(absl::Span<const XlaOp> p) {
+    return spatial_hlo::SpatialMotionTransform(p[0], p[1], p[2]);
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "XLA Spatial-Algebra Kernel Test" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Kernel instruction set: " << extension::SpatialKernelIsa() << std::endl;
+
+    auto client = CheckOr(GetPjRtCpuClient(CpuClientOptions()), "Creating CPU client");
+    constexpr int64_t kBatch = 37;
+
+    // Test 1: Batched small matmul
+    std::cout << "\nTest 1: Batched small matmul..." << std::endl;
+    for (int64_t n : {3, 4, 5, 6}) {
+        Literal a = RandomLiteral(F32, {kBatch, n, n});
+        Literal b = RandomLiteral(F32, {kBatch, n, n});
+        Compare(client.get(), KernelMatMul, HloMatMul, {&a, &b},
+                std::to_string(n) + "x" + std::to_string(n) + " F32 matmul");
+    }
+    {
+        Literal a = RandomLiteral(F64, {kBatch, 6, 6});
+        Literal b = RandomLiteral(F64, {kBatch, 6, 6});
+        Compare(client.get(), KernelMatMul, HloMatMul, {&a, &b}, "6x6 F64 matmul");
+    }
+
+    // Test 2: Batched matrix-vector product
+    std::cout << "\nTest 2: Batched matrix-vector product..." << std::endl;
+    for (PrimitiveType type : {F32, F64}) {
+        for (int64_t n : {3, 6}) {
+            Literal a = RandomLiteral(type, {kBatch, n, n});
+            Literal x = RandomLiteral(type, {kBatch, n});
+            Compare(client.get(), KernelMatVec, HloMatVec, {&a, &x},
+                    std::to_string(n) + "x" + std::to_string(n) + " " +
+                        PrimitiveType_Name(type) + " matvec");
+        }
+    }
+
+    // Test 3: Quaternions
+    std::cout << "\nTest 3: Quaternion product and rotation..." << std::endl;
+    {
+        Literal p = RandomLiteral(F32, {kBatch, 4});
+        Literal q = RandomLiteral(F32, {kBatch, 4});
+        Normalize(q);
+        Literal v = RandomLiteral(F32, {kBatch, 3});
+        Compare(client.get(), KernelQuatMul, HloQuatMul, {&p, &q}, "Quaternion product");
+        Compare(client.get(), KernelQuatRotate, HloQuatRotate, {&q, &v}, "Quaternion rotation");
+    }
+
+    // Test 4: Spatial motion transform
+    std::cout << "\nTest 4: Spatial motion transform..." << std::endl;
+    for (PrimitiveType type : {F32, F64}) {
+        Literal e = RandomLiteral(type, {kBatch, 3, 3});
+        Literal r = RandomLiteral(type, {kBatch, 3});
+        Literal m = RandomLiteral(type, {kBatch, 6});
+        Compare(client.get(), KernelTransform, HloTransform, {&e, &r, &m},
+                PrimitiveType_Name(type) + " motion transform");
+    }
+
+    // Test 5: Several batch dimensions are flattened by the kernels
+    std::cout << "\nTest 5: Several batch dimensions..." << std::endl;
+    {
+        Literal a = RandomLiteral(F32, {2, 5, 4, 4});
+        Literal b = RandomLiteral(F32, {2, 5, 4, 4});
+        Literal actual = Run(client.get(), KernelMatMul, {&a, &b});
+        Expect(actual.shape().dimensions() == std::vector<int64_t>({2, 5, 4, 4}),
+               "Result keeps the batch dimensions");
+
+        Literal a_flat = CheckOr(a.Reshape({10, 4, 4}), "Reshaping a");
+        Literal b_flat = CheckOr(b.Reshape({10, 4, 4}), "Reshaping b");
+        Literal expected = Run(client.get(), HloMatMul, {&a_flat, &b_flat});
+        Expect(MaxAbsDiff(actual, expected) < 1e-5, "Result matches the flattened batch");
+    }
+
+    // Test 6: Invalid operands fail at build time
+    std::cout << "\nTest 6: Invalid operands..." << std::endl;
+    {
+        XlaBuilder builder("mismatched");
+        auto a = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {8, 3, 3}), "a");
+        auto b = Parameter(&builder, 1, ShapeUtil::MakeShape(F32, {4, 3, 3}), "b");
+        extension::BatchedSmallMatMul(a, b);
+        Expect(!builder.Build().ok(), "Mismatched batch dimensions are rejected");
+    }
+    {
+        XlaBuilder builder("half");
+        auto p = Parameter(&builder, 0, ShapeUtil::MakeShape(F16, {8, 4}), "p");
+        extension::QuaternionMultiply(p, p);
+        Expect(!builder.Build().ok(), "F16 operands are rejected");
+    }
+    {
+        XlaBuilder builder("large");
+        auto a = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {8, 12, 12}), "a");
+        extension::BatchedSmallMatMul(a, a);
+        Expect(!builder.Build().ok(), "Matrices above the maximum size are rejected");
+    }
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "✓ All spatial kernel tests passed!" << std::endl;
+    std::cout << "========================================" << std::endl;
+    return 0;
+}
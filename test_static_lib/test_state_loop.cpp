@@ -0,0 +1,193 @@
+/**
+ * XLA State Loop Test
+ *
+ * Verifies input-output aliasing and buffer donation for step loops,
+ * with the builder API and xla/extension/state_loop.h:
+ * 1. Builder-level aliases reach the compiled executable
+ * 2. Donated state is updated in place
+ * 3. A thousand steps of an integrator match the closed form
+ * 4. A single non-tuple state
+ * 5. Non-donatable inputs stay valid
+ * 6. Executables without aliases are rejected
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/state_loop.h"
+#include "absl/status/statusor.h"
+#include "absl/status/status.h"
+
+#include "test_common.h"
+
+using namespace xla;
+using tests::CheckOr;
+using tests::Expect;
+using namespace xla::extension;
+
+constexpr int64_t kSize = 1024;
+
+// (x, v, dt) -> (x + v * dt, v * 0.5 + 0.5, sum(x)), with x and v aliased
+XlaComputation BuildIntegrator(bool alias) {
+    XlaBuilder builder("integrator");
+    Shape shape = ShapeUtil::MakeShape(F32, {kSize});
+    auto x = Parameter(&builder, 0, shape, "x");
+    auto v = Parameter(&builder, 1, shape, "v");
+    auto dt = Parameter(&builder, 2, ShapeUtil::MakeShape(F32, {}), "dt");
+    auto half = ConstantR0<float>(&builder, 0.5f);
+    auto sum = Reduce(x, ConstantR0<float>(&builder, 0.0f),
+                      CreateScalarAddComputation(F32, &builder), {0});
+    Tuple(&builder, {Add(x, Mul(v, dt)), Add(Mul(v, half), half), sum});
+    if (alias) AliasStateToOutputs(&builder, 2);
+    return CheckOr(builder.Build(), "Building integrator");
+}
+
+std::unique_ptr<PjRtBuffer> Upload(PjRtClient* client, const Literal& literal) {
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+    return CheckOr(client->BufferFromHostLiteral(literal, memory_space), "Transferring");
+}
+
+Literal Filled(float value) {
+    Literal literal(ShapeUtil::MakeShape(F32, {kSize}));
+    literal.PopulateWithValue(value);
+    return literal;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "XLA State Loop Test" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    auto client = CheckOr(GetPjRtCpuClient(CpuClientOptions()), "Creating CPU client");
+    CompileOptions compile_options;
+    auto executable = CheckOr(client->CompileAndLoad(BuildIntegrator(true), compile_options),
+                              "Compiling");
+    auto dt = Upload(client.get(), LiteralUtil::CreateR0<float>(0.25f));
+
+    // Test 1: Aliases
+    std::cout << "\nTest 1: Builder-level aliasing..." << std::endl;
+    {
+        auto modules = CheckOr(executable->GetHloModules(), "Getting modules");
+        const auto& aliases = modules[0]->input_output_alias_config();
+        Expect(aliases.ParameterHasAlias(0, {}) && aliases.ParameterHasAlias(1, {}),
+               "State parameters are aliased");
+        Expect(!aliases.ParameterHasAlias(2, {}), "Other parameters are not");
+    }
+
+    // Test 2: In place
+    std::cout << "\nTest 2: Donated state is updated in place..." << std::endl;
+    {
+        std::vector<std::unique_ptr<PjRtBuffer>> state;
+        state.push_back(Upload(client.get(), Filled(1.0f)));
+        state.push_back(Upload(client.get(), Filled(2.0f)));
+        auto x_address = CheckOr(client->UnsafeBufferPointer(state[0].get()), "Getting address");
+
+        auto loop = CheckOr(StateLoop::Create(executable.get(), std::move(state)), "Creating loop");
+        CheckOr(loop->Step({dt.get()}), "Stepping");
+        Expect(loop->state()[0]->GetReadyFuture().Await().ok(), "Step completes");
+        Expect(CheckOr(client->UnsafeBufferPointer(loop->state()[0].get()), "Getting address") ==
+                   x_address,
+               "New state lives in the donated buffer");
+    }
+
+    // Test 3: Many steps
+    std::cout << "\nTest 3: 1000 integrator steps..." << std::endl;
+    {
+        std::vector<std::unique_ptr<PjRtBuffer>> state;
+        state.push_back(Upload(client.get(), Filled(0.0f)));
+        state.push_back(Upload(client.get(), Filled(3.0f)));
+        auto loop = CheckOr(StateLoop::Create(executable.get(), std::move(state)), "Creating loop");
+
+        std::unique_ptr<PjRtBuffer> last_sum;
+        for (int i = 0; i < 1000; i++) {
+            auto outputs = CheckOr(loop->Step({dt.get()}), "Stepping");
+            if (i == 999) last_sum = std::move(outputs[0]);
+        }
+        Expect(loop->steps() == 1000, "Loop counts its steps");
+
+        // v_n = 1 + 2 * 0.5^n, so x_n = dt * sum_{k<n} v_k
+        double expected_x = 0;
+        for (int k = 0; k < 1000; k++) expected_x += 0.25 * (1 + 2 * std::pow(0.5, k));
+        auto x = CheckOr(loop->state()[0]->ToLiteralSync(), "Reading x");
+        auto v = CheckOr(loop->state()[1]->ToLiteralSync(), "Reading v");
+        Expect(std::abs(x->data<float>()[0] - expected_x) < 1e-2 &&
+                   std::abs(v->data<float>()[kSize - 1] - 1.0f) < 1e-6,
+               "State matches the closed form");
+
+        // The sum output is computed from x before the last update
+        auto sum = CheckOr(last_sum->ToLiteralSync(), "Reading sum");
+        double expected_sum = kSize * (expected_x - 0.25 * (1 + 2 * std::pow(0.5, 999)));
+        Expect(std::abs(sum->data<float>()[0] - expected_sum) / expected_sum < 1e-4,
+               "Non-state output is returned");
+
+        auto released = loop->ReleaseState();
+        Expect(released.size() == 2 && !loop->Step({dt.get()}).ok(),
+               "Released loops do not step");
+    }
+
+    // Test 4: Non-tuple state
+    std::cout << "\nTest 4: Single non-tuple state..." << std::endl;
+    {
+        XlaBuilder builder("decay");
+        auto x = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {kSize}), "x");
+        Mul(x, ConstantR0<float>(&builder, 0.5f));
+        AliasStateToOutputs(&builder, 1, /*tuple_root=*/false);
+        auto decay = CheckOr(client->CompileAndLoad(CheckOr(builder.Build(), "Building decay"),
+                                                    compile_options),
+                             "Compiling decay");
+
+        std::vector<std::unique_ptr<PjRtBuffer>> state;
+        state.push_back(Upload(client.get(), Filled(1024.0f)));
+        auto loop = CheckOr(StateLoop::Create(decay.get(), std::move(state)), "Creating loop");
+        Expect(CheckOr(loop->Step(), "Stepping").empty(), "Step has no other outputs");
+        for (int i = 1; i < 10; i++) CheckOr(loop->Step(), "Stepping");
+        auto result = CheckOr(loop->state()[0]->ToLiteralSync(), "Reading x");
+        Expect(result->data<float>()[0] == 1.0f, "Ten halvings of 1024 give 1");
+    }
+
+    // Test 5: Non-donatable inputs
+    std::cout << "\nTest 5: Non-donatable inputs..." << std::endl;
+    {
+        auto x = Upload(client.get(), Filled(1.0f));
+        auto v = Upload(client.get(), Filled(2.0f));
+        ExecuteOptions execute_options;
+        execute_options.non_donatable_input_indices = {0, 1};
+        std::vector<std::vector<PjRtBuffer*>> argument_handles = {{x.get(), v.get(), dt.get()}};
+        auto results = CheckOr(executable->Execute(argument_handles, execute_options), "Executing");
+        auto updated = CheckOr(results[0][0]->ToLiteralSync(), "Reading output");
+        Expect(updated->data<float>()[0] == 1.5f, "Aliased executable still computes");
+        Expect(!x->IsDeleted() && CheckOr(x->ToLiteralSync(), "Reading input")->data<float>()[0] == 1.0f,
+               "Input kept its value");
+    }
+
+    // Test 6: Missing aliases
+    std::cout << "\nTest 6: Executables without aliases..." << std::endl;
+    {
+        auto plain = CheckOr(client->CompileAndLoad(BuildIntegrator(false), compile_options),
+                             "Compiling");
+        std::vector<std::unique_ptr<PjRtBuffer>> state;
+        state.push_back(Upload(client.get(), Filled(0.0f)));
+        Expect(absl::IsInvalidArgument(StateLoop::Create(plain.get(), std::move(state)).status()),
+               "Unaliased state is rejected");
+    }
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "✓ All state loop tests passed!" << std::endl;
+    std::cout << "========================================" << std::endl;
+    return 0;
+}
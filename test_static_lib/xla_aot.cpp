@@ -0,0 +1,139 @@
+/**
+ * xla_aot - Compile an HLO module ahead of time
+ *
+ * Build-time half of xla/extension/aot.h. Loads an HLO module (HLO text,
+ * HloModuleProto or StableHLO MLIR, see xla/extension/hlo_loader.h),
+ * compiles it on the CPU client for the target instruction set and
+ * writes an artifact that aot_run, or any program linking the runtime
+ * archive, loads without compiling.
+ *
+ * Loading StableHLO needs the MLIR layer, so with layered archives it
+ * links against XLA_LAYER=xla_mlir:
+ *
+ *   make xla_aot XLA_LAYER=xla_mlir
+ *
+ * Usage:
+ *   xla_aot [flags] <module.{hlo,txt,pb,pbtxt,mlir,mlirbc}>
+ *
+ *   --output=<file>                artifact to write (default: the module
+ *                                  path with the extension replaced by
+ *                                  .xla_aot)
+ *   --max_isa=<isa>                highest instruction set of the target
+ *                                  CPU, for example AVX2 (default: the
+ *                                  build machine, whose CPU features
+ *                                  the loading machine must then have)
+ *   --format=hlo|proto|pbtxt|mlir  override the format guessed from the
+ *                                  file extension
+ */
+
+#include <iostream>
+#include <string>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/aot.h"
+#include "xla/extension/hlo_loader.h"
+
+#include "bench_common.h"
+
+using namespace xla;
+using bench::CheckOr;
+using bench::Check;
+using bench::Clock;
+using bench::ElapsedNs;
+using xla::extension::HloFormat;
+
+namespace {
+
+struct Flags {
+    std::string path;
+    std::string output;
+    std::string max_isa;
+    std::string format;
+};
+
+[[noreturn]] void Usage(const std::string& error) {
+    if (!error.empty()) std::cerr << "xla_aot: " << error << std::endl;
+    std::cerr << "Usage: xla_aot [--output=<file>] [--max_isa=<isa>] "
+                 "[--format=hlo|proto|pbtxt|mlir] <module>" << std::endl;
+    exit(2);
+}
+
+Flags ParseFlags(int argc, char** argv) {
+    Flags flags;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) != 0) {
+            if (!flags.path.empty()) Usage("more than one module given");
+            flags.path = arg;
+            continue;
+        }
+        size_t eq = arg.find('=');
+        std::string name = arg.substr(2, eq == std::string::npos ? std::string::npos : eq - 2);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (name == "help") Usage("");
+        if (eq == std::string::npos) {
+            Usage("missing value for --" + name);
+        } else if (name == "output") {
+            flags.output = value;
+        } else if (name == "max_isa") {
+            flags.max_isa = value;
+        } else if (name == "format") {
+            flags.format = value;
+        } else {
+            Usage("unknown flag --" + name);
+        }
+    }
+    if (flags.path.empty()) Usage("no module given");
+    if (flags.output.empty()) {
+        size_t dot = flags.path.rfind('.');
+        size_t slash = flags.path.rfind('/');
+        bool has_extension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+        flags.output = flags.path.substr(0, has_extension ? dot : std::string::npos) + ".xla_aot";
+    }
+    return flags;
+}
+
+HloFormat ParseFormat(const Flags& flags) {
+    if (flags.format.empty()) {
+        return CheckOr(xla::extension::HloFormatFromPath(flags.path), "Guessing the format");
+    }
+    if (flags.format == "hlo") return HloFormat::kHloText;
+    if (flags.format == "proto") return HloFormat::kHloProto;
+    if (flags.format == "pbtxt") return HloFormat::kHloProtoText;
+    if (flags.format == "mlir") return HloFormat::kMlir;
+    Usage("unknown format " + flags.format);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Flags flags = ParseFlags(argc, argv);
+
+    auto computation = CheckOr(xla::extension::LoadComputation(flags.path, ParseFormat(flags)),
+                               "Loading " + flags.path);
+    auto client = CheckOr(GetPjRtCpuClient(CpuClientOptions()), "Creating CPU client");
+
+    xla::extension::AotTarget target;
+    target.max_isa = flags.max_isa;
+    auto start = Clock::now();
+    auto artifact = CheckOr(
+        xla::extension::CompileForExport(client.get(), computation, CompileOptions(), target),
+        "Compiling");
+    double compile_ms = ElapsedNs(start) / 1e6;
+
+    Check(xla::extension::WriteAotArtifact(flags.output, artifact), "Writing " + flags.output);
+    std::cerr << "Compiled " << flags.path << " in " << compile_ms << " ms for "
+              << (flags.max_isa.empty() ? "the host CPU" : flags.max_isa) << std::endl;
+    if (flags.max_isa.empty()) {
+        std::cerr << "Loading requires a CPU with";
+        for (const std::string& feature : artifact.cpu_features) std::cerr << " " << feature;
+        std::cerr << ", pass --max_isa to run on older CPUs" << std::endl;
+    }
+    std::cerr << "Wrote " << flags.output << " ("
+              << xla::extension::SerializeAotArtifact(artifact).size() << " bytes)" << std::endl;
+    return 0;
+}
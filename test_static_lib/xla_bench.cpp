@@ -0,0 +1,355 @@
+/**
+ * xla_bench - How fast is this HLO on this machine?
+ *
+ * Loads an HLO module (HLO text, HloModuleProto or StableHLO MLIR, see
+ * xla/extension/hlo_loader.h), fills its parameters with random data or
+ * with raw bytes from files, compiles it on the CPU client and executes
+ * it repeatedly. Prints a JSON report on stdout in the format of the
+ * bench_* programs, with:
+ *
+ *   phase=compile  CompileAndLoad latency
+ *   phase=execute  Execute latency until the outputs are ready, with
+ *                  cost-analysis flops/bytes and buffer-assignment memory
+ *                  (xla/extension/memory_report.h): total_bytes for
+ *                  arguments, outputs and temp, peak_bytes for the peak
+ *                  of live buffers (0 when the compiler reports none)
+ *
+ * Loading StableHLO needs the MLIR layer, so with layered archives it
+ * links against XLA_LAYER=xla_mlir:
+ *
+ *   make xla_bench XLA_LAYER=xla_mlir
+ *
+ * Usage:
+ *   xla_bench [flags] <module.{hlo,txt,pb,pbtxt,mlir,mlirbc}>
+ *
+ *   --format=hlo|proto|pbtxt|mlir  override the format guessed from the
+ *                                  file extension
+ *   --input=<file>                 raw little-endian bytes of the next
+ *                                  parameter, repeat for each parameter;
+ *                                  the remaining ones are random
+ *   --iters=N                      timed executions (default 100)
+ *   --warmup=N                     untimed executions first (default 5)
+ *   --compile_iters=N              timed compilations (default 1)
+ *   --seed=N                       seed of the random inputs (default 42)
+ *   --print_outputs                print the outputs of the first execution
+ *                                  to stderr, to use it as a runner
+ *   --memory_report                print the memory breakdown and the
+ *                                  largest buffers live at the peak to stderr
+ *   --memory_budget=N[K|M|G]       exit with status 1 after compiling when
+ *                                  arguments, outputs and temp exceed N bytes
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+// XLA includes
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/literal.h"
+#include "xla/primitive_util.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/extension/hlo_loader.h"
+#include "xla/extension/memory_report.h"
+#include "xla/extension/spatial_kernel_handlers.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/numbers.h"
+
+#include "bench_common.h"
+
+using namespace xla;
+using bench::CheckOr;
+using bench::Check;
+using bench::Clock;
+using bench::ElapsedNs;
+using xla::extension::HloFormat;
+
+namespace {
+
+struct Flags {
+    std::string path;
+    std::string format;
+    std::vector<std::string> inputs;
+    int iters = 100;
+    int warmup = 5;
+    int compile_iters = 1;
+    uint64_t seed = 42;
+    bool print_outputs = false;
+    bool memory_report = false;
+    int64_t memory_budget = -1;
+};
+
+[[noreturn]] void Usage(const std::string& error) {
+    if (!error.empty()) std::cerr << "xla_bench: " << error << std::endl;
+    std::cerr << "Usage: xla_bench [--format=hlo|proto|pbtxt|mlir] [--input=<file>]... "
+                 "[--iters=N] [--warmup=N] [--compile_iters=N] [--seed=N] [--print_outputs] "
+                 "[--memory_report] [--memory_budget=N[K|M|G]] <module>" << std::endl;
+    exit(2);
+}
+
+template <typename T>
+T ParseNumber(const std::string& name, const std::string& value) {
+    T number;
+    if (!absl::SimpleAtoi(value, &number)) Usage("invalid value for --" + name + ": " + value);
+    return number;
+}
+
+// "512M" -> 536870912
+int64_t ParseBytes(const std::string& name, const std::string& value) {
+    int shift = 0;
+    std::string digits = value;
+    if (!value.empty()) {
+        switch (value.back()) {
+            case 'K': shift = 10; break;
+            case 'M': shift = 20; break;
+            case 'G': shift = 30; break;
+        }
+        if (shift > 0) digits.pop_back();
+    }
+    const int64_t bytes = ParseNumber<int64_t>(name, digits);
+    if (bytes < 0 || bytes > (std::numeric_limits<int64_t>::max() >> shift)) {
+        Usage("invalid value for --" + name + ": " + value);
+    }
+    return bytes << shift;
+}
+
+Flags ParseFlags(int argc, char** argv) {
+    Flags flags;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) != 0) {
+            if (!flags.path.empty()) Usage("more than one module given");
+            flags.path = arg;
+            continue;
+        }
+        size_t eq = arg.find('=');
+        std::string name = arg.substr(2, eq == std::string::npos ? std::string::npos : eq - 2);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (name == "help") Usage("");
+        if (name == "print_outputs") {
+            flags.print_outputs = true;
+        } else if (name == "memory_report") {
+            flags.memory_report = true;
+        } else if (eq == std::string::npos) {
+            Usage("missing value for --" + name);
+        } else if (name == "format") {
+            flags.format = value;
+        } else if (name == "input") {
+            flags.inputs.push_back(value);
+        } else if (name == "iters") {
+            flags.iters = ParseNumber<int>(name, value);
+        } else if (name == "warmup") {
+            flags.warmup = ParseNumber<int>(name, value);
+        } else if (name == "compile_iters") {
+            flags.compile_iters = ParseNumber<int>(name, value);
+        } else if (name == "seed") {
+            flags.seed = ParseNumber<uint64_t>(name, value);
+        } else if (name == "memory_budget") {
+            flags.memory_budget = ParseBytes(name, value);
+        } else {
+            Usage("unknown flag --" + name);
+        }
+    }
+    if (flags.path.empty()) Usage("no module given");
+    if (flags.iters < 1 || flags.compile_iters < 1) Usage("iteration counts must be positive");
+    if (flags.warmup < 0) Usage("--warmup must not be negative");
+    return flags;
+}
+
+HloFormat ParseFormat(const Flags& flags) {
+    if (flags.format.empty()) {
+        return CheckOr(xla::extension::HloFormatFromPath(flags.path), "Guessing the format");
+    }
+    if (flags.format == "hlo") return HloFormat::kHloText;
+    if (flags.format == "proto") return HloFormat::kHloProto;
+    if (flags.format == "pbtxt") return HloFormat::kHloProtoText;
+    if (flags.format == "mlir") return HloFormat::kMlir;
+    Usage("unknown format " + flags.format);
+}
+
+// Uniform in [-1, 1) for floating point, [0, 10) for integers
+Literal RandomLiteral(const Shape& shape, std::mt19937_64& rng) {
+    Literal literal(shape);
+    primitive_util::PrimitiveTypeSwitch<void>(
+        [&](auto type) {
+            if constexpr (primitive_util::IsArrayType(type) && type != PRED &&
+                          !primitive_util::IsComplexType(type)) {
+                using T = primitive_util::NativeTypeOf<type>;
+                if constexpr (primitive_util::IsFloatingPointType(type)) {
+                    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+                    for (T& v : literal.data<T>()) v = static_cast<T>(dist(rng));
+                } else {
+                    std::uniform_int_distribution<int> dist(0, 9);
+                    for (T& v : literal.data<T>()) v = static_cast<T>(dist(rng));
+                }
+            } else if constexpr (type == PRED) {
+                std::bernoulli_distribution dist;
+                for (bool& v : literal.data<bool>()) v = dist(rng);
+            }
+            // Complex parameters are left zeroed
+        },
+        shape.element_type());
+    return literal;
+}
+
+Literal LiteralFromFile(const Shape& shape, const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) Usage("cannot open input " + path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string bytes = contents.str();
+
+    Literal literal(shape);
+    if (bytes.size() != static_cast<size_t>(literal.size_bytes())) {
+        Usage(path + " has " + std::to_string(bytes.size()) + " bytes, parameter " +
+              ShapeUtil::HumanString(shape) + " needs " + std::to_string(literal.size_bytes()));
+    }
+    std::memcpy(literal.untyped_data(), bytes.data(), bytes.size());
+    return literal;
+}
+
+// Numeric cost-analysis property, or -1 when the backend does not report it
+double CostProperty(const absl::flat_hash_map<std::string, PjRtValueType>& properties,
+                    const std::string& key) {
+    auto it = properties.find(key);
+    if (it == properties.end()) return -1;
+    if (const auto* value = std::get_if<float>(&it->second)) return *value;
+    if (const auto* value = std::get_if<int64_t>(&it->second)) return static_cast<double>(*value);
+    return -1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Flags flags = ParseFlags(argc, argv);
+    HloFormat format = ParseFormat(flags);
+    // Modules may call the spatial kernels, which are not built here
+    xla::extension::RegisterSpatialKernels();
+
+    auto computation = CheckOr(xla::extension::LoadComputation(flags.path, format),
+                               "Loading " + flags.path);
+    auto program_shape = CheckOr(computation.GetProgramShape(), "Getting the program shape");
+    if (flags.inputs.size() > static_cast<size_t>(program_shape.parameters_size())) {
+        Usage("more inputs than the " + std::to_string(program_shape.parameters_size()) +
+              " parameters of the module");
+    }
+    std::cerr << "Module: " << flags.path << std::endl;
+    std::cerr << "Signature: " << ShapeUtil::HumanString(program_shape) << std::endl;
+
+    CpuClientOptions options;
+    options.asynchronous = true;
+    auto client = CheckOr(GetPjRtCpuClient(options), "Creating CPU client");
+    auto memory_space = CheckOr(client->addressable_devices()[0]->default_memory_space(),
+                                "Getting memory space");
+
+    bench::Report report("xla_bench");
+    report.SetInfo("module", flags.path);
+    report.SetInfo("signature", ShapeUtil::HumanString(program_shape));
+    report.SetInfo("platform_version", std::string(client->platform_version()));
+
+    // Compile
+    std::unique_ptr<PjRtLoadedExecutable> executable;
+    std::vector<double> compile_samples;
+    for (int i = 0; i < flags.compile_iters; i++) {
+        CompileOptions compile_options;
+        auto start = Clock::now();
+        executable = CheckOr(client->CompileAndLoad(computation, compile_options), "Compiling");
+        compile_samples.push_back(ElapsedNs(start));
+    }
+    report.Add({{"phase", "compile"}}, compile_samples);
+
+    auto footprint = xla::extension::GetMemoryFootprint(*executable);
+    if (flags.memory_report || flags.memory_budget >= 0) {
+        Check(footprint.status(), "Getting the memory footprint");
+    }
+    if (flags.memory_report) {
+        std::cerr << xla::extension::FormatMemoryFootprint(*footprint);
+    }
+    if (flags.memory_budget >= 0) {
+        xla::extension::MemoryBudget budget;
+        budget.total_bytes = flags.memory_budget;
+        auto status = xla::extension::CheckMemoryBudget(*footprint, budget);
+        if (!status.ok()) {
+            std::cerr << "xla_bench: " << status.message();
+            return 1;
+        }
+    }
+
+    // Inputs stay on the device for all executions
+    std::mt19937_64 rng(flags.seed);
+    std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+    std::vector<PjRtBuffer*> handles;
+    for (int i = 0; i < program_shape.parameters_size(); i++) {
+        const Shape& shape = program_shape.parameters(i);
+        if (!shape.IsArray()) Usage("parameter " + std::to_string(i) + " is not an array");
+        Literal literal = i < static_cast<int>(flags.inputs.size())
+            ? LiteralFromFile(shape, flags.inputs[i])
+            : RandomLiteral(shape, rng);
+        buffers.push_back(CheckOr(client->BufferFromHostLiteral(literal, memory_space),
+                                  "Transferring parameter " + std::to_string(i)));
+        handles.push_back(buffers.back().get());
+    }
+
+    // Execute
+    std::vector<std::vector<PjRtBuffer*>> argument_handles = {handles};
+    ExecuteOptions execute_options;
+    std::vector<double> execute_samples;
+    for (int i = 0; i < flags.warmup + flags.iters; i++) {
+        auto start = Clock::now();
+        auto results = CheckOr(executable->Execute(argument_handles, execute_options), "Executing");
+        for (const auto& result : results[0]) {
+            Check(result->GetReadyFuture().Await(), "Waiting for outputs");
+        }
+        if (i >= flags.warmup) execute_samples.push_back(ElapsedNs(start));
+
+        if (i == 0 && flags.print_outputs) {
+            for (size_t k = 0; k < results[0].size(); k++) {
+                auto literal = CheckOr(results[0][k]->ToLiteralSync(), "Reading back outputs");
+                std::cerr << "Output " << k << ": " << literal->ToString() << std::endl;
+            }
+        }
+    }
+
+    std::map<std::string, double> metrics;
+    auto cost = executable->GetCostAnalysis();
+    double flops = -1, bytes_accessed = -1;
+    if (cost.ok()) {
+        flops = CostProperty(*cost, "flops");
+        bytes_accessed = CostProperty(*cost, "bytes accessed");
+        metrics["transcendentals"] = CostProperty(*cost, "transcendentals");
+    }
+    metrics["flops"] = flops;
+    metrics["bytes_accessed"] = bytes_accessed;
+
+    if (footprint.ok()) {
+        metrics["argument_bytes"] = footprint->argument_bytes;
+        metrics["output_bytes"] = footprint->output_bytes;
+        metrics["alias_bytes"] = footprint->alias_bytes;
+        metrics["temp_bytes"] = footprint->temp_bytes;
+        metrics["generated_code_bytes"] = footprint->generated_code_bytes;
+        metrics["total_bytes"] = footprint->total_bytes();
+        metrics["peak_bytes"] = footprint->peak_bytes;
+    }
+
+    bench::Summary summary = bench::Summarize(execute_samples);
+    if (summary.mean_ns > 0) {
+        metrics["gflops_per_sec"] = flops >= 0 ? flops / summary.mean_ns : -1;
+        metrics["gbytes_per_sec"] = bytes_accessed >= 0 ? bytes_accessed / summary.mean_ns : -1;
+    }
+    report.Add({{"phase", "execute"}}, execute_samples, metrics);
+
+    report.Print();
+    return 0;
+}